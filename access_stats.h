@@ -0,0 +1,309 @@
+#ifndef ACCESS_STATS_H
+#define ACCESS_STATS_H
+
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <iostream>
+#include <vector>
+
+namespace nwacc {
+
+	/**
+	 * A point-in-time copy of the counters kept by access_stats.
+	 */
+	struct access_stats_snapshot {
+
+		/**
+		 * The number of histogram buckets. Bucket 0 counts hits at depth 0 and
+		 * bucket b > 0 counts hits at depths [2^(b-1), 2^b).
+		 */
+		static const int k_depth_buckets = 32;
+
+		std::uint64_t lookups = 0;
+
+		std::uint64_t hits = 0;
+
+		std::uint64_t misses = 0;
+
+		/**
+		 * The number of promotions that moved an element.
+		 */
+		std::uint64_t promotions = 0;
+
+		/**
+		 * The total number of positions elements moved forward by.
+		 * For array_list this is also the number of elements shifted back.
+		 */
+		std::uint64_t elements_shifted = 0;
+
+		/**
+		 * The sum of the search depths of all hits, the depth being the number of elements in front of the key.
+		 */
+		std::uint64_t total_hit_depth = 0;
+
+		std::uint64_t depth_histogram[k_depth_buckets] = { };
+
+		/**
+		 * The number of lookups whose latency was measured.
+		 */
+		std::uint64_t latency_samples = 0;
+
+		double latency_p50_ns = 0;
+
+		double latency_p90_ns = 0;
+
+		double latency_p99_ns = 0;
+
+		double latency_max_ns = 0;
+
+		/**
+		 * Returns the mean depth of a hit, 0 when there were none.
+		 */
+		double average_hit_depth() const
+		{
+			return this->hits == 0 ? 0.0 : static_cast<double>(this->total_hit_depth) / this->hits;
+		}
+
+		/**
+		 * Writes the snapshot as human readable text, one counter per line.
+		 */
+		void write_text(std::ostream& out) const
+		{
+			out << "lookups: " << this->lookups << "\n"
+				<< "hits: " << this->hits << "\n"
+				<< "misses: " << this->misses << "\n"
+				<< "average hit depth: " << this->average_hit_depth() << "\n"
+				<< "promotions: " << this->promotions << "\n"
+				<< "elements shifted: " << this->elements_shifted << "\n"
+				<< "latency ns (p50/p90/p99/max of " << this->latency_samples << " samples): "
+				<< this->latency_p50_ns << " / " << this->latency_p90_ns << " / "
+				<< this->latency_p99_ns << " / " << this->latency_max_ns << "\n"
+				<< "hit depth histogram:\n";
+			for (auto bucket = 0; bucket < k_depth_buckets; bucket++) {
+				if (this->depth_histogram[bucket] == 0) {
+					continue;
+				} // else, the bucket has hits to report, do_nothing();
+				auto low = bucket == 0 ? 0ULL : 1ULL << (bucket - 1);
+				auto high = bucket == 0 ? 0ULL : (1ULL << bucket) - 1;
+				out << "  [" << low << ", " << high << "]: " << this->depth_histogram[bucket] << "\n";
+			}
+		}
+
+		/**
+		 * Writes the snapshot as a single JSON object.
+		 */
+		void write_json(std::ostream& out) const
+		{
+			out << "{\"lookups\":" << this->lookups
+				<< ",\"hits\":" << this->hits
+				<< ",\"misses\":" << this->misses
+				<< ",\"average_hit_depth\":" << this->average_hit_depth()
+				<< ",\"promotions\":" << this->promotions
+				<< ",\"elements_shifted\":" << this->elements_shifted
+				<< ",\"latency_ns\":{\"samples\":" << this->latency_samples
+				<< ",\"p50\":" << this->latency_p50_ns
+				<< ",\"p90\":" << this->latency_p90_ns
+				<< ",\"p99\":" << this->latency_p99_ns
+				<< ",\"max\":" << this->latency_max_ns << "}"
+				<< ",\"depth_histogram\":[";
+			for (auto bucket = 0; bucket < k_depth_buckets; bucket++) {
+				out << (bucket == 0 ? "" : ",") << this->depth_histogram[bucket];
+			}
+			out << "]}";
+		}
+	};
+
+	/**
+	 * The default statistics policy: records nothing. Every hook is an empty
+	 * inline function, so a container using it compiles to the same code as
+	 * one without instrumentation.
+	 */
+	struct no_stats {
+
+		static const bool k_enabled = false;
+
+		struct lookup_timer { };
+
+		lookup_timer begin_lookup()
+		{
+			return lookup_timer{ };
+		}
+
+		void end_lookup(const lookup_timer&, bool, long long) { }
+
+		void record_lookup(bool, long long) { }
+
+		void record_promotion(long long) { }
+
+		access_stats_snapshot snapshot() const
+		{
+			return access_stats_snapshot{ };
+		}
+
+		void reset() { }
+	};
+
+	/**
+	 * A statistics policy that counts lookups, hits, misses, promotions and
+	 * shifted elements, keeps a histogram of hit depths, and times one lookup
+	 * in every k_sample_interval, keeping the latest k_max_samples timings
+	 * for latency percentiles.
+	 *
+	 * Pass it as the Stats argument of array_list or linked_list and read it
+	 * through statistics().snapshot().
+	 */
+	class access_stats {
+	public:
+
+		static const bool k_enabled = true;
+
+		/**
+		 * Carries the start time of a sampled lookup from begin_lookup to end_lookup.
+		 */
+		struct lookup_timer {
+
+			std::chrono::steady_clock::time_point start;
+
+			bool sampled;
+		};
+
+		access_stats() : counters{ }, until_sample{ 1 }, next_sample{ 0 }
+		{ }
+
+		/**
+		 * Starts a lookup, reading the clock only if this lookup is sampled.
+		 */
+		lookup_timer begin_lookup()
+		{
+			lookup_timer timer{ };
+			if (--this->until_sample == 0) {
+				this->until_sample = k_sample_interval;
+				timer.sampled = true;
+				timer.start = std::chrono::steady_clock::now();
+			} // else, this lookup is not timed, do_nothing();
+			return timer;
+		}
+
+		/**
+		 * Finishes a lookup started with begin_lookup.
+		 *
+		 * @param timer the value begin_lookup returned.
+		 * @param hit whether the key was found.
+		 * @param depth the number of elements in front of the key, ignored on a miss.
+		 */
+		void end_lookup(const lookup_timer& timer, bool hit, long long depth)
+		{
+			this->record_lookup(hit, depth);
+			if (timer.sampled) {
+				auto elapsed = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - timer.start).count();
+				if (static_cast<int>(this->samples.size()) < k_max_samples) {
+					this->samples.push_back(elapsed);
+				}
+				else {
+					this->samples[this->next_sample] = elapsed;
+				}
+				this->next_sample = (this->next_sample + 1) % k_max_samples;
+				this->counters.latency_samples++;
+			} // else, this lookup was not timed, do_nothing();
+		}
+
+		/**
+		 * Records a lookup without timing it.
+		 */
+		void record_lookup(bool hit, long long depth)
+		{
+			this->counters.lookups++;
+			if (!hit) {
+				this->counters.misses++;
+				return;
+			} // else, record where the key was found, do_nothing();
+
+			this->counters.hits++;
+			this->counters.total_hit_depth += depth;
+			this->counters.depth_histogram[bucket_of(depth)]++;
+		}
+
+		/**
+		 * Records an element moving forward.
+		 *
+		 * @param shifted the number of positions it moved.
+		 */
+		void record_promotion(long long shifted)
+		{
+			if (shifted > 0) {
+				this->counters.promotions++;
+				this->counters.elements_shifted += shifted;
+			} // else, the element stayed where it was, do_nothing();
+		}
+
+		/**
+		 * Returns a copy of the counters with the latency percentiles filled in.
+		 */
+		access_stats_snapshot snapshot() const
+		{
+			auto copy = this->counters;
+			if (!this->samples.empty()) {
+				auto sorted = this->samples;
+				std::sort(sorted.begin(), sorted.end());
+				auto at = [&sorted](double fraction) {
+					return sorted[static_cast<std::size_t>(fraction * (sorted.size() - 1))];
+				};
+				copy.latency_p50_ns = at(0.50);
+				copy.latency_p90_ns = at(0.90);
+				copy.latency_p99_ns = at(0.99);
+				copy.latency_max_ns = sorted.back();
+			} // else, nothing was timed yet, do_nothing();
+			return copy;
+		}
+
+		/**
+		 * Zeroes every counter and drops the latency samples.
+		 */
+		void reset()
+		{
+			this->counters = access_stats_snapshot{ };
+			this->samples.clear();
+			this->until_sample = 1;
+			this->next_sample = 0;
+		}
+
+	private:
+		/**
+		 * One lookup in this many is timed.
+		 */
+		static const int k_sample_interval = 64;
+
+		/**
+		 * The number of most recent latency samples kept.
+		 */
+		static const int k_max_samples = 4096;
+
+		access_stats_snapshot counters;
+
+		std::vector<double> samples;
+
+		/**
+		 * Lookups left until the next timed one.
+		 */
+		int until_sample;
+
+		/**
+		 * Where the next sample goes once samples is full.
+		 */
+		int next_sample;
+
+		static int bucket_of(long long depth)
+		{
+			auto bucket = 0;
+			while (depth > 0 && bucket < access_stats_snapshot::k_depth_buckets - 1) {
+				depth >>= 1;
+				bucket++;
+			}
+			return bucket;
+		}
+	};
+
+}
+
+#endif
@@ -0,0 +1,302 @@
+#ifndef ADJUSTMENT_POLICY_H
+#define ADJUSTMENT_POLICY_H
+
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <memory>
+#include <utility>
+
+#include "allocator_support.h"
+
+namespace nwacc {
+
+	/**
+	 * The type used for per-element access counters.
+	 */
+	typedef std::uint32_t access_counter;
+
+	/**
+	 * Self-adjustment policies decide how far an element moves toward the
+	 * front of a list after find locates it. Each policy provides:
+	 *
+	 *   k_counts_accesses  whether the container keeps an access counter per element.
+	 *   steps(index, outranks_next)
+	 *                      the number of positions the element found at index
+	 *                      moves forward. outranks_next() reports whether the
+	 *                      element outranks the next element ahead of it, each
+	 *                      call looking one position further forward.
+	 *
+	 * Every policy is a stateless struct used as a template argument, so the
+	 * rule is resolved at compile time and counters only exist when used.
+	 *
+	 * When a container defers promotions, an element found h times in a batch
+	 * is promoted as if found h times in a row: steps is asked h times, or
+	 * once after adding h to its counter.
+	 */
+
+	/**
+	 * Moves the found element all the way to the front.
+	 */
+	struct move_to_front {
+
+		static const bool k_counts_accesses = false;
+
+		template <typename Outranks>
+		static constexpr int steps(int index, Outranks&&)
+		{
+			return index;
+		}
+	};
+
+	/**
+	 * Swaps the found element with the one directly ahead of it.
+	 */
+	struct transpose {
+
+		static const bool k_counts_accesses = false;
+
+		template <typename Outranks>
+		static constexpr int steps(int index, Outranks&&)
+		{
+			return index > 0 ? 1 : 0;
+		}
+	};
+
+	/**
+	 * Moves the found element K positions forward, or to the front if it is closer than that.
+	 *
+	 * @param K the number of positions to move.
+	 */
+	template <int K>
+	struct move_ahead_k {
+
+		static_assert(K > 0, "move_ahead_k must move at least one position");
+
+		static const bool k_counts_accesses = false;
+
+		template <typename Outranks>
+		static constexpr int steps(int index, Outranks&&)
+		{
+			return std::min(index, K);
+		}
+	};
+
+	/**
+	 * Counts accesses per element and keeps the list ordered by count: the
+	 * found element moves ahead of every element accessed fewer times.
+	 */
+	struct frequency_count {
+
+		static const bool k_counts_accesses = true;
+
+		template <typename Outranks>
+		static constexpr int steps(int index, Outranks&& outranks_next)
+		{
+			auto moved = 0;
+			while (moved < index && outranks_next()) {
+				moved++;
+			}
+			return moved;
+		}
+	};
+
+	namespace detail {
+
+		/**
+		 * Per-element access counters for array based containers, kept parallel
+		 * to the element array. This primary template is used when the policy
+		 * does not count accesses: it holds nothing and every operation is empty.
+		 *
+		 * @param Allocator the allocator the counters come from, passed to every
+		 *        call that allocates or frees so the container keeps the only copy.
+		 * @param InlineCapacity how many counters fit inside the object before
+		 *        the allocator is used, matching the container's inline elements.
+		 */
+		template <bool Enabled, typename Allocator = std::allocator<access_counter>, int InlineCapacity = 0>
+		class access_counts {
+		public:
+			void allocate(int, const Allocator& = Allocator()) { }
+
+			void release(const Allocator& = Allocator()) { }
+
+			void copy(const access_counts&, int) { }
+
+			void reset(int) { }
+
+			void move_forward(int, int) { }
+
+			void erase(int, int) { }
+
+			void swap(access_counts&) { }
+		};
+
+		/**
+		 * Per-element access counters for array based containers.
+		 */
+		template <typename Allocator, int InlineCapacity>
+		class access_counts<true, Allocator, InlineCapacity> {
+		public:
+			access_counts() : counts{ nullptr }, my_capacity{ 0 }
+			{ }
+
+			access_counts(const access_counts&) = delete;
+
+			access_counts& operator=(const access_counts&) = delete;
+
+			access_counter& operator[](int index)
+			{
+				return this->counts[index];
+			}
+
+			access_counter operator[](int index) const
+			{
+				return this->counts[index];
+			}
+
+			/**
+			 * Returns the counters as one contiguous array.
+			 */
+			access_counter* data()
+			{
+				return this->counts;
+			}
+
+			const access_counter* data() const
+			{
+				return this->counts;
+			}
+
+			/**
+			 * Allocates room for capacity counters, all zero.
+			 */
+			void allocate(int capacity, const Allocator& allocator = Allocator())
+			{
+				if (InlineCapacity > 0 && capacity <= InlineCapacity) {
+					this->counts = this->local.data();
+					capacity = InlineCapacity;
+				}
+				else {
+					auto counter_allocator = allocator;
+					this->counts = std::allocator_traits<Allocator>::allocate(counter_allocator, capacity);
+				}
+				std::fill_n(this->counts, capacity, access_counter{ 0 });
+				this->my_capacity = capacity;
+			}
+
+			/**
+			 * Frees the counters, allocator must compare equal to the one they came from.
+			 */
+			void release(const Allocator& allocator = Allocator())
+			{
+				if (this->counts != nullptr && !this->is_local()) {
+					auto counter_allocator = allocator;
+					std::allocator_traits<Allocator>::deallocate(counter_allocator, this->counts, this->my_capacity);
+				} // else, nothing was allocated from the allocator, do_nothing();
+				this->counts = nullptr;
+				this->my_capacity = 0;
+			}
+
+			/**
+			 * Copies the first size counters of rhs, storage must already be allocated.
+			 */
+			void copy(const access_counts& rhs, int size)
+			{
+				std::copy(rhs.counts, rhs.counts + size, this->counts);
+			}
+
+			void reset(int index)
+			{
+				this->counts[index] = 0;
+			}
+
+			/**
+			 * Mirrors detail::move_forward on the elements.
+			 */
+			void move_forward(int from, int to)
+			{
+				if (from <= to) {
+					return;
+				} // else, the counter has somewhere to go, do_nothing();
+
+				auto moving = this->counts[from];
+				std::memmove(this->counts + to + 1, this->counts + to, (from - to) * sizeof(access_counter));
+				this->counts[to] = moving;
+			}
+
+			/**
+			 * Drops the counter at index, shifting the ones behind it up to size forward.
+			 */
+			void erase(int index, int size)
+			{
+				std::memmove(this->counts + index, this->counts + index + 1, (size - index - 1) * sizeof(access_counter));
+			}
+
+			void swap(access_counts& rhs)
+			{
+				if (this->is_local() || rhs.is_local()) {
+					// Inline counters cannot change owners, so they are copied across instead.
+					access_counter parked[InlineCapacity > 0 ? InlineCapacity : 1];
+					auto* mine = this->is_local() ? parked : this->counts;
+					if (this->is_local()) {
+						std::copy(this->counts, this->counts + InlineCapacity, parked);
+					} // else, this pointer can be handed over as is, do_nothing();
+					if (rhs.is_local()) {
+						std::copy(rhs.counts, rhs.counts + InlineCapacity, this->local.data());
+						this->counts = this->local.data();
+					}
+					else {
+						this->counts = rhs.counts;
+					}
+					if (mine == parked) {
+						std::copy(parked, parked + InlineCapacity, rhs.local.data());
+						rhs.counts = rhs.local.data();
+					}
+					else {
+						rhs.counts = mine;
+					}
+				}
+				else {
+					std::swap(this->counts, rhs.counts);
+				}
+				std::swap(this->my_capacity, rhs.my_capacity);
+			}
+
+		private:
+			access_counter* counts;
+
+			/**
+			 * The number of counters allocated, needed to free them.
+			 */
+			int my_capacity;
+
+			/**
+			 * Room for the counters of a small container.
+			 */
+			inline_storage<access_counter, InlineCapacity> local;
+
+			bool is_local() const
+			{
+				return InlineCapacity > 0 && this->counts == this->local.data();
+			}
+		};
+
+		/**
+		 * The access counter embedded in each node of a node based container.
+		 * Empty when the policy does not count accesses, so it adds nothing to
+		 * the node when used as a base class.
+		 */
+		template <bool Enabled>
+		struct node_access_count { };
+
+		template <>
+		struct node_access_count<true> {
+
+			access_counter count = 0;
+		};
+
+	}
+
+}
+
+#endif
@@ -0,0 +1,125 @@
+#ifndef ALLOCATOR_SUPPORT_H
+#define ALLOCATOR_SUPPORT_H
+
+#include <memory>
+#include <type_traits>
+#include <utility>
+
+namespace nwacc {
+
+	namespace detail {
+
+		/**
+		 * Allocator rebound to allocate U instead of its own value type.
+		 */
+		template <typename Allocator, typename U>
+		using rebind_allocator = typename std::allocator_traits<Allocator>::template rebind_alloc<U>;
+
+		/**
+		 * Builds a T that uses allocator when T is allocator aware, the way
+		 * std::pmr::polymorphic_allocator constructs elements: with a leading
+		 * std::allocator_arg if T accepts one, else with allocator appended,
+		 * else from args alone.
+		 *
+		 * @param allocator the allocator T should use for its own memory.
+		 * @param args the arguments forwarded to the T constructor.
+		 */
+		template <typename T, typename Allocator, typename... Args>
+		inline T make_using_allocator(const Allocator& allocator, Args&&... args)
+		{
+			if constexpr (!std::uses_allocator<T, Allocator>::value) {
+				return T(std::forward<Args>(args)...);
+			} else if constexpr (std::is_constructible<T, std::allocator_arg_t, const Allocator&, Args...>::value) {
+				return T(std::allocator_arg, allocator, std::forward<Args>(args)...);
+			} else {
+				return T(std::forward<Args>(args)..., allocator);
+			}
+		}
+
+		/**
+		 * Exchanges two allocators along with the memory they own. Allocators
+		 * that cannot be swapped, like std::pmr::polymorphic_allocator, are left
+		 * alone; containers only exchange memory between such allocators after
+		 * checking that they compare equal.
+		 */
+		template <typename Allocator>
+		inline void swap_allocators(Allocator& lhs, Allocator& rhs)
+		{
+			if constexpr (std::is_swappable<Allocator>::value) {
+				using std::swap;
+				swap(lhs, rhs);
+			} // else, the allocators are equal, do_nothing();
+		}
+
+		/**
+		 * Constructs count elements at destination from the ones first refers to,
+		 * through allocator, destroying what was built if one of them throws.
+		 * Trivially copyable elements are copied with std::uninitialized_copy_n,
+		 * i.e. a single memmove for a pointer range.
+		 *
+		 * @param allocator the allocator of the destination container.
+		 * @param first the first source element, a std::move_iterator to move them.
+		 * @param count the number of elements.
+		 * @param destination uninitialized storage for at least count elements.
+		 */
+		template <typename Allocator, typename InputIt, typename T>
+		inline void uninitialized_copy_with(Allocator& allocator, InputIt first, int count, T* destination)
+		{
+			if constexpr (std::is_trivially_copyable<T>::value) {
+				std::uninitialized_copy_n(first, count, destination);
+			} else {
+				auto built = 0;
+				try {
+					for (; built < count; ++built, ++first) {
+						std::allocator_traits<Allocator>::construct(allocator, destination + built, *first);
+					}
+				}
+				catch (...) {
+					std::destroy(destination, destination + built);
+					throw;
+				}
+			}
+		}
+
+		/**
+		 * Uninitialized room for Capacity elements of T inside the object that holds it.
+		 */
+		template <typename T, int Capacity>
+		class inline_storage {
+		public:
+			T* data()
+			{
+				return reinterpret_cast<T*>(this->bytes);
+			}
+
+			const T* data() const
+			{
+				return reinterpret_cast<const T*>(this->bytes);
+			}
+
+		private:
+			alignas(T) unsigned char bytes[Capacity * sizeof(T)];
+		};
+
+		/**
+		 * No inline room at all: holds nothing, and data() never matches a real pointer.
+		 */
+		template <typename T>
+		class inline_storage<T, 0> {
+		public:
+			T* data()
+			{
+				return nullptr;
+			}
+
+			const T* data() const
+			{
+				return nullptr;
+			}
+		};
+
+	}
+
+}
+
+#endif
@@ -0,0 +1,389 @@
+#ifndef ARRAY_KERNELS_H
+#define ARRAY_KERNELS_H
+
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <memory>
+#include <new>
+#include <type_traits>
+
+#if defined(__AVX2__)
+#include <immintrin.h>
+#define NWACC_HAS_AVX2 1
+#endif
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#define NWACC_HAS_SSE2 1
+#endif
+
+#if defined(_MSC_VER)
+#include <intrin.h>
+#endif
+
+namespace nwacc {
+namespace detail {
+
+	/**
+	 * Whether T can be searched with vector compares: integers, pointers and
+	 * floating point values of 1, 2, 4 or 8 bytes. Floating point lanes use an
+	 * ordered compare, so the result matches operator== (NaN never matches, 0.0 == -0.0).
+	 */
+	template <typename T>
+	struct is_vector_searchable : std::integral_constant<bool,
+		(std::is_integral<T>::value || std::is_pointer<T>::value || std::is_floating_point<T>::value) &&
+		(sizeof(T) == 1 || sizeof(T) == 2 || sizeof(T) == 4 || sizeof(T) == 8)> { };
+
+	/**
+	 * Returns the index of the lowest set bit of a non-zero mask.
+	 */
+	inline int lowest_set_bit(unsigned mask)
+	{
+#if defined(_MSC_VER)
+		unsigned long index;
+		_BitScanForward(&index, mask);
+		return static_cast<int>(index);
+#else
+		return __builtin_ctz(mask);
+#endif
+	}
+
+	/**
+	 * Reinterprets the bits of an integral or pointer key as a fixed width integer.
+	 */
+	template <typename Integer, typename T>
+	inline Integer key_bits(const T& key)
+	{
+		Integer bits;
+		std::memcpy(&bits, &key, sizeof(bits));
+		return bits;
+	}
+
+#if defined(NWACC_HAS_AVX2)
+	/**
+	 * 32-byte AVX2 lane operations.
+	 */
+	struct avx2_ops {
+
+		typedef __m256i vector;
+
+		static const int k_bytes = 32;
+
+		static vector load(const void* address)
+		{
+			return _mm256_loadu_si256(static_cast<const __m256i*>(address));
+		}
+
+		template <typename T>
+		static vector splat(const T& key)
+		{
+			if constexpr (std::is_same<T, float>::value) {
+				return _mm256_castps_si256(_mm256_set1_ps(key));
+			} else if constexpr (std::is_same<T, double>::value) {
+				return _mm256_castpd_si256(_mm256_set1_pd(key));
+			} else if constexpr (sizeof(T) == 1) {
+				return _mm256_set1_epi8(key_bits<std::int8_t>(key));
+			} else if constexpr (sizeof(T) == 2) {
+				return _mm256_set1_epi16(key_bits<std::int16_t>(key));
+			} else if constexpr (sizeof(T) == 4) {
+				return _mm256_set1_epi32(key_bits<std::int32_t>(key));
+			} else {
+				return _mm256_set1_epi64x(key_bits<std::int64_t>(key));
+			}
+		}
+
+		template <typename T>
+		static vector equal(vector lhs, vector rhs)
+		{
+			if constexpr (std::is_same<T, float>::value) {
+				return _mm256_castps_si256(_mm256_cmp_ps(_mm256_castsi256_ps(lhs), _mm256_castsi256_ps(rhs), _CMP_EQ_OQ));
+			} else if constexpr (std::is_same<T, double>::value) {
+				return _mm256_castpd_si256(_mm256_cmp_pd(_mm256_castsi256_pd(lhs), _mm256_castsi256_pd(rhs), _CMP_EQ_OQ));
+			} else if constexpr (sizeof(T) == 1) {
+				return _mm256_cmpeq_epi8(lhs, rhs);
+			} else if constexpr (sizeof(T) == 2) {
+				return _mm256_cmpeq_epi16(lhs, rhs);
+			} else if constexpr (sizeof(T) == 4) {
+				return _mm256_cmpeq_epi32(lhs, rhs);
+			} else {
+				return _mm256_cmpeq_epi64(lhs, rhs);
+			}
+		}
+
+		static vector either(vector lhs, vector rhs)
+		{
+			return _mm256_or_si256(lhs, rhs);
+		}
+
+		static unsigned byte_mask(vector value)
+		{
+			return static_cast<unsigned>(_mm256_movemask_epi8(value));
+		}
+	};
+#endif
+
+#if defined(NWACC_HAS_SSE2)
+	/**
+	 * 16-byte SSE2 lane operations.
+	 */
+	struct sse2_ops {
+
+		typedef __m128i vector;
+
+		static const int k_bytes = 16;
+
+		static vector load(const void* address)
+		{
+			return _mm_loadu_si128(static_cast<const __m128i*>(address));
+		}
+
+		template <typename T>
+		static vector splat(const T& key)
+		{
+			if constexpr (std::is_same<T, float>::value) {
+				return _mm_castps_si128(_mm_set1_ps(key));
+			} else if constexpr (std::is_same<T, double>::value) {
+				return _mm_castpd_si128(_mm_set1_pd(key));
+			} else if constexpr (sizeof(T) == 1) {
+				return _mm_set1_epi8(key_bits<std::int8_t>(key));
+			} else if constexpr (sizeof(T) == 2) {
+				return _mm_set1_epi16(key_bits<std::int16_t>(key));
+			} else if constexpr (sizeof(T) == 4) {
+				return _mm_set1_epi32(key_bits<std::int32_t>(key));
+			} else {
+				return _mm_set1_epi64x(key_bits<std::int64_t>(key));
+			}
+		}
+
+		template <typename T>
+		static vector equal(vector lhs, vector rhs)
+		{
+			if constexpr (std::is_same<T, float>::value) {
+				return _mm_castps_si128(_mm_cmpeq_ps(_mm_castsi128_ps(lhs), _mm_castsi128_ps(rhs)));
+			} else if constexpr (std::is_same<T, double>::value) {
+				return _mm_castpd_si128(_mm_cmpeq_pd(_mm_castsi128_pd(lhs), _mm_castsi128_pd(rhs)));
+			} else if constexpr (sizeof(T) == 1) {
+				return _mm_cmpeq_epi8(lhs, rhs);
+			} else if constexpr (sizeof(T) == 2) {
+				return _mm_cmpeq_epi16(lhs, rhs);
+			} else if constexpr (sizeof(T) == 4) {
+				return _mm_cmpeq_epi32(lhs, rhs);
+			} else {
+				// SSE2 has no 64-bit compare, a lane matches when both of its halves do.
+				auto halves = _mm_cmpeq_epi32(lhs, rhs);
+				return _mm_and_si128(halves, _mm_shuffle_epi32(halves, _MM_SHUFFLE(2, 3, 0, 1)));
+			}
+		}
+
+		static vector either(vector lhs, vector rhs)
+		{
+			return _mm_or_si128(lhs, rhs);
+		}
+
+		static unsigned byte_mask(vector value)
+		{
+			return static_cast<unsigned>(_mm_movemask_epi8(value));
+		}
+	};
+#endif
+
+	/**
+	 * Scalar search, used for every type without a vector kernel and for the tail of vector searches.
+	 */
+	template <typename T>
+	inline int scalar_find_index(const T* data, int from, int size, const T& key)
+	{
+		for (auto index = from; index < size; index++) {
+			if (key == data[index]) {
+				return index;
+			} // else, data is not the wanted value. do_nothing();
+		}
+		return -1;
+	}
+
+	/**
+	 * Vector search, four vectors per iteration while at least that many elements remain.
+	 */
+	template <typename Ops, typename T>
+	inline int vector_find_index(const T* data, int size, const T& key)
+	{
+		const int lanes = Ops::k_bytes / static_cast<int>(sizeof(T));
+		auto needle = Ops::template splat<T>(key);
+		auto index = 0;
+
+		for (; index + 4 * lanes <= size; index += 4 * lanes) {
+			auto first = Ops::template equal<T>(Ops::load(data + index), needle);
+			auto second = Ops::template equal<T>(Ops::load(data + index + lanes), needle);
+			auto third = Ops::template equal<T>(Ops::load(data + index + 2 * lanes), needle);
+			auto fourth = Ops::template equal<T>(Ops::load(data + index + 3 * lanes), needle);
+			if (Ops::byte_mask(Ops::either(Ops::either(first, second), Ops::either(third, fourth))) != 0) {
+				typename Ops::vector vectors[] = { first, second, third, fourth };
+				for (auto block = 0; block < 4; block++) {
+					auto mask = Ops::byte_mask(vectors[block]);
+					if (mask != 0) {
+						return index + block * lanes + lowest_set_bit(mask) / static_cast<int>(sizeof(T));
+					} // else, the match is in a later vector, do_nothing();
+				}
+			} // else, no lane of the four vectors matched, do_nothing();
+		}
+
+		for (; index + lanes <= size; index += lanes) {
+			auto mask = Ops::byte_mask(Ops::template equal<T>(Ops::load(data + index), needle));
+			if (mask != 0) {
+				return index + lowest_set_bit(mask) / static_cast<int>(sizeof(T));
+			} // else, no lane matched, do_nothing();
+		}
+
+		return scalar_find_index(data, index, size, key);
+	}
+
+	/**
+	 * Returns the index of the first element equal to key, or -1.
+	 * Integers, pointers and floating point values use the widest vector
+	 * compare available at compile time, every other type compares with operator==.
+	 *
+	 * @param data the array to search.
+	 * @param size the number of elements in data.
+	 * @param key the value to search for.
+	 */
+	template <typename T>
+	inline int find_index(const T* data, int size, const T& key)
+	{
+		if constexpr (is_vector_searchable<T>::value) {
+#if defined(NWACC_HAS_AVX2)
+			return vector_find_index<avx2_ops>(data, size, key);
+#elif defined(NWACC_HAS_SSE2)
+			return vector_find_index<sse2_ops>(data, size, key);
+#else
+			return scalar_find_index(data, 0, size, key);
+#endif
+		} else {
+			return scalar_find_index(data, 0, size, key);
+		}
+	}
+
+	/**
+	 * Returns the index of the first element for which matches returns true, or -1.
+	 *
+	 * @param data the array to search.
+	 * @param size the number of elements in data.
+	 * @param matches called with a constant reference to each element in turn.
+	 */
+	template <typename T, typename Predicate>
+	inline int find_index_if(const T* data, int size, Predicate matches)
+	{
+		for (auto index = 0; index < size; index++) {
+			if (matches(data[index])) {
+				return index;
+			} // else, data is not the wanted value. do_nothing();
+		}
+		return -1;
+	}
+
+	/**
+	 * Returns the index of the first element equal to key, where key may be of
+	 * another type than the elements (a std::string_view searched for among
+	 * std::string, say) and is compared with element == key without
+	 * converting it. A key of the element type uses find_index and its vector compares.
+	 *
+	 * @param data the array to search.
+	 * @param size the number of elements in data.
+	 * @param key the value to search for.
+	 */
+	template <typename T, typename K>
+	inline int find_key_index(const T* data, int size, const K& key)
+	{
+		if constexpr (std::is_same<T, K>::value) {
+			return find_index(data, size, key);
+		} else {
+			return find_index_if(data, size, [&key](const T& value) { return value == key; });
+		}
+	}
+
+	/**
+	 * Moves data[from] to data[to], shifting data[to .. from) back one slot.
+	 * Trivially copyable types are shifted with a single memmove, every other
+	 * type is rotated with moves instead of copies.
+	 *
+	 * @param data the array to rearrange.
+	 * @param from the current index of the element to move.
+	 * @param to the index to move the element to, no greater than from.
+	 */
+	template <typename T>
+	inline void move_forward(T* data, int from, int to)
+	{
+		if (from <= to) {
+			return;
+		} // else, the element has somewhere to go, do_nothing();
+
+		if constexpr (std::is_trivially_copyable<T>::value) {
+			alignas(T) unsigned char moving[sizeof(T)];
+			std::memcpy(moving, data + from, sizeof(T));
+			std::memmove(data + to + 1, data + to, (from - to) * sizeof(T));
+			std::memcpy(data + to, moving, sizeof(T));
+		} else {
+			std::rotate(data + to, data + from, data + from + 1);
+		}
+	}
+
+	/**
+	 * Returns uninitialized storage for capacity elements of T.
+	 */
+	template <typename T>
+	inline T* allocate_storage(int capacity)
+	{
+		auto bytes = static_cast<std::size_t>(capacity) * sizeof(T);
+		if constexpr (alignof(T) > __STDCPP_DEFAULT_NEW_ALIGNMENT__) {
+			return static_cast<T*>(::operator new(bytes, std::align_val_t(alignof(T))));
+		} else {
+			return static_cast<T*>(::operator new(bytes));
+		}
+	}
+
+	/**
+	 * Frees storage from allocate_storage. Every element in it must already be destroyed.
+	 */
+	template <typename T>
+	inline void release_storage(T* data)
+	{
+		if constexpr (alignof(T) > __STDCPP_DEFAULT_NEW_ALIGNMENT__) {
+			::operator delete(data, std::align_val_t(alignof(T)));
+		} else {
+			::operator delete(data);
+		}
+	}
+
+	/**
+	 * Moves count elements from source into uninitialized storage at destination
+	 * and destroys the originals. Trivially copyable types are copied with a
+	 * single memcpy; other types are moved, or copied when their move could
+	 * throw, so a failure leaves source untouched.
+	 *
+	 * @param source the elements to relocate.
+	 * @param count the number of elements.
+	 * @param destination uninitialized storage for at least count elements.
+	 */
+	template <typename T>
+	inline void relocate(T* source, int count, T* destination)
+	{
+		if (count <= 0) {
+			return;
+		} // else, there are elements to move, do_nothing();
+
+		if constexpr (std::is_trivially_copyable<T>::value) {
+			std::memcpy(static_cast<void*>(destination), static_cast<const void*>(source), count * sizeof(T));
+		} else {
+			if constexpr (std::is_nothrow_move_constructible<T>::value || !std::is_copy_constructible<T>::value) {
+				std::uninitialized_move(source, source + count, destination);
+			} else {
+				std::uninitialized_copy(source, source + count, destination);
+			}
+			std::destroy(source, source + count);
+		}
+	}
+
+}
+}
+
+#endif
@@ -0,0 +1,239 @@
+#include <cstdlib>
+#include <functional>
+#include <iomanip>
+#include <iostream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include "benchmark_support.h"
+#include "self_adjusting_array.h"
+#include "self_adjusting_hashed_list.h"
+#include "self_adjusting_list.h"
+#include "self_adjusting_unrolled_list.h"
+
+using nwacc::bench::key_stream;
+using nwacc::bench::record64;
+using nwacc::bench::stopwatch;
+
+/**
+ * The measurements reported for one container, element type, size and key stream.
+ */
+struct result {
+
+	double ns_per_lookup;
+
+	double average_depth;
+
+	double bytes_per_promotion;
+};
+
+/**
+ * Bytes written by one array_list promotion found at the given depth:
+ * the prefix in front of the key plus the key itself are shifted one slot.
+ */
+template <typename T>
+double promotion_bytes(const nwacc::array_list<T>&, long long depth)
+{
+	return static_cast<double>((depth + 1) * sizeof(T));
+}
+
+/**
+ * Bytes written by one linked_list promotion: the node is relinked in place,
+ * which rewrites six links and copies no element data.
+ */
+template <typename T>
+double promotion_bytes(const nwacc::linked_list<T>&, long long depth)
+{
+	return depth == 0 ? 0.0 : static_cast<double>(6 * sizeof(void*));
+}
+
+/**
+ * Bytes written by one unrolled_list promotion, roughly: on average half of the
+ * key's block slides forward to close its gap and half of the first block
+ * slides back to make room, about one block of elements in all.
+ */
+template <typename T>
+double promotion_bytes(const nwacc::unrolled_list<T>&, long long depth)
+{
+	return depth == 0 ? 0.0 : static_cast<double>(nwacc::unrolled_list<T>::k_block_capacity * sizeof(T));
+}
+
+/**
+ * Bytes written by one hashed_list promotion: the same six link writes as
+ * linked_list, the index is only read.
+ */
+template <typename T, typename Hash>
+double promotion_bytes(const nwacc::hashed_list<T, Hash>&, long long depth)
+{
+	return depth == 0 ? 0.0 : static_cast<double>(6 * sizeof(void*));
+}
+
+/**
+ * Throws unless every key was found: the streams only draw keys that are in the list.
+ */
+void check_all_found(int hits, std::size_t lookups)
+{
+	if (hits != static_cast<int>(lookups)) {
+		throw std::logic_error("A key in the list was not found");
+	} // else, every lookup hit, do_nothing();
+}
+
+/**
+ * Replays keys against a copy of base twice: once timed, and once walking the
+ * list before every find to measure how deep each key was.
+ */
+template <typename Container, typename T>
+result run(const Container& base, const std::vector<T>& keys)
+{
+	result measured{ };
+
+	auto timed = base;
+	auto hits = 0;
+	stopwatch clock;
+	for (const auto& key : keys) {
+		hits += timed.find(key) ? 1 : 0;
+	}
+	measured.ns_per_lookup = clock.elapsed_ns() / keys.size();
+	nwacc::bench::do_not_optimize(hits);
+	check_all_found(hits, keys.size());
+
+	auto walked = base;
+	auto total_depth = 0.0;
+	auto total_bytes = 0.0;
+	for (const auto& key : keys) {
+		long long depth = 0;
+		for (auto position = walked.begin(); position != walked.end() && !(*position == key); ++position) {
+			depth++;
+		}
+		total_bytes += promotion_bytes(walked, depth);
+		total_depth += static_cast<double>(depth);
+		walked.find(key);
+	}
+	measured.average_depth = total_depth / keys.size();
+	measured.bytes_per_promotion = total_bytes / keys.size();
+
+	return measured;
+}
+
+/**
+ * Times linked_list::find_many over keys in groups of k_group, reusing the
+ * depth and promotion figures of the one-at-a-time run (the final order is the same).
+ */
+template <typename T>
+result run_many(const nwacc::linked_list<T>& base, const std::vector<T>& keys, const result& one_at_a_time)
+{
+	const int k_group = 32;
+	auto measured = one_at_a_time;
+	auto timed = base;
+	auto hits = 0;
+	auto count = static_cast<int>(keys.size());
+	stopwatch clock;
+	for (auto start = 0; start < count; start += k_group) {
+		hits += timed.find_many(keys.data() + start, std::min(k_group, count - start));
+	}
+	measured.ns_per_lookup = clock.elapsed_ns() / keys.size();
+	nwacc::bench::do_not_optimize(hits);
+	check_all_found(hits, keys.size());
+	return measured;
+}
+
+void print_row(const char* container, const char* type, int size, const std::string& stream, const result& measured)
+{
+	std::cout << std::left << std::setw(15) << container
+		<< std::setw(8) << type
+		<< std::right << std::setw(9) << size << "  "
+		<< std::left << std::setw(14) << stream
+		<< std::right << std::fixed << std::setprecision(1)
+		<< std::setw(14) << measured.ns_per_lookup
+		<< std::setw(14) << measured.average_depth
+		<< std::setw(16) << measured.bytes_per_promotion << std::endl;
+}
+
+/**
+ * Runs every key stream against every container holding size elements of type T.
+ */
+template <typename T>
+void run_size(int size, long long work_budget)
+{
+	auto lookups = static_cast<int>(std::max(64LL, std::min(100000LL, work_budget / size)));
+
+	nwacc::array_list<T> array(size);
+	nwacc::linked_list<T> list;
+	nwacc::unrolled_list<T> unrolled;
+	nwacc::hashed_list<T, nwacc::bench::key_hash> hashed;
+	for (auto index = 0; index < size; index++) {
+		array.push_back(nwacc::bench::make_key<T>(index));
+		list.push_back(nwacc::bench::make_key<T>(index));
+		unrolled.push_back(nwacc::bench::make_key<T>(index));
+		hashed.push_back(nwacc::bench::make_key<T>(index));
+	}
+
+	key_stream streams(size);
+	std::vector<std::pair<std::string, std::vector<int>>> workloads;
+	workloads.emplace_back("uniform", streams.uniform(lookups));
+	workloads.emplace_back("zipf-0.8", streams.zipf(lookups, 0.8));
+	workloads.emplace_back("zipf-1.0", streams.zipf(lookups, 1.0));
+	workloads.emplace_back("zipf-1.2", streams.zipf(lookups, 1.2));
+	workloads.emplace_back("sequential", streams.sequential(lookups));
+	workloads.emplace_back("working-set", streams.working_set_shift(lookups));
+	workloads.emplace_back("always-last", streams.adversarial(lookups));
+
+	for (const auto& workload : workloads) {
+		std::vector<T> keys;
+		keys.reserve(workload.second.size());
+		for (auto index : workload.second) {
+			keys.push_back(nwacc::bench::make_key<T>(index));
+		}
+		auto array_result = run(array, keys);
+		print_row("array_list", nwacc::bench::type_name<T>(), size, workload.first, array_result);
+		auto list_result = run(list, keys);
+		print_row("linked_list", nwacc::bench::type_name<T>(), size, workload.first, list_result);
+		print_row("find_many/32", nwacc::bench::type_name<T>(), size, workload.first, run_many(list, keys, list_result));
+		auto unrolled_result = run(unrolled, keys);
+		print_row("unrolled_list", nwacc::bench::type_name<T>(), size, workload.first, unrolled_result);
+		auto hashed_result = run(hashed, keys);
+		print_row("hashed_list", nwacc::bench::type_name<T>(), size, workload.first, hashed_result);
+
+		// Every container starts in the same order and moves each key to the front, so each key is found at the same depth.
+		if (list_result.average_depth != array_result.average_depth || unrolled_result.average_depth != array_result.average_depth
+			|| hashed_result.average_depth != array_result.average_depth) {
+			throw std::logic_error("The containers disagree on search depth for " + workload.first);
+		} // else, they all moved keys alike, do_nothing();
+	}
+}
+
+/**
+ * Usage: benchmark [max_size] [work_budget]
+ *
+ * Sizes grow by 16x from 16 up to max_size (default 1M). The number of lookups per
+ * case is work_budget / size, clamped to [64, 100000], so large lists stay affordable.
+ * Exits with 1 if a lookup misses or the containers disagree on a search depth.
+ */
+int main(int argc, char* argv[])
+{
+	auto max_size = argc > 1 ? std::atoi(argv[1]) : 1 << 20;
+	auto work_budget = argc > 2 ? std::atoll(argv[2]) : 1LL << 26;
+
+	std::cout << std::left << std::setw(15) << "container"
+		<< std::setw(8) << "type"
+		<< std::right << std::setw(9) << "size" << "  "
+		<< std::left << std::setw(14) << "stream"
+		<< std::right << std::setw(14) << "ns/lookup"
+		<< std::setw(14) << "avg depth"
+		<< std::setw(16) << "bytes/promote" << std::endl;
+
+	try {
+		for (auto size = 16; size <= max_size; size *= 16) {
+			run_size<int>(size, work_budget);
+			run_size<record64>(size, work_budget);
+			run_size<std::string>(size, work_budget);
+		}
+	}
+	catch (const std::logic_error& error) {
+		std::cerr << error.what() << std::endl;
+		return 1;
+	}
+
+	return 0;
+}
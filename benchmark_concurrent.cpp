@@ -0,0 +1,164 @@
+#include <atomic>
+#include <chrono>
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include "benchmark_support.h"
+#include "self_adjusting_concurrent_list.h"
+#include "self_adjusting_list.h"
+#include "self_adjusting_sharded_list.h"
+
+using nwacc::bench::key_stream;
+
+/**
+ * linked_list behind one global mutex, the way it is shared between threads today.
+ */
+class locked_list {
+public:
+	void push_back(int value)
+	{
+		std::lock_guard<std::mutex> lock(this->guard);
+		this->list.push_back(value);
+	}
+
+	bool find(int key)
+	{
+		std::lock_guard<std::mutex> lock(this->guard);
+		return this->list.find(key);
+	}
+
+	/**
+	 * find moves key to the front, so it can then be erased with pop_front.
+	 */
+	bool erase(int key)
+	{
+		std::lock_guard<std::mutex> lock(this->guard);
+		if (!this->list.find(key)) {
+			return false;
+		} // else, key is now at the front, do_nothing();
+		this->list.pop_front();
+		return true;
+	}
+
+private:
+	std::mutex guard;
+
+	nwacc::linked_list<int> list;
+};
+
+/**
+ * sharded_list with the push_back the benchmark calls, adding keys as a set.
+ */
+class sharded_table {
+public:
+	void push_back(int value)
+	{
+		this->table.insert(value);
+	}
+
+	bool find(int key)
+	{
+		return this->table.find(key);
+	}
+
+	bool erase(int key)
+	{
+		return this->table.erase(key);
+	}
+
+private:
+	nwacc::sharded_list<int> table;
+};
+
+/**
+ * Runs threads against list for the given time and returns lookups per second.
+ * Each thread replays its own Zipf stream; with churn set, one lookup in 100
+ * is replaced by erasing the key and inserting it again at the back.
+ */
+template <typename List>
+double run(List& list, int size, int threads, int milliseconds, bool churn)
+{
+	std::vector<std::vector<int>> streams;
+	for (auto thread = 0; thread < threads; thread++) {
+		streams.push_back(key_stream(size, 1000 + thread).zipf(1 << 16, 1.0));
+	}
+
+	std::atomic<bool> running{ true };
+	std::atomic<long long> total{ 0 };
+	std::vector<std::thread> workers;
+	for (auto thread = 0; thread < threads; thread++) {
+		workers.emplace_back([&, thread]() {
+			const auto& keys = streams[thread];
+			long long lookups = 0;
+			auto hits = 0;
+			for (std::size_t index = 0; running.load(std::memory_order_relaxed); index++) {
+				auto key = keys[index & (keys.size() - 1)];
+				if (churn && index % 100 == 0) {
+					if (list.erase(key)) {
+						list.push_back(key);
+					} // else, another thread is moving key right now, do_nothing();
+				}
+				else {
+					hits += list.find(key) ? 1 : 0;
+				}
+				lookups++;
+			}
+			nwacc::bench::do_not_optimize(hits);
+			total.fetch_add(lookups);
+		});
+	}
+
+	std::this_thread::sleep_for(std::chrono::milliseconds(milliseconds));
+	running.store(false);
+	for (auto& worker : workers) {
+		worker.join();
+	}
+
+	return total.load() * 1000.0 / milliseconds;
+}
+
+/**
+ * Usage: benchmark_concurrent [list_size] [max_threads] [milliseconds]
+ *
+ * Reports millions of lookups per second for 1, 2, 4, ... max_threads threads (default 64),
+ * each configuration running for the given time (default 500 ms).
+ */
+int main(int argc, char* argv[])
+{
+	auto size = argc > 1 ? std::atoi(argv[1]) : 1024;
+	auto max_threads = argc > 2 ? std::atoi(argv[2]) : 64;
+	auto milliseconds = argc > 3 ? std::atoi(argv[3]) : 500;
+
+	std::cout << "list size " << size << ", zipf-1.0 keys, " << std::thread::hardware_concurrency() << " hardware threads" << std::endl;
+	std::cout << std::left << std::setw(9) << "threads"
+		<< std::right << std::setw(20) << "mutex+linked_list"
+		<< std::setw(18) << "concurrent_list"
+		<< std::setw(22) << "concurrent 1% churn"
+		<< std::setw(16) << "sharded_list" << "   (Mlookups/s)" << std::endl;
+
+	for (auto threads = 1; threads <= max_threads; threads *= 2) {
+		locked_list baseline;
+		nwacc::concurrent_list<int> concurrent;
+		nwacc::concurrent_list<int> churned;
+		sharded_table sharded;
+		for (auto index = 0; index < size; index++) {
+			baseline.push_back(index);
+			concurrent.push_back(index);
+			churned.push_back(index);
+			sharded.push_back(index);
+		}
+
+		std::cout << std::left << std::setw(9) << threads
+			<< std::right << std::fixed << std::setprecision(2)
+			<< std::setw(20) << run(baseline, size, threads, milliseconds, false) / 1e6
+			<< std::setw(18) << run(concurrent, size, threads, milliseconds, false) / 1e6
+			<< std::setw(22) << run(churned, size, threads, milliseconds, true) / 1e6
+			<< std::setw(16) << run(sharded, size, threads, milliseconds, false) / 1e6 << std::endl;
+	}
+
+	return 0;
+}
@@ -0,0 +1,104 @@
+#include <algorithm>
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
+#include <memory>
+#include <thread>
+#include <vector>
+
+#include "benchmark_support.h"
+#include "scan_pool.h"
+#include "self_adjusting_array.h"
+
+using nwacc::bench::stopwatch;
+
+/**
+ * Times lookups of the current last element (the deepest hit, followed by a
+ * rotation of the whole array) and returns ns per lookup.
+ */
+double deepest_hits(nwacc::array_list<int>& list, int lookups)
+{
+	auto hits = 0;
+	stopwatch clock;
+	for (auto lookup = 0; lookup < lookups; lookup++) {
+		hits += list.find(list.back()) ? 1 : 0;
+	}
+	auto ns = clock.elapsed_ns() / lookups;
+	nwacc::bench::do_not_optimize(hits);
+	return ns;
+}
+
+/**
+ * Times lookups of a key that is not in the list (a full scan) and returns ns per lookup.
+ */
+double misses(nwacc::array_list<int>& list, int lookups)
+{
+	auto hits = 0;
+	stopwatch clock;
+	for (auto lookup = 0; lookup < lookups; lookup++) {
+		hits += list.find(-1 - lookup) ? 1 : 0;
+	}
+	auto ns = clock.elapsed_ns() / lookups;
+	nwacc::bench::do_not_optimize(hits);
+	return ns;
+}
+
+/**
+ * Usage: benchmark_parallel_find [max_size=16M] [max_threads=hardware] [work_budget=1<<30]
+ *
+ * Measures array_list::find on arrays of 64K, 256K, ... max_size ints with a
+ * serial scan and with scan_in_parallel over pools of 1, 2, 4, ... max_threads
+ * threads (threshold 0, so every scan is split), for misses and for hits on
+ * the last element. Lookups per case are work_budget / size, clamped to [4, 2000].
+ */
+int main(int argc, char* argv[])
+{
+	auto max_size = argc > 1 ? std::atoi(argv[1]) : 1 << 24;
+	auto hardware = std::max(1, static_cast<int>(std::thread::hardware_concurrency()));
+	auto max_threads = argc > 2 ? std::atoi(argv[2]) : hardware;
+	auto work_budget = argc > 3 ? std::atoll(argv[3]) : 1LL << 30;
+
+	std::vector<int> thread_counts;
+	for (auto threads = 1; threads < max_threads; threads *= 2) {
+		thread_counts.push_back(threads);
+	}
+	thread_counts.push_back(std::max(1, max_threads));
+
+	std::vector<std::unique_ptr<nwacc::scan_pool>> pools;
+	for (auto threads : thread_counts) {
+		pools.push_back(std::make_unique<nwacc::scan_pool>(threads));
+	}
+
+	std::cout << hardware << " hardware threads" << std::endl;
+	std::cout << std::left << std::setw(10) << "size" << std::setw(9) << "threads"
+		<< std::right << std::setw(14) << "miss ns" << std::setw(10) << "speedup"
+		<< std::setw(14) << "deep hit ns" << std::setw(10) << "speedup" << std::endl;
+
+	for (auto size = 1 << 16; size <= max_size; size *= 4) {
+		auto lookups = static_cast<int>(std::max(4LL, std::min(2000LL, work_budget / size)));
+		nwacc::array_list<int> list(size);
+		for (auto index = 0; index < size; index++) {
+			list.push_back(index);
+		}
+
+		auto serial_miss = misses(list, lookups);
+		auto serial_hit = deepest_hits(list, lookups);
+		std::cout << std::left << std::setw(10) << size << std::setw(9) << "serial"
+			<< std::right << std::fixed << std::setprecision(1)
+			<< std::setw(14) << serial_miss << std::setw(10) << 1.0
+			<< std::setw(14) << serial_hit << std::setw(10) << 1.0 << std::endl;
+
+		for (std::size_t pool = 0; pool < pools.size(); pool++) {
+			list.scan_in_parallel(pools[pool].get(), 0);
+			auto miss = misses(list, lookups);
+			auto hit = deepest_hits(list, lookups);
+			std::cout << std::left << std::setw(10) << size << std::setw(9) << thread_counts[pool]
+				<< std::right << std::fixed << std::setprecision(1)
+				<< std::setw(14) << miss << std::setw(10) << serial_miss / miss
+				<< std::setw(14) << hit << std::setw(10) << serial_hit / hit << std::endl;
+		}
+		list.scan_in_parallel(nullptr);
+	}
+
+	return 0;
+}
@@ -0,0 +1,107 @@
+#include <algorithm>
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "benchmark_support.h"
+#include "self_adjusting_array.h"
+#include "self_adjusting_list.h"
+#include "self_adjusting_splay_tree.h"
+
+using nwacc::bench::key_stream;
+using nwacc::bench::stopwatch;
+
+/**
+ * Times find over keys against a copy of base and returns ns per lookup.
+ */
+template <typename Container>
+double run(const Container& base, const std::vector<int>& keys)
+{
+	auto timed = base;
+	auto hits = 0;
+	stopwatch clock;
+	for (auto key : keys) {
+		hits += timed.find(key) ? 1 : 0;
+	}
+	auto ns = clock.elapsed_ns() / keys.size();
+	nwacc::bench::do_not_optimize(hits);
+	return ns;
+}
+
+/**
+ * Usage: benchmark_splay [max_size] [work_budget]
+ *
+ * Compares array_list, linked_list and splay_tree holding 16, 64, ... max_size ints
+ * (default 64K) and reports, per key stream, the smallest size at which splay_tree
+ * beats both lists. Lookups per case are work_budget / size, clamped to [64, 100000].
+ */
+int main(int argc, char* argv[])
+{
+	auto max_size = argc > 1 ? std::atoi(argv[1]) : 1 << 16;
+	auto work_budget = argc > 2 ? std::atoll(argv[2]) : 1LL << 24;
+
+	std::vector<std::string> names{ "uniform", "zipf-1.0", "zipf-1.2", "working-set" };
+	std::vector<int> crossover(names.size(), 0);
+
+	std::cout << std::left << std::setw(14) << "stream"
+		<< std::right << std::setw(9) << "size"
+		<< std::setw(14) << "array_list"
+		<< std::setw(14) << "linked_list"
+		<< std::setw(14) << "splay_tree" << "   (ns/lookup)" << std::endl;
+
+	for (auto size = 16; size <= max_size; size *= 4) {
+		auto lookups = static_cast<int>(std::max(64LL, std::min(100000LL, work_budget / size)));
+		nwacc::array_list<int> array(size);
+		nwacc::linked_list<int> list;
+		nwacc::splay_tree<int> tree;
+		// Insert in random order, so neither the lists start with the hot keys in
+		// front nor the tree starts out as one long path.
+		std::vector<int> order(size);
+		for (auto index = 0; index < size; index++) {
+			order[index] = index;
+		}
+		std::shuffle(order.begin(), order.end(), std::mt19937(7));
+		for (auto key : order) {
+			array.push_back(key);
+			list.push_back(key);
+			tree.insert(key);
+		}
+
+		key_stream streams(size);
+		std::vector<std::vector<int>> workloads{
+			streams.uniform(lookups), streams.zipf(lookups, 1.0),
+			streams.zipf(lookups, 1.2), streams.working_set_shift(lookups) };
+
+		for (std::size_t workload = 0; workload < workloads.size(); workload++) {
+			auto array_ns = run(array, workloads[workload]);
+			auto list_ns = run(list, workloads[workload]);
+			auto tree_ns = run(tree, workloads[workload]);
+			if (crossover[workload] == 0 && tree_ns < array_ns && tree_ns < list_ns) {
+				crossover[workload] = size;
+			} // else, the crossover is already known or not reached yet, do_nothing();
+
+			std::cout << std::left << std::setw(14) << names[workload]
+				<< std::right << std::setw(9) << size
+				<< std::fixed << std::setprecision(1)
+				<< std::setw(14) << array_ns
+				<< std::setw(14) << list_ns
+				<< std::setw(14) << tree_ns << std::endl;
+		}
+	}
+
+	std::cout << std::endl << "smallest size where splay_tree beats both lists:" << std::endl;
+	for (std::size_t workload = 0; workload < names.size(); workload++) {
+		std::cout << "  " << std::left << std::setw(14) << names[workload];
+		if (crossover[workload] == 0) {
+			std::cout << "not reached up to " << max_size << std::endl;
+		}
+		else {
+			std::cout << crossover[workload] << std::endl;
+		}
+	}
+
+	return 0;
+}
@@ -0,0 +1,98 @@
+#include <algorithm>
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "benchmark_support.h"
+#include "self_adjusting_array.h"
+#include "self_adjusting_static_array.h"
+
+using nwacc::bench::key_stream;
+using nwacc::bench::stopwatch;
+
+/**
+ * Times find over keys against a copy of base and returns ns per lookup.
+ */
+template <typename Container>
+double run(const Container& base, const std::vector<int>& keys)
+{
+	auto timed = base;
+	auto hits = 0;
+	stopwatch clock;
+	for (auto key : keys) {
+		hits += timed.find(key) ? 1 : 0;
+	}
+	auto ns = clock.elapsed_ns() / keys.size();
+	nwacc::bench::do_not_optimize(hits);
+	return ns;
+}
+
+/**
+ * Fills the three tables with the ints 0 to N - 1 in random order and prints
+ * one row per key stream. Keys range over N + N / 4 values, so about one
+ * lookup in five is a miss.
+ */
+template <int N>
+void compare(int lookups)
+{
+	nwacc::array_list<int> array;
+	nwacc::small_array_list<int, N> small;
+	nwacc::static_self_adjusting_array<int, N> fixed;
+	std::vector<int> order(N);
+	for (auto index = 0; index < N; index++) {
+		order[index] = index;
+	}
+	std::shuffle(order.begin(), order.end(), std::mt19937(7));
+	for (auto key : order) {
+		array.push_back(key);
+		small.push_back(key);
+		fixed.push_back(key);
+	}
+
+	key_stream streams(N + N / 4);
+	std::vector<std::string> names{ "uniform", "zipf-1.0", "zipf-1.2" };
+	std::vector<std::vector<int>> workloads{
+		streams.uniform(lookups), streams.zipf(lookups, 1.0), streams.zipf(lookups, 1.2) };
+
+	for (std::size_t workload = 0; workload < workloads.size(); workload++) {
+		auto array_ns = run(array, workloads[workload]);
+		auto small_ns = run(small, workloads[workload]);
+		auto fixed_ns = run(fixed, workloads[workload]);
+		std::cout << std::left << std::setw(14) << names[workload]
+			<< std::right << std::setw(6) << N
+			<< std::fixed << std::setprecision(2)
+			<< std::setw(14) << array_ns
+			<< std::setw(18) << small_ns
+			<< std::setw(18) << fixed_ns
+			<< std::setw(10) << array_ns / fixed_ns << "x" << std::endl;
+	}
+}
+
+/**
+ * Usage: benchmark_static [lookups]
+ *
+ * Compares array_list, small_array_list and static_self_adjusting_array
+ * holding 8, 16, 32 and 64 ints, all moving found keys to the front, and
+ * prints ns per lookup and the speedup of the fixed array over array_list.
+ */
+int main(int argc, char* argv[])
+{
+	auto lookups = argc > 1 ? std::atoi(argv[1]) : 1 << 22;
+
+	std::cout << std::left << std::setw(14) << "stream"
+		<< std::right << std::setw(6) << "size"
+		<< std::setw(14) << "array_list"
+		<< std::setw(18) << "small_array_list"
+		<< std::setw(18) << "static_array"
+		<< std::setw(11) << "speedup" << "   (ns/lookup)" << std::endl;
+
+	compare<8>(lookups);
+	compare<16>(lookups);
+	compare<32>(lookups);
+	compare<64>(lookups);
+
+	return 0;
+}
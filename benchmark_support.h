@@ -0,0 +1,268 @@
+#ifndef BENCHMARK_SUPPORT_H
+#define BENCHMARK_SUPPORT_H
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <functional>
+#include <numeric>
+#include <random>
+#include <string>
+#include <vector>
+
+namespace nwacc {
+namespace bench {
+
+	/**
+	 * A 64-byte plain-old-data element, standing in for the small records
+	 * (ids plus a fixed payload) that are kept in self-adjusting tables.
+	 */
+	struct record64 {
+
+		std::int64_t id;
+
+		char payload[56];
+
+		bool operator==(const record64& rhs) const
+		{
+			return this->id == rhs.id;
+		}
+	};
+
+	/**
+	 * Hashes every benchmarked element type.
+	 */
+	struct key_hash {
+
+		template <typename T>
+		std::size_t operator()(const T& value) const
+		{
+			return std::hash<T>{ }(value);
+		}
+
+		std::size_t operator()(const record64& value) const
+		{
+			return std::hash<std::int64_t>{ }(value.id);
+		}
+	};
+
+	/**
+	 * Builds the element with the given index for each benchmarked element type.
+	 * Strings are long enough to defeat the small string optimization.
+	 */
+	template <typename T>
+	T make_key(int index);
+
+	template <>
+	inline int make_key<int>(int index)
+	{
+		return index;
+	}
+
+	template <>
+	inline record64 make_key<record64>(int index)
+	{
+		record64 value;
+		value.id = index;
+		std::memset(value.payload, index & 0x7f, sizeof(value.payload));
+		return value;
+	}
+
+	template <>
+	inline std::string make_key<std::string>(int index)
+	{
+		auto digits = std::to_string(index);
+		return "session-key-" + std::string(10 - std::min<std::size_t>(digits.size(), 10), '0') + digits;
+	}
+
+	/**
+	 * Returns a human readable name for each benchmarked element type.
+	 */
+	template <typename T>
+	const char* type_name();
+
+	template <>
+	inline const char* type_name<int>()
+	{
+		return "int";
+	}
+
+	template <>
+	inline const char* type_name<record64>()
+	{
+		return "pod64";
+	}
+
+	template <>
+	inline const char* type_name<std::string>()
+	{
+		return "string";
+	}
+
+	/**
+	 * Draws ranks in [0, n) with probability proportional to 1 / (rank + 1)^skew.
+	 */
+	class zipf_distribution {
+	public:
+		zipf_distribution(int n, double skew) : cdf(n)
+		{
+			auto total = 0.0;
+			for (auto rank = 0; rank < n; rank++) {
+				total += 1.0 / std::pow(rank + 1.0, skew);
+				this->cdf[rank] = total;
+			}
+			for (auto& value : this->cdf) {
+				value /= total;
+			}
+		}
+
+		template <typename Generator>
+		int operator()(Generator& generator)
+		{
+			auto sample = std::uniform_real_distribution<double>(0.0, 1.0)(generator);
+			auto position = std::lower_bound(this->cdf.begin(), this->cdf.end(), sample);
+			if (position == this->cdf.end()) {
+				return static_cast<int>(this->cdf.size()) - 1;
+			} // else, sample fell inside the table, do_nothing();
+			return static_cast<int>(position - this->cdf.begin());
+		}
+
+	private:
+		std::vector<double> cdf;
+	};
+
+	/**
+	 * Generates a stream of element indices for a list holding 0 .. size - 1
+	 * in ascending order (the order the benchmarks populate it in).
+	 */
+	class key_stream {
+	public:
+		explicit key_stream(int size, std::uint64_t seed = 42) : size{ size }, generator{ seed }
+		{ }
+
+		/**
+		 * Every element is equally likely.
+		 */
+		std::vector<int> uniform(int count)
+		{
+			std::uniform_int_distribution<int> pick(0, this->size - 1);
+			std::vector<int> keys(count);
+			for (auto& key : keys) {
+				key = pick(this->generator);
+			}
+			return keys;
+		}
+
+		/**
+		 * Zipf distributed ranks, mapped onto a random permutation of the
+		 * elements so the hot set does not start at the front of the list.
+		 */
+		std::vector<int> zipf(int count, double skew)
+		{
+			auto order = this->permutation();
+			zipf_distribution pick(this->size, skew);
+			std::vector<int> keys(count);
+			for (auto& key : keys) {
+				key = order[pick(this->generator)];
+			}
+			return keys;
+		}
+
+		/**
+		 * Repeated front-to-back scans over every element.
+		 */
+		std::vector<int> sequential(int count)
+		{
+			std::vector<int> keys(count);
+			for (auto index = 0; index < count; index++) {
+				keys[index] = index % this->size;
+			}
+			return keys;
+		}
+
+		/**
+		 * Uniform lookups inside a small hot set that moves to a different
+		 * part of the key space several times during the stream.
+		 */
+		std::vector<int> working_set_shift(int count, int working_set = 64, int phases = 8)
+		{
+			working_set = std::min(working_set, this->size);
+			auto order = this->permutation();
+			auto phase_length = std::max(1, count / phases);
+			std::uniform_int_distribution<int> pick(0, working_set - 1);
+			std::uniform_int_distribution<int> shift(0, this->size - working_set);
+			std::vector<int> keys(count);
+			auto offset = 0;
+			for (auto index = 0; index < count; index++) {
+				if (index % phase_length == 0) {
+					offset = shift(this->generator);
+				} // else, we are still inside the current phase, do_nothing();
+				keys[index] = order[offset + pick(this->generator)];
+			}
+			return keys;
+		}
+
+		/**
+		 * Always asks for the element currently at the back of a move-to-front list.
+		 * Starting from ascending order that is size - 1, size - 2, ..., 0 and repeat.
+		 */
+		std::vector<int> adversarial(int count)
+		{
+			std::vector<int> keys(count);
+			for (auto index = 0; index < count; index++) {
+				keys[index] = this->size - 1 - (index % this->size);
+			}
+			return keys;
+		}
+
+	private:
+		int size;
+
+		std::mt19937_64 generator;
+
+		std::vector<int> permutation()
+		{
+			std::vector<int> order(this->size);
+			std::iota(order.begin(), order.end(), 0);
+			std::shuffle(order.begin(), order.end(), this->generator);
+			return order;
+		}
+	};
+
+	/**
+	 * Measures elapsed wall time in nanoseconds.
+	 */
+	class stopwatch {
+	public:
+		stopwatch() : start{ std::chrono::steady_clock::now() }
+		{ }
+
+		double elapsed_ns() const
+		{
+			return std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - this->start).count();
+		}
+
+	private:
+		std::chrono::steady_clock::time_point start;
+	};
+
+	/**
+	 * Keeps the compiler from discarding a computed value.
+	 */
+	template <typename T>
+	inline void do_not_optimize(const T& value)
+	{
+#if defined(__GNUC__) || defined(__clang__)
+		asm volatile("" : : "r,m"(value) : "memory");
+#else
+		static volatile const T* sink;
+		sink = &value;
+#endif
+	}
+
+}
+}
+
+#endif
@@ -0,0 +1,1143 @@
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <iostream>
+#include <memory_resource>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <vector>
+
+#include "access_stats.h"
+#include "mtf_transform.h"
+#include "scan_pool.h"
+#include "self_adjusting_array.h"
+#include "self_adjusting_concurrent_list.h"
+#include "self_adjusting_hashed_list.h"
+#include "self_adjusting_intrusive_list.h"
+#include "self_adjusting_list.h"
+#include "self_adjusting_map.h"
+#include "self_adjusting_sharded_list.h"
+#include "self_adjusting_splay_tree.h"
+#include "self_adjusting_static_array.h"
+#include "self_adjusting_tiered_list.h"
+#include "self_adjusting_unrolled_list.h"
+
+namespace {
+
+	/**
+	 * The number of checks that did not hold.
+	 */
+	int failures = 0;
+
+	/**
+	 * Reports what when condition does not hold.
+	 */
+	void check(bool condition, const char* what)
+	{
+		if (!condition) {
+			std::cerr << "FAILED: " << what << std::endl;
+			failures++;
+		} // else, the check passed, do_nothing();
+	}
+
+	/**
+	 * An int whose copy constructor throws once copies_left reaches zero, and
+	 * that counts its live instances so a check can tell if one leaked.
+	 */
+	struct fragile {
+
+		static int copies_left;
+
+		static int live;
+
+		int value;
+
+		fragile(int value = 0) : value{ value }
+		{
+			live++;
+		}
+
+		fragile(const fragile& rhs) : value{ rhs.value }
+		{
+			if (copies_left >= 0 && copies_left-- == 0) {
+				throw std::runtime_error("copy failed");
+			} // else, copying is allowed, do_nothing();
+			live++;
+		}
+
+		~fragile()
+		{
+			live--;
+		}
+
+		fragile& operator=(const fragile&) = default;
+
+		bool operator==(const fragile& rhs) const
+		{
+			return this->value == rhs.value;
+		}
+
+		bool operator<(const fragile& rhs) const
+		{
+			return this->value < rhs.value;
+		}
+	};
+
+	int fragile::copies_left = -1;
+
+	int fragile::live = 0;
+
+	struct fragile_hash {
+
+		std::size_t operator()(const fragile& key) const
+		{
+			return std::hash<int>()(key.value);
+		}
+	};
+
+	/**
+	 * The number of allocations made through any counting_allocator.
+	 */
+	int allocations = 0;
+
+	/**
+	 * Whether a counting_allocator refuses to allocate access counters.
+	 */
+	bool counters_fail = false;
+
+	/**
+	 * A std::allocator that counts the allocations made through it, and that
+	 * throws bad_alloc for access counters while counters_fail is set.
+	 */
+	template <typename T>
+	struct counting_allocator : std::allocator<T> {
+
+		using value_type = T;
+
+		template <typename U>
+		struct rebind {
+			using other = counting_allocator<U>;
+		};
+
+		counting_allocator() = default;
+
+		template <typename U>
+		counting_allocator(const counting_allocator<U>&)
+		{ }
+
+		T* allocate(std::size_t count)
+		{
+			if (std::is_same<T, nwacc::access_counter>::value && counters_fail) {
+				throw std::bad_alloc();
+			} // else, the allocation is allowed, do_nothing();
+			allocations++;
+			return std::allocator<T>::allocate(count);
+		}
+	};
+
+	template <typename T, typename U>
+	bool operator==(const counting_allocator<T>&, const counting_allocator<U>&)
+	{
+		return true;
+	}
+
+	template <typename T, typename U>
+	bool operator!=(const counting_allocator<T>&, const counting_allocator<U>&)
+	{
+		return false;
+	}
+
+	/**
+	 * A memory resource that forwards to new and delete and keeps track of
+	 * what is still allocated.
+	 */
+	class counting_resource : public std::pmr::memory_resource {
+	public:
+
+		int allocations = 0;
+
+		std::size_t outstanding = 0;
+
+	private:
+		void* do_allocate(std::size_t bytes, std::size_t alignment) override
+		{
+			this->allocations++;
+			this->outstanding += bytes;
+			return std::pmr::new_delete_resource()->allocate(bytes, alignment);
+		}
+
+		void do_deallocate(void* address, std::size_t bytes, std::size_t alignment) override
+		{
+			this->outstanding -= bytes;
+			std::pmr::new_delete_resource()->deallocate(address, bytes, alignment);
+		}
+
+		bool do_is_equal(const std::pmr::memory_resource& other) const noexcept override
+		{
+			return this == &other;
+		}
+	};
+
+	/**
+	 * Returns the elements of container, front to back.
+	 */
+	template <typename Container>
+	std::vector<int> contents(const Container& container)
+	{
+		std::vector<int> values;
+		for (const auto& value : container) {
+			if constexpr (std::is_same<typename std::decay<decltype(value)>::type, fragile>::value) {
+				values.push_back(value.value);
+			} else {
+				values.push_back(value);
+			}
+		}
+		return values;
+	}
+
+	/**
+	 * linked_list: find relinks the found node to the front, so the element
+	 * keeps its address, and neither finds nor an erase followed by an insert
+	 * allocate, since erased nodes go back to the list's pool.
+	 */
+	void check_linked_list()
+	{
+		nwacc::linked_list<int, nwacc::move_to_front, nwacc::no_stats, counting_allocator<int>> list;
+		for (auto value = 0; value < 100; value++) {
+			list.push_back(value);
+		}
+		const auto* last = &list.back();
+		auto allocated = allocations;
+		check(list.find(99) && &list.front() == last && list.front() == 99, "linked_list: find relinks the node to the front");
+		for (auto value = 0; value < 100; value++) {
+			list.find(value);
+		}
+		list.erase(50);
+		list.push_front(50);
+		check(allocated > 0 && allocations == allocated && list.size() == 100,
+			"linked_list: finds and reusing an erased node allocate nothing");
+	}
+
+	/**
+	 * Returns whether find_index agrees with a plain loop on every position of
+	 * arrays of T up to four vector blocks and a tail long, hits and misses.
+	 */
+	template <typename T>
+	bool finds_like_a_loop()
+	{
+		std::vector<T> values;
+		for (auto size = 0; size < 140; size++) {
+			for (auto index = 0; index < size; index++) {
+				if (nwacc::detail::find_index(values.data(), size, values[index]) != index) {
+					return false;
+				} // else, the hit is at the right place, do_nothing();
+			}
+			values.push_back(static_cast<T>(size + 1));
+			if (nwacc::detail::find_index(values.data(), size, values[size]) != -1) {
+				return false;
+			} // else, the value just past the end is not found, do_nothing();
+		}
+		return true;
+	}
+
+	/**
+	 * array_list: the vector search finds what a plain loop finds for every
+	 * searchable type, and a found element is rotated to the front.
+	 */
+	void check_array_search()
+	{
+		check(finds_like_a_loop<char>(), "find_index: char");
+		check(finds_like_a_loop<short>(), "find_index: short");
+		check(finds_like_a_loop<int>(), "find_index: int");
+		check(finds_like_a_loop<long long>(), "find_index: long long");
+		check(finds_like_a_loop<float>(), "find_index: float");
+		check(finds_like_a_loop<double>(), "find_index: double");
+
+		double signed_zeros[] = { 1.0, -0.0, std::nan("") };
+		check(nwacc::detail::find_index(signed_zeros, 3, 0.0) == 1 && nwacc::detail::find_index(signed_zeros, 3, std::nan("")) == -1,
+			"find_index: doubles compare like operator==");
+
+		int targets[40];
+		std::vector<const int*> pointers;
+		for (const auto& target : targets) {
+			pointers.push_back(&target);
+		}
+		check(nwacc::detail::find_index(pointers.data(), 40, pointers[37]) == 37 && nwacc::detail::find_index(pointers.data(), 39, pointers[39]) == -1,
+			"find_index: pointers");
+
+		nwacc::array_list<int> list;
+		for (auto value = 0; value < 100; value++) {
+			list.push_back(value);
+		}
+		list.find(70);
+		auto order = contents(list);
+		check(order[0] == 70 && order[1] == 0 && order[70] == 69 && order[71] == 71, "array_list: find rotates the hit to the front");
+	}
+
+	/**
+	 * array_list growth: reserve constructs no elements in the spare
+	 * capacity, and a growth whose element copy throws leaves the list as it was.
+	 */
+	void check_array_growth()
+	{
+		nwacc::array_list<fragile> list;
+		for (auto value = 0; value < 4; value++) {
+			list.push_back(fragile(value));
+		}
+		auto live = fragile::live;
+		list.reserve(1000);
+		check(list.capacity() >= 1000 && fragile::live == live && contents(list) == std::vector<int>{ 0, 1, 2, 3 },
+			"array_list: reserve leaves the spare capacity unconstructed");
+
+		nwacc::array_list<fragile> full;
+		full.reserve(4);
+		while (full.size() < full.capacity()) {
+			full.push_back(fragile(full.size()));
+		}
+		auto before = contents(full);
+		auto capacity = full.capacity();
+		fragile::copies_left = 2;
+		auto threw = false;
+		try {
+			full.reserve(2 * capacity);
+		}
+		catch (const std::runtime_error&) {
+			threw = true;
+		}
+		fragile::copies_left = -1;
+		check(threw && full.capacity() == capacity && contents(full) == before && fragile::live == live + full.size(),
+			"array_list: a growth that throws keeps the old elements");
+
+		// The counters are allocated after the elements' storage; neither may leak, nor may elements move, if that fails.
+		const std::string first(40, 'a');
+		const std::string second(40, 'b');
+		nwacc::array_list<std::string, nwacc::frequency_count, nwacc::no_stats, counting_allocator<std::string>> counted;
+		counted.push_back(first);
+		counted.push_back(second);
+		capacity = counted.capacity();
+		counters_fail = true;
+		auto grew = true;
+		try {
+			counted.reserve(100);
+		}
+		catch (const std::bad_alloc&) {
+			grew = false;
+		}
+		auto constructed = true;
+		try {
+			decltype(counted) refused(64);
+		}
+		catch (const std::bad_alloc&) {
+			constructed = false;
+		}
+		counters_fail = false;
+		check(!grew && !constructed && counted.size() == 2 && counted.capacity() == capacity && counted[0] == first && counted[1] == second,
+			"array_list: a growth whose counters cannot be allocated keeps the old elements");
+		check(counted.find(second) && counted[0] == second, "array_list: counters still work after a failed growth");
+	}
+
+	/**
+	 * Returns the order of 0 to 5 after finding 4, 4, 2 and 5 in List.
+	 */
+	template <typename List>
+	std::vector<int> order_after_finds()
+	{
+		List list;
+		for (auto value = 0; value < 6; value++) {
+			list.push_back(value);
+		}
+		for (auto key : { 4, 4, 2, 5 }) {
+			list.find(key);
+		}
+		return contents(list);
+	}
+
+	template <typename Policy>
+	using array_of_ints = nwacc::array_list<int, Policy>;
+
+	template <typename Policy>
+	using list_of_ints = nwacc::linked_list<int, Policy>;
+
+	/**
+	 * Policies: each moves a found element as far as its rule says, the same
+	 * way in both containers.
+	 */
+	template <template <typename> class List>
+	void check_policies(const char* move_to_front, const char* transpose, const char* move_ahead, const char* frequency_count)
+	{
+		check(order_after_finds<List<nwacc::move_to_front>>() == std::vector<int>{ 5, 2, 4, 0, 1, 3 }, move_to_front);
+		check(order_after_finds<List<nwacc::transpose>>() == std::vector<int>{ 0, 1, 2, 4, 5, 3 }, transpose);
+		check(order_after_finds<List<nwacc::move_ahead_k<2>>>() == std::vector<int>{ 4, 2, 0, 5, 1, 3 }, move_ahead);
+		check(order_after_finds<List<nwacc::frequency_count>>() == std::vector<int>{ 4, 2, 5, 0, 1, 3 }, frequency_count);
+	}
+
+	/**
+	 * Statistics: a hit, a repeated hit and a miss are each counted once, with
+	 * the depth and the promotion of the first hit.
+	 */
+	template <typename List>
+	void check_statistics(const char* counted, const char* reset)
+	{
+		List list;
+		for (auto value = 0; value < 10; value++) {
+			list.push_back(value);
+		}
+		list.find(5);
+		list.find(5);
+		list.find(42);
+		auto counters = list.statistics().snapshot();
+		check(counters.lookups == 3 && counters.hits == 2 && counters.misses == 1
+			&& counters.promotions == 1 && counters.elements_shifted == 5 && counters.total_hit_depth == 5
+			&& counters.depth_histogram[0] == 1 && counters.depth_histogram[3] == 1 && counters.latency_samples == 1, counted);
+		list.statistics().reset();
+		check(list.statistics().snapshot().lookups == 0, reset);
+	}
+
+	/**
+	 * Deferred promotions: finds only record hits until the batch is applied,
+	 * and erasing a range applies the hits on the elements that stay.
+	 */
+	void check_deferred_promotions()
+	{
+		nwacc::array_list<int> array;
+		nwacc::linked_list<int> list;
+		for (auto value = 0; value < 4; value++) {
+			array.push_back(value);
+			list.push_back(value);
+		}
+		array.defer_promotions(8);
+		list.defer_promotions(8);
+		array.find(3);
+		array.find(2);
+		list.find(3);
+		list.find(2);
+		check(contents(array) == std::vector<int>{ 0, 1, 2, 3 }, "array_list: deferred finds leave the order alone");
+		check(array.pending_promotions() == 2, "array_list: deferred finds are recorded");
+		array.flush_promotions();
+		check(contents(array) == std::vector<int>{ 2, 3, 0, 1 }, "array_list: a flush moves the newest hit furthest forward");
+		list.flush_promotions();
+		check(contents(list) == std::vector<int>{ 2, 3, 0, 1 }, "linked_list: a flush moves the newest hit furthest forward");
+		for (auto key : { 1, 0, 1, 1, 0, 3, 0, 3 }) {
+			array.find(key);
+			list.find(key);
+		}
+		check(array.pending_promotions() == 0, "array_list: a full batch is applied");
+		check(contents(array) == std::vector<int>{ 3, 0, 1, 2 }, "array_list: repeated hits are coalesced");
+		check(contents(list) == std::vector<int>{ 3, 0, 1, 2 }, "linked_list: repeated hits are coalesced");
+
+		// Without counters a deferred element moves one step per hit.
+		nwacc::array_list<int, nwacc::transpose> swapped;
+		nwacc::linked_list<int, nwacc::transpose> relinked;
+		for (auto value = 0; value < 4; value++) {
+			swapped.push_back(value);
+			relinked.push_back(value);
+		}
+		swapped.defer_promotions(8);
+		relinked.defer_promotions(8);
+		for (auto hit = 0; hit < 2; hit++) {
+			swapped.find(3);
+			relinked.find(3);
+		}
+		swapped.flush_promotions();
+		relinked.flush_promotions();
+		check(contents(swapped) == std::vector<int>{ 0, 3, 1, 2 }, "array_list: two deferred transpose hits move two steps");
+		check(contents(relinked) == std::vector<int>{ 0, 3, 1, 2 }, "linked_list: two deferred transpose hits move two steps");
+
+		// The range is the one the caller sees, even though a deferred hit would move its end.
+		nwacc::linked_list<int> erased;
+		for (auto value = 0; value < 4; value++) {
+			erased.push_back(value);
+		}
+		erased.defer_promotions(8);
+		erased.find(3);
+		auto from = erased.begin();
+		++from;
+		auto to = from;
+		++to;
+		++to;
+		erased.erase(from, to);
+		check(contents(erased) == std::vector<int>{ 3, 0 }, "linked_list: erasing a range applies the other deferred hits");
+		check(erased.size() == 2 && erased.pending_promotions() == 0, "linked_list: erasing a range flushes");
+	}
+
+	/**
+	 * unrolled_list: finds leave the same order as linked_list, and erasing
+	 * merges emptied blocks so they stay at least half full.
+	 */
+	void check_unrolled_list()
+	{
+		nwacc::unrolled_list<int> blocks;
+		nwacc::linked_list<int> nodes;
+		for (auto value = 0; value < 200; value++) {
+			blocks.push_back(value);
+			nodes.push_back(value);
+		}
+		for (auto step = 0; step < 600; step++) {
+			auto key = (step * 37) % 211;
+			check(blocks.find(key) == nodes.find(key), "unrolled_list: find hits what linked_list hits");
+		}
+		check(contents(blocks) == contents(nodes), "unrolled_list: finds move elements like linked_list");
+
+		for (auto position = blocks.begin(); position != blocks.end();) {
+			if (*position % 3 == 0) {
+				++position;
+			}
+			else {
+				position = blocks.erase(position);
+			}
+		}
+		auto per_block = nwacc::unrolled_list<int>::k_block_capacity;
+		check(blocks.size() == 67 && blocks.blocks() <= 2 * ((blocks.size() + per_block - 1) / per_block) + 1,
+			"unrolled_list: erasing merges blocks that fall below half full");
+	}
+
+	struct by_recency { };
+
+	struct by_owner { };
+
+	/**
+	 * An object that can be in two intrusive lists at once.
+	 */
+	struct session : nwacc::intrusive_list_hook<by_recency>, nwacc::intrusive_list_hook<by_owner> {
+
+		int id;
+
+		bool operator==(int key) const
+		{
+			return this->id == key;
+		}
+	};
+
+	/**
+	 * intrusive_list: find moves the caller's own object to the front, one
+	 * object can be in two lists through two hooks, and erase unlinks it.
+	 */
+	void check_intrusive_list()
+	{
+		session sessions[4] = { { {}, {}, 0 }, { {}, {}, 1 }, { {}, {}, 2 }, { {}, {}, 3 } };
+		nwacc::intrusive_list<session, by_recency> recent;
+		nwacc::intrusive_list<session, by_owner> owned;
+		for (auto& each : sessions) {
+			recent.push_back(each);
+			owned.push_front(each);
+		}
+		check(recent.find(2) == &sessions[2] && &recent.front() == &sessions[2], "intrusive_list: find returns the object itself");
+		check(&owned.front() == &sessions[3] && owned.size() == 4, "intrusive_list: a second hook keeps its own order");
+
+		recent.erase(sessions[1]);
+		auto copied = sessions[0];
+		check(!sessions[1].nwacc::intrusive_list_hook<by_recency>::is_linked() && sessions[1].nwacc::intrusive_list_hook<by_owner>::is_linked()
+			&& !copied.nwacc::intrusive_list_hook<by_recency>::is_linked() && recent.size() == 3 && recent.find(1) == nullptr,
+			"intrusive_list: erase unlinks from one list only, and a copy starts unlinked");
+	}
+
+	/**
+	 * hashed_list: find moves to the front in constant time, a full list
+	 * evicts its back element, and an insert that throws evicts nothing.
+	 */
+	void check_hashed_list()
+	{
+		std::vector<int> evicted;
+		nwacc::hashed_list<int> cache(3, [&evicted](const int& value) { evicted.push_back(value); });
+		for (auto value = 0; value < 3; value++) {
+			cache.push_back(value);
+		}
+		cache.push_back(1);
+		check(cache.size() == 3, "hashed_list: duplicates are not inserted");
+		cache.find(2);
+		cache.push_front(7);
+		check(contents(cache) == std::vector<int>{ 7, 2, 0 } && evicted == std::vector<int>{ 1 }, "hashed_list: a full list evicts its back element");
+
+		nwacc::hashed_list<fragile, fragile_hash> fragile_cache(2);
+		fragile_cache.push_back(fragile(1));
+		fragile_cache.push_back(fragile(2));
+		fragile::copies_left = 0;
+		auto threw = false;
+		try {
+			const fragile value(3);
+			fragile_cache.push_front(value);
+		}
+		catch (const std::runtime_error&) {
+			threw = true;
+		}
+		fragile::copies_left = -1;
+		check(threw && contents(fragile_cache) == std::vector<int>{ 1, 2 }, "hashed_list: a failed insert evicts nothing");
+	}
+
+	/**
+	 * tiered_list: a cold key found moves to the hot tier and demotes the last
+	 * hot key, and a promotion that throws keeps both.
+	 */
+	void check_tiered_list()
+	{
+		nwacc::tiered_list<int> set(2);
+		for (auto value = 0; value < 5; value++) {
+			set.insert(value);
+		}
+		check(set.hot_size() == 2 && set.cold_size() == 3, "tiered_list: new elements fill the hot tier first");
+		check(set.find(4) && set.hot_size() == 2 && set.size() == 5, "tiered_list: a cold key is promoted");
+		std::vector<int> order;
+		set.for_each([&order](const int& value) { order.push_back(value); });
+		check(order[0] == 4 && order[1] == 0, "tiered_list: the promoted key goes in front and the last hot key is demoted");
+
+		for (auto copies = 0; copies < 2; copies++) {
+			nwacc::tiered_list<fragile, fragile_hash> fragile_set(1);
+			fragile_set.insert(fragile(1));
+			fragile_set.insert(fragile(2));
+			fragile::copies_left = copies;
+			auto threw = false;
+			try {
+				fragile_set.find(fragile(2));
+			}
+			catch (const std::runtime_error&) {
+				threw = true;
+			}
+			fragile::copies_left = -1;
+			check(threw && fragile_set.size() == 2 && fragile_set.contains(fragile(1)) && fragile_set.contains(fragile(2)),
+				"tiered_list: a promotion that throws loses no key");
+		}
+	}
+
+	/**
+	 * self_adjusting_map: find moves a key forward and returns its value, and
+	 * a copy that throws part way destroys the keys it already copied.
+	 */
+	void check_map()
+	{
+		nwacc::self_adjusting_map<int, std::string> map;
+		map.insert(1, "one");
+		map.insert(2, "two");
+		map[3] = "three";
+		auto* found = map.find(3);
+		check(found != nullptr && *found == "three" && map.find(4) == nullptr, "self_adjusting_map: find returns the value");
+		check(!map.insert(1, "uno") && map.erase(2) && map.size() == 2, "self_adjusting_map: insert and erase");
+		auto copy = map;
+		check(copy.find(1) != nullptr && *copy.find(1) == "one" && copy.size() == 2, "self_adjusting_map: copy");
+
+		nwacc::self_adjusting_map<fragile, int> fragile_map;
+		for (auto value = 0; value < 4; value++) {
+			fragile_map.insert(fragile(value), value);
+		}
+		auto live = fragile::live;
+		fragile::copies_left = 2;
+		auto threw = false;
+		try {
+			auto fragile_copy = fragile_map;
+		}
+		catch (const std::runtime_error&) {
+			threw = true;
+		}
+		fragile::copies_left = -1;
+		check(threw && fragile::live == live, "self_adjusting_map: a copy that throws leaks no key");
+	}
+
+	/**
+	 * splay_tree: elements iterate in order, a copy keeps them, and a copy
+	 * that throws part way destroys the nodes it already copied.
+	 */
+	void check_splay_tree()
+	{
+		nwacc::splay_tree<int> tree;
+		for (auto value : { 5, 1, 4, 2, 3 }) {
+			tree.insert(value);
+		}
+		check(tree.find(4) && !tree.find(9) && !tree.insert(4), "splay_tree: find and insert");
+		auto copy = tree;
+		check(contents(copy) == std::vector<int>{ 1, 2, 3, 4, 5 }, "splay_tree: a copy iterates in order");
+		check(tree.erase(1) && contents(tree) == std::vector<int>{ 2, 3, 4, 5 }, "splay_tree: erase");
+
+		nwacc::splay_tree<fragile> fragile_tree;
+		for (auto value = 0; value < 6; value++) {
+			fragile_tree.insert(fragile(value));
+		}
+		auto live = fragile::live;
+		fragile::copies_left = 3;
+		auto threw = false;
+		try {
+			auto fragile_copy = fragile_tree;
+		}
+		catch (const std::runtime_error&) {
+			threw = true;
+		}
+		fragile::copies_left = -1;
+		check(threw && fragile::live == live, "splay_tree: a copy that throws leaks no node");
+	}
+
+	/**
+	 * sharded_list: each key lives in one shard, and clear empties every
+	 * shard whether it holds an array_list or a linked_list.
+	 */
+	template <typename Shard>
+	void check_sharded_list(const char* shard_name)
+	{
+		nwacc::sharded_list<int, Shard> table(4);
+		for (auto value = 0; value < 100; value++) {
+			table.insert(value);
+		}
+		auto visited = 0;
+		table.for_each([&visited](const int&) { visited++; });
+		check(!table.insert(7) && table.size() == 100 && visited == 100, shard_name);
+		check(table.find(42) && table.erase(42) && !table.contains(42) && table.size() == 99, shard_name);
+		table.clear();
+		check(table.empty() && table.insert(42) && table.size() == 1, shard_name);
+	}
+
+	/**
+	 * concurrent_list: find moves a key to the front, and erasing while other
+	 * threads search frees nodes only once those searches are done.
+	 */
+	void check_concurrent_list()
+	{
+		nwacc::concurrent_list<int> list;
+		for (auto value = 0; value < 4; value++) {
+			list.push_back(value);
+		}
+		check(list.find(2) && !list.find(9) && list.contains(3), "concurrent_list: find and contains");
+		std::vector<int> order;
+		list.for_each([&order](const int& value) { order.push_back(value); });
+		check(order == std::vector<int>{ 2, 0, 1, 3 }, "concurrent_list: find moves the key to the front");
+
+		list.clear();
+		for (auto value = 0; value < 1000; value++) {
+			list.push_back(value);
+		}
+		std::vector<std::thread> searchers;
+		for (auto thread = 0; thread < 4; thread++) {
+			searchers.emplace_back([&list, thread]() {
+				for (auto value = thread; value < 1000; value += 4) {
+					list.find(value);
+				}
+			});
+		}
+		for (auto value = 0; value < 1000; value += 2) {
+			list.erase(value);
+		}
+		for (auto& searcher : searchers) {
+			searcher.join();
+		}
+		check(list.size() == 500 && !list.contains(0) && list.contains(1), "concurrent_list: erase under concurrent finds");
+	}
+
+	/**
+	 * Move-to-front transform: chunked encoding gives the ranks of a plain
+	 * table search, and decoding, whole or in parallel blocks, gives back the input.
+	 */
+	void check_mtf_transform()
+	{
+		std::vector<unsigned char> input(20000);
+		unsigned state = 1;
+		for (auto& symbol : input) {
+			state = state * 1103515245 + 12345;
+			// Mostly a few recent symbols, sometimes any byte, so both the vector front and the deep search run.
+			symbol = static_cast<unsigned char>((state >> 16) % 8 == 0 ? state >> 24 : (state >> 16) % 20);
+		}
+
+		std::vector<unsigned char> table(nwacc::k_mtf_alphabet);
+		for (auto symbol = 0; symbol < nwacc::k_mtf_alphabet; symbol++) {
+			table[symbol] = static_cast<unsigned char>(symbol);
+		}
+		std::vector<unsigned char> expected;
+		for (auto symbol : input) {
+			auto found = std::find(table.begin(), table.end(), symbol);
+			expected.push_back(static_cast<unsigned char>(found - table.begin()));
+			std::rotate(table.begin(), found, found + 1);
+		}
+
+		nwacc::mtf_encoder encoder;
+		std::vector<unsigned char> ranks(input.size());
+		for (std::size_t offset = 0, chunk = 1; offset < input.size(); offset += chunk, chunk = chunk * 3 + 1) {
+			chunk = std::min(chunk, input.size() - offset);
+			encoder.encode(input.data() + offset, chunk, ranks.data() + offset);
+		}
+		check(ranks == expected && std::equal(table.begin(), table.end(), encoder.order()), "mtf_encoder: chunks encode like a table search");
+
+		nwacc::mtf_decoder decoder;
+		decoder.decode(ranks.data(), ranks.size(), ranks.data());
+		check(ranks == input, "mtf_decoder: decoding in place gives back the input");
+
+		std::vector<unsigned char> blocks(input.size());
+		nwacc::mtf_encode_blocks(input.data(), input.size(), blocks.data(), 3000, 3);
+		nwacc::mtf_decode_blocks(blocks.data(), blocks.size(), blocks.data(), 3000, 3);
+		check(blocks == input, "mtf_encode_blocks: parallel blocks decode back to the input");
+	}
+
+	/**
+	 * Heterogeneous lookup: a string_view finds a std::string element without
+	 * converting, find_position returns the promoted element and find_if
+	 * matches by predicate.
+	 */
+	template <typename List>
+	void check_heterogeneous_lookup(const char* by_key, const char* by_predicate)
+	{
+		List list;
+		for (const auto* word : { "alpha", "beta", "gamma", "delta" }) {
+			list.push_back(word);
+		}
+		auto found = list.find_position(std::string_view("gamma"));
+		check(found == list.begin() && *found == "gamma" && list.find_position(std::string_view("omega")) == list.end()
+			&& list.find(std::string_view("delta")) && list.contains(std::string_view("beta")), by_key);
+
+		auto matched = list.find_if([](const std::string& word) { return word.size() == 4; });
+		check(matched == list.begin() && *matched == "beta"
+			&& list.find_if([](const std::string& word) { return word.empty(); }) == list.end(), by_predicate);
+	}
+
+	/**
+	 * Parallel scan: split across threads, find still promotes the first
+	 * match and erase removes it, exactly as a serial scan does.
+	 */
+	void check_parallel_scan()
+	{
+		nwacc::scan_pool pool(4);
+		nwacc::array_list<int> parallel;
+		nwacc::array_list<int> serial;
+		for (auto value = 0; value < 200000; value++) {
+			// Every key is in the list twice, at index key and index key + 100000.
+			parallel.push_back(value % 100000);
+			serial.push_back(value % 100000);
+		}
+		parallel.scan_in_parallel(&pool, 0);
+		for (auto key : { 99999, 5, 70000, 123456, 5 }) {
+			check(parallel.find(key) == serial.find(key), "array_list: a parallel find hits what a serial find hits");
+		}
+		check(parallel.erase(40000) && serial.erase(40000) && !parallel.contains(-1), "array_list: a parallel erase");
+		check(contents(parallel) == contents(serial), "array_list: parallel scans promote and erase the first match");
+	}
+
+	/**
+	 * pmr lists: the list and its allocator-aware elements allocate from the
+	 * list's resource, a copy asks for the default resource, move assignment
+	 * between resources keeps the target's, and everything is given back.
+	 */
+	template <typename List>
+	void check_memory_resource(const char* allocates, const char* propagates, const char* releases)
+	{
+		counting_resource resource;
+		counting_resource other_resource;
+		{
+			List list(&resource);
+			for (auto value = 0; value < 20; value++) {
+				list.push_back(std::pmr::string(40, static_cast<char>('a' + value)));
+			}
+			auto same_resource = resource.allocations > 20;
+			for (const auto& value : list) {
+				same_resource = same_resource && value.get_allocator().resource() == &resource;
+			}
+			check(same_resource, allocates);
+
+			List copy(list);
+			List moved(&other_resource);
+			moved = std::move(copy);
+			check(copy.get_allocator().resource() == std::pmr::get_default_resource()
+				&& moved.get_allocator().resource() == &other_resource && (*moved.begin()).get_allocator().resource() == &other_resource
+				&& moved.size() == 20, propagates);
+		}
+		check(resource.outstanding == 0 && other_resource.outstanding == 0, releases);
+	}
+
+	/**
+	 * small_array_list: the first elements and their counters live inside the
+	 * object, storage comes from the resource only past the inline capacity,
+	 * and moving or swapping inline lists moves their elements.
+	 */
+	void check_small_array_list()
+	{
+		counting_resource resource;
+		nwacc::pmr::small_array_list<int, 16, nwacc::frequency_count> small(&resource);
+		for (auto value = 0; value < 16; value++) {
+			small.push_back(value);
+		}
+		small.find(9);
+		const auto* first = reinterpret_cast<const char*>(&*small.begin());
+		auto inside = first >= reinterpret_cast<const char*>(&small) && first < reinterpret_cast<const char*>(&small + 1);
+		check(inside && resource.allocations == 0 && *small.begin() == 9, "small_array_list: no allocation up to the inline capacity");
+		small.push_back(16);
+		check(resource.allocations > 0 && small.size() == 17 && small.find(16), "small_array_list: growing past it allocates");
+
+		nwacc::small_array_list<int, 8> left;
+		nwacc::small_array_list<int, 8> right;
+		left.push_back(1);
+		right.push_back(2);
+		right.push_back(3);
+		std::swap(left, right);
+		auto moved = std::move(left);
+		check(contents(moved) == std::vector<int>{ 2, 3 } && contents(right) == std::vector<int>{ 1 },
+			"small_array_list: swap and move carry inline elements");
+	}
+
+	/**
+	 * Returns a table of 1 to 4 after finding 3, 4 and a missing key, all at compile time.
+	 */
+	template <typename Policy>
+	constexpr nwacc::static_self_adjusting_array<int, 8, Policy> searched_table()
+	{
+		nwacc::static_self_adjusting_array<int, 8, Policy> table{ 1, 2, 3, 4 };
+		table.find(3);
+		table.find(4);
+		table.find(9);
+		return table;
+	}
+
+	constexpr auto k_moved_to_front = searched_table<nwacc::move_to_front>();
+
+	constexpr auto k_transposed = searched_table<nwacc::transpose>();
+
+	static_assert(k_moved_to_front.front() == 4 && *(k_moved_to_front.begin() + 1) == 3 && k_moved_to_front.size() == 4,
+		"static_self_adjusting_array: find moves to the front in a constant expression");
+
+	static_assert(k_transposed.front() == 1 && *(k_transposed.begin() + 1) == 3 && *(k_transposed.begin() + 2) == 4,
+		"static_self_adjusting_array: find transposes in a constant expression");
+
+	/**
+	 * static_self_adjusting_array: a full array refuses more elements, and
+	 * erase keeps the order of the rest.
+	 */
+	void check_static_array()
+	{
+		nwacc::static_self_adjusting_array<int, 4> table{ 1, 2, 3, 4 };
+		auto threw = false;
+		try {
+			table.push_back(5);
+		}
+		catch (const std::length_error&) {
+			threw = true;
+		}
+		check(threw && table.full() && table.size() == 4, "static_self_adjusting_array: a full array throws on push_back");
+		check(table.erase(2) && !table.contains(2) && table.find(4) && contents(table) == std::vector<int>{ 4, 1, 3 },
+			"static_self_adjusting_array: erase and find");
+	}
+
+	/**
+	 * A saved order loads back, counters included, and load keeps what find
+	 * has recorded and the deferred batch size.
+	 */
+	void check_snapshots()
+	{
+		const char* path = "checks_snapshot.bin";
+		nwacc::array_list<int, nwacc::frequency_count, nwacc::access_stats> array;
+		nwacc::linked_list<std::string, nwacc::move_to_front, nwacc::access_stats> list;
+		for (auto value = 0; value < 4; value++) {
+			array.push_back(value);
+			list.push_back(std::to_string(value));
+		}
+		array.find(2);
+		array.find(2);
+		array.find(3);
+		list.find("3");
+		array.save(path);
+
+		nwacc::array_list<int, nwacc::frequency_count, nwacc::access_stats> array_copy;
+		array_copy.load(path);
+		check(contents(array_copy) == contents(array), "array_list: load restores the saved order");
+		// With its count restored, 2 still outranks 3 after one more hit on 3.
+		array_copy.find(3);
+		check(*array_copy.begin() == 2, "array_list: load restores the access counters");
+		array.defer_promotions(4);
+		array.load(path);
+		check(array.statistics().snapshot().lookups == 3, "array_list: load keeps the statistics");
+		array.find(0);
+		check(array.pending_promotions() == 1, "array_list: load keeps the deferred batch size");
+
+		list.save(path);
+		nwacc::linked_list<std::string, nwacc::move_to_front, nwacc::access_stats> list_copy;
+		list_copy.defer_promotions(4);
+		list_copy.find("missing");
+		list_copy.load(path);
+		check(list_copy.size() == 4 && list_copy.front() == "3", "linked_list: load restores the saved order");
+		check(list_copy.statistics().snapshot().lookups == 1, "linked_list: load keeps the statistics");
+		list_copy.find("1");
+		check(list_copy.pending_promotions() == 1, "linked_list: load keeps the deferred batch size");
+
+		// A header that promises more elements than the file holds fails before anything is reserved.
+		{
+			nwacc::snapshot_writer out(path);
+			nwacc::detail::write_snapshot_header<int>(out, INT32_MAX - 2, true);
+			out.finish();
+		}
+		std::string array_error;
+		std::string list_error;
+		nwacc::linked_list<int, nwacc::move_to_front, nwacc::access_stats> numbers{ 1, 2 };
+		try {
+			array.load(path);
+		}
+		catch (const std::runtime_error& error) {
+			array_error = error.what();
+		}
+		try {
+			numbers.load(path);
+		}
+		catch (const std::runtime_error& error) {
+			list_error = error.what();
+		}
+		check(array_error == "Snapshot is truncated" && array.size() == 4, "array_list: load rejects a truncated snapshot");
+		check(list_error == "Snapshot is truncated" && numbers.size() == 2, "linked_list: load rejects a truncated snapshot");
+		std::remove(path);
+	}
+
+	/**
+	 * find_many leaves a list exactly as the same finds one at a time would,
+	 * and takes keys of another type the way find does.
+	 */
+	void check_find_many()
+	{
+		std::vector<int> keys{ 5, 9, 5, 42, 0, 9, 9, 3, 5, 7 };
+		nwacc::linked_list<int, nwacc::transpose> batched;
+		nwacc::linked_list<int, nwacc::transpose> one_by_one;
+		nwacc::linked_list<int, nwacc::move_ahead_k<3>> batched_ahead;
+		nwacc::linked_list<int, nwacc::move_ahead_k<3>> one_by_one_ahead;
+		for (auto value = 0; value < 10; value++) {
+			batched.push_back(value);
+			one_by_one.push_back(value);
+			batched_ahead.push_back(value);
+			one_by_one_ahead.push_back(value);
+		}
+		bool found[10];
+		auto hits = batched.find_many(keys.data(), static_cast<int>(keys.size()), found);
+		batched_ahead.find_many(keys.data(), static_cast<int>(keys.size()));
+		for (auto key : keys) {
+			one_by_one.find(key);
+			one_by_one_ahead.find(key);
+		}
+		check(hits == 9 && !found[3] && found[0], "linked_list: find_many reports hits and misses");
+		check(contents(batched) == contents(one_by_one), "linked_list: find_many under transpose matches find");
+		check(contents(batched_ahead) == contents(one_by_one_ahead), "linked_list: find_many under move_ahead_k matches find");
+
+		nwacc::linked_list<std::string> names{ "ada", "grace", "edsger" };
+		std::string_view wanted[] = { "edsger", "alan" };
+		check(names.find_many(wanted, 2) == 1 && names.front() == "edsger", "linked_list: find_many with string_view keys");
+	}
+
+	/**
+	 * Range construction, splice and merge, including lists on different
+	 * memory resources and a range taken while hits are deferred.
+	 */
+	void check_splice_and_merge()
+	{
+		std::vector<int> values{ 1, 2, 3, 4 };
+		nwacc::linked_list<int> list(values.begin(), values.end());
+		nwacc::linked_list<int> other{ 10, 20 };
+		check(contents(list) == values && list.size() == 4, "linked_list: range construction");
+		list.insert(list.begin(), { 7, 8 });
+		check(contents(list) == std::vector<int>{ 7, 8, 1, 2, 3, 4 }, "linked_list: range insert");
+
+		auto kept = other.begin();
+		list.splice(list.begin(), other);
+		check(other.empty() && list.size() == 8 && *kept == 10 && kept == list.begin(), "linked_list: splice keeps the nodes");
+		auto last = list.end();
+		--last;
+		list.splice(list.begin(), list, last);
+		check(contents(list) == std::vector<int>{ 4, 10, 20, 7, 8, 1, 2, 3 }, "linked_list: splice within a list");
+
+		nwacc::linked_list<int> hot{ 1, 2, 3, 4 };
+		nwacc::linked_list<int> warm{ 10, 20 };
+		hot.merge(warm);
+		check(contents(hot) == std::vector<int>{ 1, 10, 2, 3, 20, 4 } && warm.empty(), "linked_list: merge interleaves by recency");
+
+		// A range taken before deferred hits are applied is the one that moves.
+		nwacc::linked_list<int> source{ 0, 1, 2, 3 };
+		nwacc::linked_list<int> target;
+		source.defer_promotions(8);
+		source.find(3);
+		auto from = source.begin();
+		++from;
+		auto to = from;
+		++to;
+		++to;
+		target.splice(target.end(), source, from, to);
+		check(contents(target) == std::vector<int>{ 1, 2 }, "linked_list: a range splice takes the range the caller saw");
+		check(contents(source) == std::vector<int>{ 3, 0 } && source.size() == 2, "linked_list: a range splice applies the other deferred hits");
+
+		// Nodes never cross memory resources, the elements move instead.
+		std::pmr::monotonic_buffer_resource first_arena;
+		std::pmr::monotonic_buffer_resource second_arena;
+		nwacc::pmr::linked_list<std::pmr::string> left({ "a", "b" }, &first_arena);
+		nwacc::pmr::linked_list<std::pmr::string> right({ "c", "d" }, &second_arena);
+		left.splice(left.end(), right, right.begin(), ++right.begin());
+		left.merge(right);
+		check(left.size() == 4 && right.empty(), "pmr::linked_list: splice and merge across resources");
+		auto on_first_arena = true;
+		for (const auto& value : left) {
+			on_first_arena = on_first_arena && value.get_allocator().resource() == &first_arena;
+		}
+		check(on_first_arena, "pmr::linked_list: spliced elements use the resource of their new list");
+
+		// A long-lived list taking nodes from short-lived ones lets go of their slabs.
+		counting_resource resource;
+		nwacc::pmr::linked_list<int> keeper(&resource);
+		keeper.push_back(0);
+		std::size_t settled = 0;
+		for (auto round = 0; round < 2000; round++) {
+			nwacc::pmr::linked_list<int> donor({ 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14, 15, 16 }, &resource);
+			nwacc::pmr::linked_list<int> courier(&resource);
+			courier.splice(courier.end(), donor, donor.begin());
+			keeper.splice(keeper.end(), courier);
+			// Every other round the node outlives its donor and dies in the next one.
+			if (round % 2 == 0) {
+				while (keeper.size() > 1) {
+					keeper.pop_back();
+				}
+			} // else, keep the node for now, do_nothing();
+			if (round == 100) {
+				settled = resource.outstanding;
+			} // else, keep splicing, do_nothing();
+		}
+		check(keeper.size() == 2 && resource.outstanding <= settled, "linked_list: splicing from short-lived lists keeps memory bounded");
+	}
+
+}
+
+/**
+ * Usage: checks
+ *
+ * Runs each container through its contract once and prints every check that
+ * does not hold. Exits with 1 if any failed.
+ */
+int main()
+{
+	check_linked_list();
+	check_array_search();
+	check_policies<array_of_ints>("array_list: move_to_front", "array_list: transpose",
+		"array_list: move_ahead_k", "array_list: frequency_count");
+	check_policies<list_of_ints>("linked_list: move_to_front", "linked_list: transpose",
+		"linked_list: move_ahead_k", "linked_list: frequency_count");
+	check_array_growth();
+	check_statistics<nwacc::array_list<int, nwacc::move_to_front, nwacc::access_stats>>(
+		"array_list: statistics count each lookup", "array_list: statistics reset");
+	check_statistics<nwacc::linked_list<int, nwacc::move_to_front, nwacc::access_stats>>(
+		"linked_list: statistics count each lookup", "linked_list: statistics reset");
+	check_deferred_promotions();
+	check_find_many();
+	check_hashed_list();
+	check_unrolled_list();
+	check_intrusive_list();
+	check_tiered_list();
+	check_map();
+	check_splay_tree();
+	check_concurrent_list();
+	check_sharded_list<nwacc::array_list<int>>("sharded_list<array_list>: insert, find, erase and clear");
+	check_sharded_list<nwacc::linked_list<int>>("sharded_list<linked_list>: insert, find, erase and clear");
+	check_snapshots();
+	check_mtf_transform();
+	check_heterogeneous_lookup<nwacc::array_list<std::string>>(
+		"array_list: find_position by string_view", "array_list: find_if");
+	check_heterogeneous_lookup<nwacc::linked_list<std::string>>(
+		"linked_list: find_position by string_view", "linked_list: find_if");
+	check_parallel_scan();
+	check_memory_resource<nwacc::pmr::array_list<std::pmr::string>>("pmr::array_list: elements use the list's resource",
+		"pmr::array_list: copy and move assignment follow the allocator traits", "pmr::array_list: every allocation is given back");
+	check_memory_resource<nwacc::pmr::linked_list<std::pmr::string>>("pmr::linked_list: elements use the list's resource",
+		"pmr::linked_list: copy and move assignment follow the allocator traits", "pmr::linked_list: every allocation is given back");
+	check_small_array_list();
+	check_static_array();
+	check_splice_and_merge();
+
+	if (failures > 0) {
+		std::cerr << failures << " checks failed" << std::endl;
+		return 1;
+	} // else, every check held, do_nothing();
+
+	std::cout << "All checks passed" << std::endl;
+	return 0;
+}
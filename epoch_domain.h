@@ -0,0 +1,126 @@
+#ifndef EPOCH_DOMAIN_H
+#define EPOCH_DOMAIN_H
+
+#include <atomic>
+#include <cstdint>
+#include <thread>
+
+namespace nwacc {
+
+	/**
+	 * Epoch based read-side protection for lock-free traversal.
+	 *
+	 * Readers wrap each traversal in a guard. A writer that has unlinked nodes
+	 * calls synchronize(), which advances the epoch and waits until every reader
+	 * that might still see the unlinked nodes has left; after that the nodes can
+	 * be freed. Readers only touch a counter on their own cache line (threads are
+	 * spread over k_stripes stripes), so they do not contend with each other.
+	 */
+	class epoch_domain {
+	public:
+
+		/**
+		 * Marks the calling thread as reading for as long as it lives.
+		 */
+		class guard {
+		public:
+			explicit guard(epoch_domain& domain) : counter{ domain.enter() }
+			{ }
+
+			guard(const guard&) = delete;
+
+			guard& operator=(const guard&) = delete;
+
+			~guard()
+			{
+				this->counter->fetch_sub(1, std::memory_order_release);
+			}
+
+		private:
+			std::atomic<std::int64_t>* counter;
+		};
+
+		epoch_domain() : epoch{ 0 }
+		{
+			for (auto& parity : this->readers) {
+				for (auto& stripe : parity) {
+					stripe.count.store(0, std::memory_order_relaxed);
+				}
+			}
+		}
+
+		epoch_domain(const epoch_domain&) = delete;
+
+		epoch_domain& operator=(const epoch_domain&) = delete;
+
+		/**
+		 * Waits until every reader that entered before this call has left.
+		 * Must not be called from inside a guard, and only one writer may call it at a time.
+		 */
+		void synchronize()
+		{
+			auto old_epoch = this->epoch.load(std::memory_order_relaxed);
+			this->epoch.store(old_epoch + 1, std::memory_order_seq_cst);
+			auto& parity = this->readers[old_epoch & 1];
+			for (auto& stripe : parity) {
+				while (stripe.count.load(std::memory_order_seq_cst) != 0) {
+					std::this_thread::yield();
+				}
+			}
+		}
+
+	private:
+		/**
+		 * The number of reader counter stripes per epoch parity.
+		 */
+		static const int k_stripes = 16;
+
+		/**
+		 * One reader counter on its own cache line.
+		 */
+		struct alignas(64) stripe_counter {
+
+			std::atomic<std::int64_t> count;
+		};
+
+		/**
+		 * The current epoch. Readers register under its parity.
+		 */
+		std::atomic<std::uint64_t> epoch;
+
+		/**
+		 * Active reader counts, by epoch parity and stripe.
+		 */
+		stripe_counter readers[2][k_stripes];
+
+		/**
+		 * Registers a reader under the current epoch and returns the counter it incremented.
+		 */
+		std::atomic<std::int64_t>* enter()
+		{
+			auto stripe = stripe_index();
+			while (true) {
+				auto current = this->epoch.load(std::memory_order_seq_cst);
+				auto* counter = &this->readers[current & 1][stripe].count;
+				counter->fetch_add(1, std::memory_order_seq_cst);
+				if (this->epoch.load(std::memory_order_seq_cst) == current) {
+					return counter;
+				} // else, a writer advanced the epoch while we registered, try again.
+				counter->fetch_sub(1, std::memory_order_release);
+			}
+		}
+
+		/**
+		 * Returns the stripe of the calling thread.
+		 */
+		static int stripe_index()
+		{
+			static std::atomic<int> next_thread{ 0 };
+			thread_local int stripe = next_thread.fetch_add(1, std::memory_order_relaxed) % k_stripes;
+			return stripe;
+		}
+	};
+
+}
+
+#endif
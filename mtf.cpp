@@ -0,0 +1,159 @@
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "mtf_transform.h"
+
+namespace {
+
+	/**
+	 * The 8 bytes an encoded file starts with, followed by the block size as a 64-bit integer.
+	 */
+	const char k_magic[8] = { 'N', 'W', 'A', 'C', 'C', 'M', 'T', '1' };
+
+	/**
+	 * How many bytes are read and transformed at a time when the input is one continuous stream.
+	 */
+	const std::size_t k_stream_chunk = 1 << 20;
+
+	/**
+	 * The largest block size accepted, on the command line or in an encoded file.
+	 */
+	const std::uint64_t k_max_block_size = std::uint64_t(1) << 30;
+
+	/**
+	 * A chunk of several blocks is cut down to this many bytes, but always holds at least one block.
+	 */
+	const std::uint64_t k_max_chunk = std::uint64_t(1) << 28;
+
+	/**
+	 * Reads up to size bytes and returns how many were read.
+	 */
+	std::size_t read_chunk(std::ifstream& in, unsigned char* buffer, std::size_t size)
+	{
+		in.read(reinterpret_cast<char*>(buffer), static_cast<std::streamsize>(size));
+		return static_cast<std::size_t>(in.gcount());
+	}
+
+	void write_chunk(std::ofstream& out, const unsigned char* buffer, std::size_t size)
+	{
+		out.write(reinterpret_cast<const char*>(buffer), static_cast<std::streamsize>(size));
+		if (!out) {
+			throw std::runtime_error("Cannot write output");
+		} // else, the chunk was written, do_nothing();
+	}
+
+}
+
+/**
+ * Usage: mtf encode|decode input output [block_size=0] [threads=hardware]
+ *
+ * Applies the move-to-front transform to a file over the 256 byte alphabet.
+ * With block_size 0 the whole file is one stream, transformed in 1 MiB chunks
+ * by a single thread. Otherwise the file is cut into independent blocks of
+ * block_size bytes, each starting from a fresh table, which are transformed
+ * in parallel, at most 256 MiB of them at a time. The block size may be at
+ * most 1 GiB. The encoded file records the block size, so decode takes it
+ * from there. Throughput of the transform itself, without I/O, goes to stderr.
+ */
+int main(int argc, char* argv[])
+{
+	if (argc < 4 || (std::strcmp(argv[1], "encode") != 0 && std::strcmp(argv[1], "decode") != 0)) {
+		std::cerr << "usage: " << argv[0] << " encode|decode input output [block_size=0] [threads]" << std::endl;
+		return 2;
+	} // else, the arguments are usable, do_nothing();
+
+	auto encoding = std::strcmp(argv[1], "encode") == 0;
+	std::uint64_t block_size = argc > 4 ? std::strtoull(argv[4], nullptr, 10) : 0;
+	auto threads = argc > 5 ? std::atoi(argv[5]) : static_cast<int>(std::thread::hardware_concurrency());
+	threads = std::max(1, threads);
+
+	try {
+		std::ifstream in(argv[2], std::ios::binary);
+		if (!in) {
+			throw std::runtime_error(std::string("Cannot open input: ") + argv[2]);
+		} // else, the input is open, do_nothing();
+		std::ofstream out(argv[3], std::ios::binary | std::ios::trunc);
+		if (!out) {
+			throw std::runtime_error(std::string("Cannot open output: ") + argv[3]);
+		} // else, the output is open, do_nothing();
+
+		if (encoding) {
+			out.write(k_magic, sizeof(k_magic));
+			out.write(reinterpret_cast<const char*>(&block_size), sizeof(block_size));
+		}
+		else {
+			char magic[sizeof(k_magic)];
+			in.read(magic, sizeof(magic));
+			in.read(reinterpret_cast<char*>(&block_size), sizeof(block_size));
+			if (!in || std::memcmp(magic, k_magic, sizeof(magic)) != 0) {
+				throw std::runtime_error("Input was not written by mtf encode");
+			} // else, we know the block size, do_nothing();
+		}
+
+		if (block_size > k_max_block_size) {
+			throw std::runtime_error(encoding ? "Block size must be at most 1 GiB" : "Input records a block size over 1 GiB");
+		} // else, a chunk of whole blocks cannot overflow, do_nothing();
+
+		// Whole blocks per chunk, enough to keep every thread busy and to read at least a stream chunk,
+		// unless that would hold more than k_max_chunk bytes.
+		auto chunk = k_stream_chunk;
+		if (block_size > 0) {
+			auto blocks = std::max<std::uint64_t>(threads, (k_stream_chunk + block_size - 1) / block_size);
+			blocks = std::max<std::uint64_t>(1, std::min(blocks, k_max_chunk / block_size));
+			chunk = static_cast<std::size_t>(blocks * block_size);
+		} // else, one stream, do_nothing();
+		if (chunk == 0) {
+			throw std::runtime_error("No room to read the input into");
+		} // else, every read makes progress, do_nothing();
+
+		std::vector<unsigned char> buffer(chunk);
+		nwacc::mtf_encoder encoder;
+		nwacc::mtf_decoder decoder;
+		std::uint64_t total = 0;
+		std::chrono::steady_clock::duration busy{ };
+
+		for (auto size = read_chunk(in, buffer.data(), chunk); size > 0; size = read_chunk(in, buffer.data(), chunk)) {
+			auto start = std::chrono::steady_clock::now();
+			if (block_size == 0 && encoding) {
+				encoder.encode(buffer.data(), size, buffer.data());
+			}
+			else if (block_size == 0) {
+				decoder.decode(buffer.data(), size, buffer.data());
+			}
+			else if (encoding) {
+				nwacc::mtf_encode_blocks(buffer.data(), size, buffer.data(), block_size, threads);
+			}
+			else {
+				nwacc::mtf_decode_blocks(buffer.data(), size, buffer.data(), block_size, threads);
+			}
+			busy += std::chrono::steady_clock::now() - start;
+
+			write_chunk(out, buffer.data(), size);
+			total += size;
+		}
+		out.flush();
+		if (!out) {
+			throw std::runtime_error("Cannot write output");
+		} // else, everything reached the file, do_nothing();
+
+		auto seconds = std::chrono::duration<double>(busy).count();
+		std::cerr << (encoding ? "encoded " : "decoded ") << total << " bytes in " << seconds << " s ("
+			<< (seconds > 0 ? total / seconds / 1e6 : 0.0) << " MB/s, block size " << block_size
+			<< ", " << (block_size == 0 ? 1 : threads) << " thread(s))" << std::endl;
+	}
+	catch (const std::exception& error) {
+		std::cerr << error.what() << std::endl;
+		return 1;
+	}
+
+	return 0;
+}
@@ -0,0 +1,357 @@
+#ifndef MTF_TRANSFORM_H
+#define MTF_TRANSFORM_H
+
+#include <algorithm>
+#include <cstddef>
+#include <thread>
+#include <vector>
+
+#include "array_kernels.h"
+
+#if defined(__SSSE3__) || defined(__AVX__)
+#include <tmmintrin.h>
+#define NWACC_HAS_SSSE3 1
+#endif
+
+namespace nwacc {
+
+	/**
+	 * The number of symbols the move-to-front transform works over: every byte value.
+	 */
+	const int k_mtf_alphabet = 256;
+
+namespace detail {
+
+#if defined(NWACC_HAS_SSE2)
+	/**
+	 * Returns a row with symbol in lane 0 followed by lanes 0 .. 14 of row.
+	 */
+	inline __m128i mtf_push_front(__m128i row, __m128i symbols)
+	{
+		return _mm_or_si128(_mm_slli_si128(row, 1), _mm_and_si128(symbols, _mm_cvtsi32_si128(0xff)));
+	}
+
+	/**
+	 * Returns a mask of the lanes at or before lane, for lane in 0 .. 15.
+	 */
+	inline __m128i mtf_lanes_through(int lane)
+	{
+		return _mm_cmpgt_epi8(_mm_set1_epi8(static_cast<char>(lane)),
+			_mm_setr_epi8(-1, 0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14));
+	}
+
+	/**
+	 * Returns the index of a symbol that is not in the front row. The rows
+	 * are compared one aligned 16 byte load at a time, the same width that
+	 * mtf_promote_deep stores them with, so each load is forwarded from a
+	 * recent store rather than stalling on a partial overlap.
+	 */
+	inline int mtf_find_deep(const unsigned char* table, __m128i symbols)
+	{
+		for (auto offset = 16; ; offset += 16) {																// Always found, every byte is in the table.
+			auto mask = static_cast<unsigned>(_mm_movemask_epi8(
+				_mm_cmpeq_epi8(_mm_load_si128(reinterpret_cast<const __m128i*>(table + offset)), symbols)));
+			if (mask != 0) {
+				return offset + lowest_set_bit(mask);
+			} // else, the symbol is in a later row, do_nothing();
+		}
+	}
+
+	/**
+	 * Moves a symbol that was not in the front row to the front of the table.
+	 * Every row from table[16] down to the symbol's row shifts back one lane,
+	 * each taking the last byte of the row before it in its first lane, so
+	 * the symbol's slot is overwritten and lane 15 of row drops into table[16].
+	 * The returned front row holds the symbol first.
+	 */
+	inline __m128i mtf_promote_deep(unsigned char* table, __m128i row, __m128i symbols, int rank)
+	{
+		auto carry = _mm_srli_si128(row, 15);
+		for (auto offset = 16; offset <= rank; offset += 16) {
+			auto* address = reinterpret_cast<__m128i*>(table + offset);
+			auto current = _mm_load_si128(address);
+			auto through = mtf_lanes_through(std::min(rank - offset, 15));
+			auto moved = _mm_or_si128(_mm_slli_si128(current, 1), carry);
+			_mm_store_si128(address, _mm_or_si128(_mm_andnot_si128(through, current), _mm_and_si128(through, moved)));
+			carry = _mm_srli_si128(current, 15);
+		}
+		return mtf_push_front(row, symbols);
+	}
+#endif
+
+	/**
+	 * Move-to-front encodes size bytes against a 256 byte table.
+	 *
+	 * The first 16 entries of the table stay in a register for the whole
+	 * run, so the common small ranks are found and rotated without touching
+	 * memory: the symbol is compared against every lane at once, the match
+	 * is spread to all earlier lanes with a prefix-or, and the row is blended
+	 * with itself shifted up one lane. Deeper symbols are found and moved a
+	 * row at a time by mtf_find_deep and mtf_promote_deep. Without SSE2 the
+	 * whole table is searched with find_index and rotated with move_forward.
+	 *
+	 * @param table the 16 byte aligned table, updated in place.
+	 */
+	inline void mtf_encode_run(unsigned char* table, const unsigned char* input, std::size_t size, unsigned char* output)
+	{
+#if defined(NWACC_HAS_SSE2)
+		auto row = _mm_load_si128(reinterpret_cast<const __m128i*>(table));
+		for (std::size_t index = 0; index < size; index++) {
+			auto symbols = _mm_set1_epi8(static_cast<char>(input[index]));
+			auto match = _mm_cmpeq_epi8(row, symbols);
+			auto mask = static_cast<unsigned>(_mm_movemask_epi8(match));
+			if (mask == 1) {
+				output[index] = 0;																// A repeat, the row stays as it is.
+			}
+			else if (mask != 0) {
+				auto through = _mm_or_si128(match, _mm_srli_si128(match, 1));					// Lanes at or before the match.
+				through = _mm_or_si128(through, _mm_srli_si128(through, 2));
+				through = _mm_or_si128(through, _mm_srli_si128(through, 4));
+				through = _mm_or_si128(through, _mm_srli_si128(through, 8));
+				row = _mm_or_si128(_mm_andnot_si128(through, row), _mm_and_si128(through, mtf_push_front(row, symbols)));
+				output[index] = static_cast<unsigned char>(lowest_set_bit(mask));
+			}
+			else {
+				auto rank = mtf_find_deep(table, symbols);
+				row = mtf_promote_deep(table, row, symbols, rank);
+				output[index] = static_cast<unsigned char>(rank);
+			}
+		}
+		_mm_store_si128(reinterpret_cast<__m128i*>(table), row);
+#else
+		for (std::size_t index = 0; index < size; index++) {
+			auto rank = find_index(table, 256, input[index]);									// Always found, every byte is in the table.
+			output[index] = static_cast<unsigned char>(rank);
+			move_forward(table, rank, 0);
+		}
+#endif
+	}
+
+	/**
+	 * Move-to-front decodes size ranks against a 256 byte table, the inverse
+	 * of mtf_encode_run. With SSSE3 the front row stays in a register too,
+	 * and a small rank picks its symbol out of it with one byte shuffle.
+	 *
+	 * @param table the 16 byte aligned table, updated in place.
+	 */
+	inline void mtf_decode_run(unsigned char* table, const unsigned char* input, std::size_t size, unsigned char* output)
+	{
+#if defined(NWACC_HAS_SSSE3)
+		auto row = _mm_load_si128(reinterpret_cast<const __m128i*>(table));
+		for (std::size_t index = 0; index < size; index++) {
+			int rank = input[index];
+			if (rank < 16) {
+				auto ranks = _mm_set1_epi8(static_cast<char>(rank));
+				auto symbols = _mm_shuffle_epi8(row, ranks);
+				auto through = mtf_lanes_through(rank);
+				row = _mm_or_si128(_mm_andnot_si128(through, row), _mm_and_si128(through, mtf_push_front(row, symbols)));
+				output[index] = static_cast<unsigned char>(_mm_cvtsi128_si32(symbols));
+			}
+			else {
+				auto symbol = table[rank];
+				row = mtf_promote_deep(table, row, _mm_set1_epi8(static_cast<char>(symbol)), rank);
+				output[index] = symbol;
+			}
+		}
+		_mm_store_si128(reinterpret_cast<__m128i*>(table), row);
+#else
+		for (std::size_t index = 0; index < size; index++) {
+			int rank = input[index];
+			output[index] = table[rank];
+			move_forward(table, rank, 0);
+		}
+#endif
+	}
+
+	/**
+	 * Splits size bytes into blocks of block_size (the last may be shorter),
+	 * hands each thread a contiguous run of whole blocks and calls
+	 * transform(offset, length) once per block. Returns when every block is done.
+	 */
+	template <typename Transform>
+	void for_each_mtf_block(std::size_t size, std::size_t block_size, int threads, Transform transform)
+	{
+		if (block_size == 0 || block_size > size) {
+			block_size = std::max<std::size_t>(size, 1);
+		} // else, the block size fits the input, do_nothing();
+
+		auto blocks = (size + block_size - 1) / block_size;
+		auto workers = static_cast<std::size_t>(std::max(1, threads));
+		workers = std::min(workers, std::max<std::size_t>(blocks, 1));
+
+		auto run = [&](std::size_t worker) {
+			auto first = blocks * worker / workers;
+			auto last = blocks * (worker + 1) / workers;
+			for (auto block = first; block < last; block++) {
+				auto offset = block * block_size;
+				transform(offset, std::min(block_size, size - offset));
+			}
+		};
+
+		std::vector<std::thread> pool;
+		for (std::size_t worker = 1; worker < workers; worker++) {
+			pool.emplace_back(run, worker);
+		}
+		run(0);
+		for (auto& thread : pool) {
+			thread.join();
+		}
+	}
+
+}
+
+	/**
+	 * Streaming move-to-front encoder over bytes.
+	 *
+	 * Each input byte is replaced by its current index in a table of all 256
+	 * byte values, and then moved to the front of that table, which is
+	 * exactly what array_list<unsigned char>::find does to its elements. The
+	 * front of the table is searched and rotated in a vector register, the
+	 * rest with the find_index and move_forward kernels of array_kernels.h
+	 * (see detail::mtf_encode_run).
+	 *
+	 * The table carries over between calls to encode, so a stream can be fed
+	 * in chunks of any size and gives the same output as one call over all of it.
+	 */
+	class mtf_encoder {
+	public:
+
+		/**
+		 * Constructs an encoder whose table holds the bytes in ascending order.
+		 */
+		mtf_encoder()
+		{
+			this->reset();
+		}
+
+		/**
+		 * Puts the table back in ascending order, to start a new stream.
+		 */
+		void reset()
+		{
+			for (auto symbol = 0; symbol < k_mtf_alphabet; symbol++) {
+				this->table[symbol] = static_cast<unsigned char>(symbol);
+			}
+		}
+
+		/**
+		 * Encodes the next size bytes of the stream.
+		 *
+		 * @param input the bytes to encode.
+		 * @param size the number of bytes in input.
+		 * @param output receives size ranks; it may be the same buffer as input.
+		 */
+		void encode(const unsigned char* input, std::size_t size, unsigned char* output)
+		{
+			detail::mtf_encode_run(this->table, input, size, output);
+		}
+
+		/**
+		 * Returns the table, most recently seen byte first.
+		 */
+		const unsigned char* order() const
+		{
+			return this->table;
+		}
+
+	private:
+		/**
+		 * Every byte value, most recently seen first.
+		 */
+		alignas(64) unsigned char table[k_mtf_alphabet];
+	};
+
+	/**
+	 * Streaming move-to-front decoder, the inverse of mtf_encoder.
+	 * Like the encoder it keeps its table between calls to decode.
+	 */
+	class mtf_decoder {
+	public:
+
+		/**
+		 * Constructs a decoder whose table holds the bytes in ascending order.
+		 */
+		mtf_decoder()
+		{
+			this->reset();
+		}
+
+		/**
+		 * Puts the table back in ascending order, to start a new stream.
+		 */
+		void reset()
+		{
+			for (auto symbol = 0; symbol < k_mtf_alphabet; symbol++) {
+				this->table[symbol] = static_cast<unsigned char>(symbol);
+			}
+		}
+
+		/**
+		 * Decodes the next size ranks of the stream.
+		 *
+		 * @param input the ranks to decode.
+		 * @param size the number of ranks in input.
+		 * @param output receives size bytes; it may be the same buffer as input.
+		 */
+		void decode(const unsigned char* input, std::size_t size, unsigned char* output)
+		{
+			detail::mtf_decode_run(this->table, input, size, output);
+		}
+
+		/**
+		 * Returns the table, most recently seen byte first.
+		 */
+		const unsigned char* order() const
+		{
+			return this->table;
+		}
+
+	private:
+		/**
+		 * Every byte value, most recently seen first.
+		 */
+		alignas(64) unsigned char table[k_mtf_alphabet];
+	};
+
+	/**
+	 * Encodes input as independent blocks of block_size bytes, each starting
+	 * from a fresh table, spread over threads. The blocks must be decoded
+	 * with mtf_decode_blocks and the same block_size. A block_size of 0
+	 * encodes everything as one block, the same as a single mtf_encoder.
+	 *
+	 * @param input the bytes to encode.
+	 * @param size the number of bytes in input.
+	 * @param output receives size ranks; it may be the same buffer as input.
+	 * @param block_size the number of bytes per block.
+	 * @param threads the most threads to use, including the calling one.
+	 */
+	inline void mtf_encode_blocks(const unsigned char* input, std::size_t size, unsigned char* output,
+		std::size_t block_size, int threads)
+	{
+		detail::for_each_mtf_block(size, block_size, threads, [input, output](std::size_t offset, std::size_t length) {
+			mtf_encoder encoder;
+			encoder.encode(input + offset, length, output + offset);
+		});
+	}
+
+	/**
+	 * Decodes the output of mtf_encode_blocks.
+	 *
+	 * @param input the ranks to decode.
+	 * @param size the number of ranks in input.
+	 * @param output receives size bytes; it may be the same buffer as input.
+	 * @param block_size the block size the input was encoded with.
+	 * @param threads the most threads to use, including the calling one.
+	 */
+	inline void mtf_decode_blocks(const unsigned char* input, std::size_t size, unsigned char* output,
+		std::size_t block_size, int threads)
+	{
+		detail::for_each_mtf_block(size, block_size, threads, [input, output](std::size_t offset, std::size_t length) {
+			mtf_decoder decoder;
+			decoder.decode(input + offset, length, output + offset);
+		});
+	}
+
+}
+
+#endif
@@ -0,0 +1,513 @@
+#ifndef NODE_POOL_H
+#define NODE_POOL_H
+
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <functional>
+#include <map>
+#include <memory>
+#include <new>
+#include <utility>
+#include <vector>
+
+#include "allocator_support.h"
+
+namespace nwacc {
+
+	/**
+	 * A slab allocator for the fixed-size nodes of a single container.
+	 *
+	 * Nodes are carved out of slabs that double in size as the container grows.
+	 * Destroyed nodes go on a free list and are handed out again before any new
+	 * slab is requested, so a container that churns through inserts and erases
+	 * stops calling the global allocator once it reaches its working size.
+	 * Slabs are returned when the pool itself is destroyed, or, once another
+	 * pool has been told to share them, when the pool is gone and no node
+	 * carved from them is still alive.
+	 *
+	 * Slabs, and the list of them, come from Allocator, and nodes are built
+	 * with std::allocator_traits<Allocator>::construct, so a node that
+	 * declares an allocator_type gets the pool's allocator handed to its
+	 * constructor by std::pmr::polymorphic_allocator.
+	 *
+	 * @param Node the node type handed out by this pool.
+	 * @param Allocator the allocator the slabs come from.
+	 */
+	template <typename Node, typename Allocator = std::allocator<Node>>
+	class node_pool {
+	public:
+
+		/**
+		 * Constructs an empty pool. No memory is allocated until the first node is created.
+		 *
+		 * @param allocator the allocator the slabs will come from.
+		 */
+		explicit node_pool(const Allocator& allocator = Allocator()) :
+			borrowed{ borrowed_allocator(allocator) }, borrowed_slabs{ slab_index_allocator(allocator) }, free_list{ nullptr },
+			next_slot{ nullptr }, slab_end{ nullptr }, next_slab_size{ k_first_slab_size }, free_count{ 0 }, allocator{ allocator }
+		{ }
+
+		node_pool(const node_pool&) = delete;
+
+		node_pool& operator=(const node_pool&) = delete;
+
+		/**
+		 * Takes every slab from rhs, leaving rhs empty but usable.
+		 *
+		 * @param rhs the pool to take from.
+		 */
+		node_pool(node_pool&& rhs) noexcept :
+			own{ std::move(rhs.own) }, borrowed{ std::move(rhs.borrowed) }, borrowed_slabs{ std::move(rhs.borrowed_slabs) },
+			free_list{ rhs.free_list }, next_slot{ rhs.next_slot }, slab_end{ rhs.slab_end },
+			next_slab_size{ rhs.next_slab_size }, free_count{ rhs.free_count }, allocator{ rhs.allocator }
+		{
+			rhs.borrowed.clear();
+			rhs.borrowed_slabs.clear();
+			rhs.free_list = nullptr;
+			rhs.next_slot = nullptr;
+			rhs.slab_end = nullptr;
+			rhs.next_slab_size = k_first_slab_size;
+			rhs.free_count = 0;
+		}
+
+		/**
+		 * Exchanges the slabs of this pool with those of rhs.
+		 *
+		 * @param rhs the pool to exchange with.
+		 */
+		node_pool& operator=(node_pool&& rhs) noexcept
+		{
+			this->swap(rhs);
+			return *this;
+		}
+
+		/**
+		 * Frees every slab no other pool still needs. Any node this pool holds
+		 * must already have been destroyed.
+		 */
+		~node_pool()
+		{
+			if (this->own == nullptr) {
+				return;
+			} // else, other pools may still hold nodes carved here, do_nothing();
+
+			// Every node this pool carved that is not dead here is alive in some
+			// other pool; from now on the arena counts only those.
+			std::int64_t carved = 0;
+			for (const auto& block : this->own->slabs) {
+				carved += block.count;
+			}
+			carved -= (this->slab_end - this->next_slot) + this->free_count;
+			this->own->outstanding.fetch_add(carved - k_owned, std::memory_order_acq_rel);
+		}
+
+		/**
+		 * Returns the allocator the slabs come from.
+		 */
+		Allocator get_allocator() const
+		{
+			return this->allocator;
+		}
+
+		/**
+		 * Constructs a node in pooled storage.
+		 *
+		 * @param args the arguments forwarded to the node constructor.
+		 * @return a pointer to the new node.
+		 */
+		template <typename... Args>
+		Node* create(Args&&... args)
+		{
+			auto* storage = this->acquire();
+			try {
+				auto* created = reinterpret_cast<Node*>(storage);
+				std::allocator_traits<Allocator>::construct(this->allocator, created, std::forward<Args>(args)...);
+				return created;
+			}
+			catch (...) {
+				this->release(storage);
+				throw;
+			}
+		}
+
+		/**
+		 * Destroys a node and keeps its storage for the next create. A node
+		 * carved by another pool goes back to that pool's arena instead, and
+		 * once the last node of an arena whose pool is gone dies, this pool
+		 * lets go of the arena.
+		 *
+		 * @param node the node to destroy, it must have come from this pool or one it shares.
+		 */
+		void destroy(Node* node)
+		{
+			std::allocator_traits<Allocator>::destroy(this->allocator, node);
+			auto* storage = reinterpret_cast<slot*>(node);
+			auto* arena = this->borrowed.empty() ? nullptr : this->arena_of(storage);
+			if (arena == nullptr) {
+				this->release(storage);
+				return;
+			} // else, the node was carved by another pool, do_nothing();
+
+			if (arena->give_back(storage)) {
+				this->forget(arena);
+			} // else, the arena still has live nodes or a pool, do_nothing();
+		}
+
+		/**
+		 * Exchanges the slabs of this pool with those of rhs. The allocators go
+		 * with their slabs, unless they cannot be swapped, in which case they
+		 * must compare equal.
+		 *
+		 * @param rhs the pool to exchange with.
+		 */
+		void swap(node_pool& rhs) noexcept
+		{
+			detail::swap_allocators(this->allocator, rhs.allocator);
+			this->own.swap(rhs.own);
+			this->borrowed.swap(rhs.borrowed);
+			this->borrowed_slabs.swap(rhs.borrowed_slabs);
+			std::swap(this->free_list, rhs.free_list);
+			std::swap(this->next_slot, rhs.next_slot);
+			std::swap(this->slab_end, rhs.slab_end);
+			std::swap(this->next_slab_size, rhs.next_slab_size);
+			std::swap(this->free_count, rhs.free_count);
+		}
+
+		/**
+		 * Makes room for count more nodes with at most one allocation, so a
+		 * container adding many nodes at once does not allocate per node.
+		 *
+		 * @param count the number of nodes about to be created.
+		 */
+		void reserve(int count)
+		{
+			auto available = this->free_count + static_cast<int>(this->slab_end - this->next_slot);
+			if (count <= available) {
+				return;
+			} // else, a new slab is needed, do_nothing();
+
+			// The rest of the newest slab goes on the free list so it is not lost.
+			while (this->next_slot != this->slab_end) {
+				this->release(this->next_slot++);
+			}
+			this->add_slab(std::max(count - available, this->next_slab_size));
+		}
+
+		/**
+		 * Keeps the slabs rhs uses allocated while nodes carved from them are
+		 * alive, so that this pool can destroy nodes that rhs created. A
+		 * container calls this before taking nodes from another one.
+		 *
+		 * This pool lets go of another pool's arena once that pool is gone and
+		 * no node carved from the arena is alive: when it destroys the last such
+		 * node itself, or at its next share if some other pool did. It thus
+		 * holds the arenas of live pools it took nodes from, and of dead ones
+		 * only while their nodes are alive, so a long-lived list that keeps
+		 * taking nodes from short-lived ones does not grow. share costs O(a)
+		 * to look for such arenas, plus O(log s) per slab this pool has not
+		 * indexed yet, where a is the number of arenas and s the number of
+		 * slabs this pool holds; it never costs a step per node. destroy finds
+		 * the arena of a node in O(log s), and in constant time while this
+		 * pool holds no other arena.
+		 *
+		 * @param rhs the pool whose nodes this pool will own from now on.
+		 */
+		void share(const node_pool& rhs)
+		{
+			for (auto current = this->borrowed.begin(); current != this->borrowed.end();) {
+				auto* arena = (current++)->first;
+				if (arena->outstanding.load(std::memory_order_acquire) == 0) {
+					this->forget(arena);
+				} // else, nodes of the arena may still reach this pool, do_nothing();
+			}
+
+			if (rhs.own != nullptr && rhs.own != this->own) {
+				// rhs is not in use while it hands over its nodes, so its slabs can be read.
+				auto& entry = this->adopt(rhs.own);
+				for (; entry.indexed_slabs < rhs.own->slabs.size(); entry.indexed_slabs++) {
+					const auto& block = rhs.own->slabs[entry.indexed_slabs];
+					this->borrowed_slabs.emplace(block.slots, slab_extent{ block.slots + block.count, rhs.own.get() });
+				}
+			} // else, rhs has carved nothing, or this pool carved it all, do_nothing();
+
+			// The pools that own the other arenas of rhs may be in use, so their
+			// slabs are taken from the index of rhs instead.
+			for (const auto& borrowed_entry : rhs.borrowed) {
+				const auto& arena = borrowed_entry.second.arena;
+				if (arena != this->own && arena->outstanding.load(std::memory_order_acquire) != 0) {
+					this->adopt(arena);
+				} // else, no node of the arena can reach this pool, do_nothing();
+			}
+			for (const auto& indexed : rhs.borrowed_slabs) {
+				if (this->borrowed.count(indexed.second.second) != 0) {
+					this->borrowed_slabs.insert(indexed);
+				} // else, the arena was not adopted, do_nothing();
+			}
+		}
+
+	private:
+		/**
+		 * Storage for one node, reused as a free list link while the node is dead.
+		 */
+		union slot {
+
+			slot* next_free;
+
+			alignas(Node) unsigned char storage[sizeof(Node)];
+		};
+
+		/**
+		 * One block of slots, with its size to free it by.
+		 */
+		struct slab {
+
+			slot* slots;
+
+			int count;
+		};
+
+		typedef detail::rebind_allocator<Allocator, slot> slot_allocator;
+
+		typedef detail::rebind_allocator<Allocator, slab> slab_list_allocator;
+
+		/**
+		 * Added to outstanding while the pool that carves from an arena exists.
+		 */
+		static constexpr std::int64_t k_owned = INT64_MAX / 2;
+
+		/**
+		 * The slabs one pool has carved, freed when the last pool that owns
+		 * or shares them lets go.
+		 *
+		 * Only the owning pool carves from the slabs and reads its free list.
+		 * Other pools, which may run on other threads, hand dead nodes back
+		 * through returned, which the owner drains once its own free list is
+		 * empty.
+		 */
+		struct slab_arena {
+
+			explicit slab_arena(const Allocator& allocator) :
+				slabs{ slab_list_allocator(allocator) }, returned{ nullptr }, outstanding{ k_owned }, allocator{ allocator }
+			{ }
+
+			slab_arena(const slab_arena&) = delete;
+
+			slab_arena& operator=(const slab_arena&) = delete;
+
+			~slab_arena()
+			{
+				slot_allocator slab_allocator(this->allocator);
+				for (const auto& block : this->slabs) {
+					std::allocator_traits<slot_allocator>::deallocate(slab_allocator, block.slots, block.count);
+				}
+			}
+
+			/**
+			 * Hands a dead node back from another pool.
+			 *
+			 * @return true if it was the last live node and the owner is gone.
+			 */
+			bool give_back(slot* storage)
+			{
+				auto* head = this->returned.load(std::memory_order_relaxed);
+				do {
+					storage->next_free = head;
+				} while (!this->returned.compare_exchange_weak(head, storage, std::memory_order_release, std::memory_order_relaxed));
+				return this->outstanding.fetch_sub(1, std::memory_order_acq_rel) == 1;
+			}
+
+			std::vector<slab, slab_list_allocator> slabs;
+
+			/**
+			 * Nodes other pools destroyed, not yet taken back by the owner.
+			 */
+			std::atomic<slot*> returned;
+
+			/**
+			 * The number of nodes carved here that are alive outside the owner,
+			 * less those on returned, plus k_owned while the owner exists. Zero
+			 * means no pool can need the slabs any more.
+			 */
+			std::atomic<std::int64_t> outstanding;
+
+			Allocator allocator;
+		};
+
+		/**
+		 * An arena of another pool, and how many of its slabs this pool has
+		 * indexed from that pool directly.
+		 */
+		struct borrowed_arena {
+
+			std::shared_ptr<slab_arena> arena;
+
+			std::size_t indexed_slabs;
+		};
+
+		typedef detail::rebind_allocator<Allocator, slab_arena> arena_allocator;
+
+		typedef detail::rebind_allocator<Allocator, std::pair<slab_arena* const, borrowed_arena>> borrowed_allocator;
+
+		/**
+		 * One past the last slot of a borrowed slab, and the arena it belongs to.
+		 */
+		typedef std::pair<const slot*, slab_arena*> slab_extent;
+
+		typedef detail::rebind_allocator<Allocator, std::pair<const slot* const, slab_extent>> slab_index_allocator;
+
+		/**
+		 * The number of nodes in the first slab.
+		 */
+		static const int k_first_slab_size = 16;
+
+		/**
+		 * Slabs stop doubling once they hold this many nodes.
+		 */
+		static const int k_max_slab_size = 4096;
+
+		/**
+		 * Every slab allocated by this pool, created with the first one.
+		 */
+		std::shared_ptr<slab_arena> own;
+
+		/**
+		 * The arenas of other pools that this pool may hold nodes from.
+		 */
+		std::map<slab_arena*, borrowed_arena, std::less<slab_arena*>, borrowed_allocator> borrowed;
+
+		/**
+		 * The slabs of the borrowed arenas by first slot, to find the arena a node came from.
+		 */
+		std::map<const slot*, slab_extent, std::less<const slot*>, slab_index_allocator> borrowed_slabs;
+
+		/**
+		 * The most recently destroyed node, or nullptr.
+		 */
+		slot* free_list;
+
+		/**
+		 * The next never-used slot in the newest slab.
+		 */
+		slot* next_slot;
+
+		/**
+		 * One past the last slot in the newest slab.
+		 */
+		slot* slab_end;
+
+		/**
+		 * The number of nodes the next slab will hold.
+		 */
+		int next_slab_size;
+
+		/**
+		 * The number of slots on the free list.
+		 */
+		int free_count;
+
+		Allocator allocator;
+
+		slot* acquire()
+		{
+			if (this->free_list == nullptr && this->own != nullptr
+				&& this->own->returned.load(std::memory_order_relaxed) != nullptr) {
+				this->take_back();
+			} // else, there is a free slot already, or none to take back, do_nothing();
+
+			if (this->free_list != nullptr) {
+				auto* storage = this->free_list;
+				this->free_list = storage->next_free;
+				this->free_count--;
+				return storage;
+			} // else, nothing has been recycled, carve a fresh slot, do_nothing();
+
+			if (this->next_slot == this->slab_end) {
+				this->add_slab(this->next_slab_size);
+				if (this->next_slab_size < k_max_slab_size) {
+					this->next_slab_size *= 2;
+				} // else, the slab size has reached its cap, do_nothing();
+			} // else, the newest slab still has room, do_nothing();
+
+			return this->next_slot++;
+		}
+
+		void release(slot* storage)
+		{
+			storage->next_free = this->free_list;
+			this->free_list = storage;
+			this->free_count++;
+		}
+
+		/**
+		 * Moves the nodes other pools handed back onto the empty free list.
+		 */
+		void take_back()
+		{
+			this->free_list = this->own->returned.exchange(nullptr, std::memory_order_acquire);
+			for (auto* current = this->free_list; current != nullptr; current = current->next_free) {
+				this->free_count++;
+			}
+			this->own->outstanding.fetch_add(this->free_count, std::memory_order_relaxed);
+		}
+
+		/**
+		 * Allocates a slab of count slots and carves from it next.
+		 */
+		void add_slab(int count)
+		{
+			if (this->own == nullptr) {
+				this->own = std::allocate_shared<slab_arena>(arena_allocator(this->allocator), this->allocator);
+			} // else, this pool already has its arena, do_nothing();
+
+			// Make room for the bookkeeping first so a failed push_back cannot leak the slab.
+			this->own->slabs.reserve(this->own->slabs.size() + 1);
+			slot_allocator slab_allocator(this->allocator);
+			auto* slots = std::allocator_traits<slot_allocator>::allocate(slab_allocator, count);
+			this->own->slabs.push_back(slab{ slots, count });
+			this->next_slot = slots;
+			this->slab_end = slots + count;
+		}
+
+		/**
+		 * Holds on to arena, unless this pool already does.
+		 *
+		 * @return the entry of arena.
+		 */
+		borrowed_arena& adopt(const std::shared_ptr<slab_arena>& arena)
+		{
+			return this->borrowed.emplace(arena.get(), borrowed_arena{ arena, 0 }).first->second;
+		}
+
+		/**
+		 * Returns the borrowed arena storage was carved from, or nullptr if it
+		 * is this pool's own.
+		 */
+		slab_arena* arena_of(const slot* storage) const
+		{
+			auto after = this->borrowed_slabs.upper_bound(storage);
+			if (after != this->borrowed_slabs.begin()) {
+				--after;
+				if (storage < after->second.first) {
+					return after->second.second;
+				} // else, storage lies past the end of that slab, do_nothing();
+			} // else, storage lies before every borrowed slab, do_nothing();
+			return nullptr;
+		}
+
+		/**
+		 * Lets go of a borrowed arena no pool needs any more, and drops its slabs from the index.
+		 */
+		void forget(slab_arena* arena)
+		{
+			// The arena's pool is gone, so its slabs no longer change.
+			for (const auto& block : arena->slabs) {
+				this->borrowed_slabs.erase(block.slots);
+			}
+			this->borrowed.erase(arena);
+		}
+	};
+
+}
+
+#endif
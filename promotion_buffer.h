@@ -0,0 +1,204 @@
+#ifndef PROMOTION_BUFFER_H
+#define PROMOTION_BUFFER_H
+
+#include <algorithm>
+#include <functional>
+#include <vector>
+
+namespace nwacc {
+
+	/**
+	 * Records the hits of a container's find while promotions are deferred.
+	 *
+	 * With a batch size of 0 (the default) nothing is recorded and the container
+	 * promotes on every find. Otherwise find only records where it found the key,
+	 * and the container applies the recorded promotions all at once when the
+	 * buffer fills up or when asked to flush.
+	 *
+	 * Every buffer is sized for one batch when deferring starts, so recording
+	 * and taking a batch never allocate.
+	 *
+	 * @param Position how the container identifies an element, e.g. an index or a node pointer.
+	 */
+	template <typename Position>
+	class promotion_buffer {
+	public:
+
+		/**
+		 * One distinct element that was found, with the number of times it was found.
+		 */
+		struct entry {
+
+			Position position;
+
+			int hits;
+
+			/**
+			 * When it was last found, counting hits in the batch from 0.
+			 */
+			int last;
+		};
+
+		promotion_buffer() : my_batch_size{ 0 }
+		{ }
+
+		/**
+		 * Returns whether promotions are being deferred.
+		 */
+		bool deferring() const
+		{
+			return this->my_batch_size > 0;
+		}
+
+		/**
+		 * Returns the number of hits per batch, 0 when not deferring.
+		 */
+		int batch_size() const
+		{
+			return this->my_batch_size;
+		}
+
+		/**
+		 * Returns the number of recorded hits, duplicates included.
+		 */
+		int size() const
+		{
+			return static_cast<int>(this->recorded.size());
+		}
+
+		bool empty() const
+		{
+			return this->recorded.empty();
+		}
+
+		/**
+		 * Sets how many hits are recorded before they are applied, 0 to stop deferring.
+		 * Any hits already recorded must be applied by the caller first.
+		 *
+		 * @param batch_size the number of hits per batch.
+		 */
+		void set_batch_size(int batch_size)
+		{
+			this->my_batch_size = std::max(0, batch_size);
+			this->recorded.reserve(this->my_batch_size);
+			this->distinct.reserve(this->my_batch_size);
+			this->by_position.reserve(this->my_batch_size);
+		}
+
+		/**
+		 * Records a hit.
+		 *
+		 * @param position where the key was found.
+		 * @return true when the buffer is full and should be applied.
+		 */
+		bool record(const Position& position)
+		{
+			this->recorded.push_back(position);
+			return this->size() >= this->my_batch_size;
+		}
+
+		/**
+		 * Coalesces the recorded hits into distinct entries, most recently found
+		 * first, and empties the buffer. The hits are sorted by position, so
+		 * the repeats of each element lie together, and then the distinct
+		 * elements are sorted by their last hit: O(b log b) for b hits.
+		 *
+		 * @return the distinct elements found, newest first, valid until the next take.
+		 */
+		std::vector<entry>& take()
+		{
+			this->distinct.clear();
+			for (auto order = 0; order < this->size(); order++) {
+				this->distinct.push_back(entry{ this->recorded[order], 1, order });
+			}
+			std::sort(this->distinct.begin(), this->distinct.end(), [](const entry& lhs, const entry& rhs) {
+				return std::less<Position>()(lhs.position, rhs.position)
+					|| (!std::less<Position>()(rhs.position, lhs.position) && lhs.last < rhs.last);
+			});
+
+			// Compact each run of equal positions into one entry stamped with its last hit.
+			this->by_position.clear();
+			auto kept = this->distinct.begin();
+			for (auto first = this->distinct.begin(); first != this->distinct.end();) {
+				auto last = first + 1;
+				while (last != this->distinct.end() && !std::less<Position>()(first->position, last->position)) {
+					++last;
+				}
+				*kept++ = entry{ first->position, static_cast<int>(last - first), (last - 1)->last };
+				this->by_position.push_back(first->position);
+				first = last;
+			}
+			this->distinct.erase(kept, this->distinct.end());
+			std::sort(this->distinct.begin(), this->distinct.end(),
+				[](const entry& lhs, const entry& rhs) { return lhs.last > rhs.last; });
+			this->recorded.clear();
+			return this->distinct;
+		}
+
+		/**
+		 * Returns the positions of the entries of the last take, in ascending order.
+		 */
+		const std::vector<Position>& taken_by_position() const
+		{
+			return this->by_position;
+		}
+
+		/**
+		 * Drops every recorded hit without applying it.
+		 */
+		void clear()
+		{
+			this->recorded.clear();
+		}
+
+		void swap(promotion_buffer& rhs)
+		{
+			std::swap(this->my_batch_size, rhs.my_batch_size);
+			std::swap(this->recorded, rhs.recorded);
+			std::swap(this->distinct, rhs.distinct);
+			std::swap(this->by_position, rhs.by_position);
+		}
+
+		promotion_buffer(const promotion_buffer& rhs) : my_batch_size{ 0 }
+		{
+			this->set_batch_size(rhs.my_batch_size);
+			this->recorded = rhs.recorded;
+		}
+
+		promotion_buffer(promotion_buffer&&) = default;
+
+		promotion_buffer& operator=(const promotion_buffer& rhs)
+		{
+			promotion_buffer copy(rhs);
+			this->swap(copy);
+			return *this;
+		}
+
+		promotion_buffer& operator=(promotion_buffer&&) = default;
+
+	private:
+		/**
+		 * The number of hits per batch, 0 when not deferring.
+		 */
+		int my_batch_size;
+
+		/**
+		 * The recorded hits, oldest first.
+		 */
+		std::vector<Position> recorded;
+
+		/**
+		 * The entries of the last take, newest first. Kept between batches, as
+		 * is by_position, so it is allocated only once.
+		 */
+		std::vector<entry> distinct;
+
+		/**
+		 * The positions of the last take, ascending.
+		 */
+		std::vector<Position> by_position;
+	};
+
+}
+
+#endif
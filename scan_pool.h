@@ -0,0 +1,221 @@
+#ifndef SCAN_POOL_H
+#define SCAN_POOL_H
+
+#include <algorithm>
+#include <atomic>
+#include <climits>
+#include <condition_variable>
+#include <exception>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace nwacc {
+
+	/**
+	 * A persistent pool of threads that splits a linear search across cores.
+	 *
+	 * find_first cuts the range [0, size) into chunks and hands them out in
+	 * ascending order to the pool's workers and to the calling thread, which
+	 * joins in. Whenever a chunk contains a match, the lowest matching index
+	 * seen so far is lowered, and nobody starts a chunk beyond it; chunks
+	 * below it were handed out earlier and still finish. The result is
+	 * therefore exactly the first match, the one a serial scan would find.
+	 *
+	 * The threads are started once and sleep between searches, so a search
+	 * costs one wake-up instead of creating threads. One pool can serve any
+	 * number of containers; searches from different threads take turns.
+	 */
+	class scan_pool {
+	public:
+
+		/**
+		 * Starts the pool.
+		 *
+		 * @param threads the number of threads that scan, the calling thread included;
+		 *        by default one per hardware thread.
+		 */
+		explicit scan_pool(int threads = static_cast<int>(std::thread::hardware_concurrency())) :
+			generation{ 0 }, busy{ 0 }, stopping{ false }, run{ nullptr }, context{ nullptr }, size{ 0 }, chunk{ 1 }
+		{
+			for (auto worker = 1; worker < std::max(1, threads); worker++) {
+				this->workers.emplace_back([this]() { this->serve(); });
+			}
+		}
+
+		scan_pool(const scan_pool&) = delete;
+
+		scan_pool& operator=(const scan_pool&) = delete;
+
+		/**
+		 * Stops and joins every worker.
+		 */
+		~scan_pool()
+		{
+			{
+				std::lock_guard<std::mutex> lock(this->guard);
+				this->stopping = true;
+			}
+			this->wake.notify_all();
+			for (auto& worker : this->workers) {
+				worker.join();
+			}
+		}
+
+		/**
+		 * Returns the number of threads that scan, the calling thread included.
+		 */
+		int threads() const
+		{
+			return static_cast<int>(this->workers.size()) + 1;
+		}
+
+		/**
+		 * Returns the lowest index in [0, size) at which search finds a match, or -1.
+		 *
+		 * search(from, to) is called concurrently on disjoint chunks and returns
+		 * the index of the first match in [from, to), or -1. It must only read
+		 * shared state. An exception thrown by search stops the other threads
+		 * and is rethrown here.
+		 *
+		 * @param size the number of elements to search.
+		 * @param chunk_size the number of elements a thread scans before checking for an earlier match.
+		 * @param search finds the first match in one chunk.
+		 */
+		template <typename Search>
+		int find_first(int size, int chunk_size, const Search& search)
+		{
+			std::lock_guard<std::mutex> one_at_a_time(this->calls);
+			{
+				std::lock_guard<std::mutex> lock(this->guard);
+				this->run = [](const void* context, int from, int to) {
+					return (*static_cast<const Search*>(context))(from, to);
+				};
+				this->context = &search;
+				this->size = size;
+				this->chunk = std::max(1, chunk_size);
+				this->next_chunk.store(0, std::memory_order_relaxed);
+				this->lowest.store(INT_MAX, std::memory_order_relaxed);
+				this->failure = nullptr;
+				this->busy = static_cast<int>(this->workers.size());
+				this->generation++;
+			}
+			this->wake.notify_all();
+			this->scan();
+
+			std::unique_lock<std::mutex> lock(this->guard);
+			this->done.wait(lock, [this]() { return this->busy == 0; });
+			if (this->failure != nullptr) {
+				std::rethrow_exception(this->failure);
+			} // else, every chunk was searched cleanly, do_nothing();
+			auto found = this->lowest.load(std::memory_order_relaxed);
+			return found == INT_MAX ? -1 : found;
+		}
+
+	private:
+		/**
+		 * Serializes calls to find_first.
+		 */
+		std::mutex calls;
+		/**
+		 * Guards the job description and the fields below it.
+		 */
+		std::mutex guard;
+		/**
+		 * Wakes the workers when a search starts or the pool stops.
+		 */
+		std::condition_variable wake;
+		/**
+		 * Wakes the caller when the last worker is done.
+		 */
+		std::condition_variable done;
+		/**
+		 * Counts searches, so a worker can tell a new one from a spurious wake-up.
+		 */
+		unsigned long long generation;
+		/**
+		 * The number of workers still scanning the current search.
+		 */
+		int busy;
+		bool stopping;
+		/**
+		 * The first exception thrown by the current search.
+		 */
+		std::exception_ptr failure;
+		/**
+		 * Calls the search passed to find_first, through its address in context.
+		 */
+		int (*run)(const void* context, int from, int to);
+		const void* context;
+		int size;
+		int chunk;
+		/**
+		 * The next chunk to hand out.
+		 */
+		std::atomic<int> next_chunk{ 0 };
+		/**
+		 * The lowest match found so far, INT_MAX while there is none and -1 once a search failed.
+		 */
+		std::atomic<int> lowest{ INT_MAX };
+		std::vector<std::thread> workers;
+
+		/**
+		 * The loop each worker runs until the pool stops.
+		 */
+		void serve()
+		{
+			auto seen = 0ULL;
+			for (;;) {
+				{
+					std::unique_lock<std::mutex> lock(this->guard);
+					this->wake.wait(lock, [this, seen]() { return this->stopping || this->generation != seen; });
+					if (this->stopping) {
+						return;
+					} // else, there is a new search, do_nothing();
+					seen = this->generation;
+				}
+				this->scan();
+				std::lock_guard<std::mutex> lock(this->guard);
+				if (--this->busy == 0) {
+					this->done.notify_one();
+				} // else, other workers are still scanning, do_nothing();
+			}
+		}
+
+		/**
+		 * Takes chunks in ascending order until they run out or lie beyond the lowest match.
+		 */
+		void scan()
+		{
+			for (;;) {
+				auto from = static_cast<long long>(this->next_chunk.fetch_add(1, std::memory_order_relaxed)) * this->chunk;
+				if (from >= this->size || from >= this->lowest.load(std::memory_order_relaxed)) {
+					return;
+				} // else, this chunk could still hold the first match, do_nothing();
+
+				auto to = static_cast<int>(std::min<long long>(this->size, from + this->chunk));
+				int found;
+				try {
+					found = this->run(this->context, static_cast<int>(from), to);
+				}
+				catch (...) {
+					std::lock_guard<std::mutex> lock(this->guard);
+					if (this->failure == nullptr) {
+						this->failure = std::current_exception();
+					} // else, only the first failure is kept, do_nothing();
+					this->lowest.store(-1, std::memory_order_relaxed);
+					return;
+				}
+				if (found >= 0) {
+					auto current = this->lowest.load(std::memory_order_relaxed);
+					while (found < current && !this->lowest.compare_exchange_weak(current, found, std::memory_order_relaxed)) {
+					}
+					return;																		// Every chunk left is beyond found.
+				} // else, no match in this chunk, do_nothing();
+			}
+		}
+	};
+
+}
+
+#endif
@@ -1,348 +1,1097 @@
-#ifndef SELF_ADJUSTING_ARRAY_H
-#define SELF_ADJUSTING_ARRAY_H
-
-#include <algorithm>
-#include <iostream>
-#include <stdexcept>
-
-namespace nwacc {
-
-	/**
-	 * Resizable-array implementation of a list.
-	 *
-	 * This class provides methods to manipulate the size of the array
-	 * that is used internally to store the list.
-	 *
-	 * (This class is roughly equivalent to vector.)
-	 *
-	 * @author Shane Carroll May
-	 * @sub-author Gunnar Atchley
-	 */
-	template <typename T>
-	class array_list {
-
-	public:
-
-		/**
-		 * Constructs an empty list with the specified initial capacity.
-		 *
-		 * @param initial_capacity the initial capacity of the list.
-		 */
-		explicit array_list(int initial_capacity = 0) :
-			my_size{ 0 }, my_capacity{ initial_capacity + k_spare_capacity }
-		{
-			this->data = new T[this->my_capacity];
-		}
-
-		/**
-		 * Constructs an array_list from the given list.
-		 * This instance will contain a copy of each of the elements in rhs, in the same order.
-		 *
-		 * @param rhs the list to copy.
-		 */
-		array_list(const array_list& rhs) :
-			my_size{ rhs.my_size }, my_capacity{ rhs.my_capacity },
-			data{ nullptr }
-		{
-			// We are making a copy of one array to another.
-			this->data = new T[this->my_capacity];
-			for (auto index = 0; index < this->my_size; index++) {
-				this->data[index] = rhs.data[index];
-			}
-		}
-
-		/**
-		 * Assigns to this instance the given list.
-		 * This will replace its current contents, and modify its size accordingly.
-		 *
-		 * @param rhs the list to assign to this list.
-		 */
-		array_list& operator=(const array_list& rhs)
-		{
-			auto copy = rhs;
-			std::swap(*this, copy);
-			return *this;
-		}
-
-		/**
-		 * Destroys this instance and frees any allocated resources.
-		 */
-		~array_list()
-		{
-			delete[] this->data;
-		}
-
-		/**
-		 * Constructs an array_list from the given list.
-		 * This instance will contain a copy of each of the elements in rhs, in the same order.
-		 *
-		 * @param rhs the list to copy.
-		 */
-		array_list(array_list&& rhs) :
-			my_size{ rhs.my_size }, my_capacity{ rhs.my_capacity },
-			data{ rhs.data }
-		{
-			// We have taken everything from rhs. We want
-			// to leave rhs in a valid state.
-			rhs.data = nullptr;
-			rhs.my_capacity = 0;
-			rhs.my_size = 0;
-		}
-
-		/**
-		 * Assigns to this instance the given list.
-		 * This will replace its current contents, and modify its size accordingly.
-		 *
-		 * @param rhs the list to assign to this list.
-		 */
-		array_list& operator=(array_list&& rhs)
-		{
-			std::swap(this->my_size, rhs.my_size);
-			std::swap(this->my_capacity, rhs.my_capacity);
-			std::swap(this->data, rhs.data);
-			return *this;
-		}
-
-		/**
-		 * Returns whether if this instance is empty.
-		 *
-		 * @return true if this instance is empty, otherwise, false.
-		 */
-		bool empty() const
-		{
-			return this->size() == 0;
-		}
-
-		/**
-		 * Returns the number of elements in this instance.
-		 *
-		 * @return the current number of elements in this list.
-		 */
-		int size() const
-		{
-			return this->my_size;
-		}
-
-		/**
-		 * Returns the size of the storage space currently allocated for this instance.
-		 *
-		 * @return the size of the currently allocated storage capacity in this instance.
-		 */
-		int capacity() const
-		{
-			return this->my_capacity;
-		}
-
-		/**
-		 * Returns a reference to the element at position index in the list.
-		 *
-		 * @param index the index at which to get the value.
-		 */
-		T& operator[](int index)
-		{
-			if (index < 0 || index >= this->size()) {
-				throw std::out_of_range("Index out of range");
-			} // else, index is valid, do_nothing();
-
-			return this->data[index];
-		}
-
-		/**
-		 * Returns a constant reference to the element at position index in the list.
-		 *
-		 * @param index the index at which to get the value.
-		 */
-		const T& operator[](int index) const
-		{
-			if (index < 0 || index >= this->size()) {
-				throw std::out_of_range("Index out of range");
-			} // else, index is valid, do_nothing();
-
-			return this->data[index];
-		}
-
-		/**
-		 * Resizes this instance so that it contains new_size elements.
-		 *
-		 * @param new_size the new size of this list.
-		 */
-		void resize(int new_size)
-		{
-			// Here all we need to check is new size is not less than the capacity.
-			if (new_size > this->my_capacity) {
-				reserve((new_size * 3) / 2);
-			} // else, the capacity is fine, we set the size effectively "deleting" elements in the list, do_nothing();
-
-			this->my_size = new_size;
-		}
-
-		/**
-		 * Requests that the list capacity be at least enough to contain new_capacity elements.
-		 *
-		 * @param new_capacity the new list capacity.
-		 */
-		void reserve(int new_capacity)
-		{
-			// if the new capacity is less than size, we have nothing to do. 
-			if (new_capacity < this->my_size) {
-				return;
-			} // else, we need to reserve more memory, do_nothing();
-
-			// Allocate more memory for the array. 
-			T* new_data = new T[new_capacity];
-			// Copy each element from the old array into the new array. 
-			for (auto index = 0; index < this->my_size; index++) {
-				new_data[index] = std::move(this->data[index]);
-			}
-			// Change my capacity to the new amount. 
-			this->my_capacity = new_capacity;
-			// We do this so I do not have to delete data. 
-			std::swap(this->data, new_data);
-			// After I copy it, I need to delete the newly allocated memory. 
-			delete[] new_data;
-		}
-
-		/**
-		 * Adds a new element at the end of the list, after its current last element.
-		 *
-		 * @param value the value to add to the list.
-		 */
-		void push_back(const T& value)
-		{
-			if (this->my_size == this->my_capacity) {
-				// This means I have ran out of room
-				// I need a bigger array.
-				this->reserve((this->capacity() * 3) / 2);
-			} // else, the size is fine, do_nothing();
-			this->data[this->my_size++] = value;
-		}
-
-		/**
-		 * Adds a new element at the end of the list, after its current last element.
-		 * This new element is constructed in place.
-		 *
-		 * @param value the value to add to the list.
-		 */
-
-		void emplace_back(T&& value)
-		{
-			if (this->my_size == this->my_capacity) {
-				this->reserve((this->capacity() * 3) / 2);
-			} // else, the size is find, do_nothing();
-			// Notice here, we can move the rvalue not copy it like in push_back
-			this->data[this->my_size++] = std::move(value);
-		}
-
-		/**
-		 * Removes the last element in the list, this reduces the size of the list by one.
-		 */
-		void pop_back()
-		{
-			if (this->empty()) {
-				throw std::out_of_range("List is empty");
-			} // else, we have elements so remove the last one. 
-			--this->my_size;
-		}
-
-		/**
-		 * Returns constant a reference to the last element in the list.
-		 *
-		 * @return a constant last element in the list.
-		 */
-		const T& back() const
-		{
-			if (this->empty()) {
-				throw std::out_of_range("List is empty");
-			} // else, we have values, do_nothing();
-
-			return this->data[this->my_size - 1];
-		}
-
-		typedef T* iterator;
-		typedef const T* const_iterator;
-
-		/**
-		 * Returns an iterator pointing to the first element in the list.
-		 *
-		 * @return an iterator to the beginning of the list.
-		 */
-		iterator begin()
-		{
-			return &this->data[0];
-		}
-
-		/**
-		 * Returns a constant iterator pointing to the first element in the list.
-		 *
-		 * @return a constant iterator to the first element in the list.
-		 */
-		const_iterator begin() const
-		{
-			return &this->data[0];
-		}
-
-		/**
-		 * Returns an iterator referring to the past-the-end element in the list.
-		 *
-		 * @return an iterator to the element past the end of the list.
-		 */
-		iterator end()
-		{
-			return &this->data[this->size()];
-		}
-
-		/**
-		 * Returns a constant iterator pointing to the past-the-end element in the list.
-		 *
-		 * @return a constant iterator to the element past the end of the list.
-		 */
-		const_iterator end() const
-		{
-			return &this->data[this->size()];
-		}
-
-		/**
-		 * A modifier to ensure we do not have a zero (0) capacity in the list.
-		 */
-		static const int k_spare_capacity = 2;
-
-		/**
-		 * Searches array_list for key then moves to front.
-		 *
-		 * @param key is the value you are searching for.
-		 */
-		const bool find(const T& key)
-		{
-			for (auto index = 0; index < my_size; index++) {							// O(n) due to search n times.
-				if (key == data[index]) {
-					auto new_start = key;
-					auto next_value_temp = key;
-					for (auto counter = 0; counter <= index; counter++) {				// O(n) counting through n times.
-						next_value_temp = data[counter];								
-						data[counter] = new_start;										
-						new_start = next_value_temp;
-					}
-					return true;
-				} // else, data is not the wanted value. do_nothing();					// Overal run-time of O(n)
-			}
-			return false;
-		}
-
-	private:
-		/**
-		 * The current number of elements in the list.
-		 */
-		int my_size;
-		/**
-		 * The current capacity of the list.
-		 */
-		int my_capacity;
-		/**
-		 * A pointer to the backing array.
-		 */
-		T* data;
-	};
-
-}
-
-#endif
+#ifndef SELF_ADJUSTING_ARRAY_H
+#define SELF_ADJUSTING_ARRAY_H
+
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <iostream>
+#include <memory>
+#include <memory_resource>
+#include <new>
+#include <stdexcept>
+#include <string>
+#include <type_traits>
+#include <vector>
+
+#include "access_stats.h"
+#include "adjustment_policy.h"
+#include "allocator_support.h"
+#include "array_kernels.h"
+#include "promotion_buffer.h"
+#include "scan_pool.h"
+#include "snapshot.h"
+
+namespace nwacc {
+
+	/**
+	 * Resizable-array implementation of a list.
+	 *
+	 * This class provides methods to manipulate the size of the array
+	 * that is used internally to store the list.
+	 *
+	 * (This class is roughly equivalent to vector.)
+	 *
+	 * Like vector, only the first size() slots hold constructed elements; the
+	 * rest of the capacity is raw storage, so reserving does not construct
+	 * anything and growing relocates trivially copyable elements with memcpy.
+	 *
+	 * The elements and their access counters come from Allocator, which may
+	 * be std::pmr::polymorphic_allocator (see nwacc::pmr::array_list) to put
+	 * a list on a memory resource, e.g. a monotonic buffer on the stack.
+	 * Copies, moves and assignments follow the allocator's propagation
+	 * traits the way the standard containers do.
+	 *
+	 * With an InlineCapacity (see small_array_list) the first InlineCapacity
+	 * elements, and their counters, are kept inside the object itself, right
+	 * after the header, and the allocator is only used once they overflow.
+	 * Moving such a list moves its elements instead of stealing a pointer.
+	 *
+	 * @param T the element type.
+	 * @param Policy how find reorganizes the list (see adjustment_policy.h).
+	 * @param Stats what find records about itself, nothing by default (see access_stats.h).
+	 * @param Allocator the allocator for the elements.
+	 * @param InlineCapacity the number of elements kept inline, none by default.
+	 *
+	 * @author Shane Carroll May
+	 * @sub-author Gunnar Atchley
+	 */
+	template <typename T, typename Policy = move_to_front, typename Stats = no_stats, typename Allocator = std::allocator<T>, int InlineCapacity = 0>
+	class array_list {
+
+		static_assert(std::is_same<typename std::allocator_traits<Allocator>::value_type, T>::value,
+			"array_list requires an allocator whose value_type is T");
+
+		static_assert(InlineCapacity >= 0, "array_list cannot keep a negative number of elements inline");
+
+		// Inline elements are moved whenever the list is, which must not fail halfway.
+		static_assert(InlineCapacity == 0 || std::is_nothrow_move_constructible<T>::value,
+			"array_list can only keep elements inline when T is nothrow move constructible");
+
+	public:
+
+		typedef Allocator allocator_type;
+
+		/**
+		 * Constructs an empty list with the specified initial capacity.
+		 *
+		 * @param initial_capacity the initial capacity of the list.
+		 * @param allocator the allocator the elements will come from.
+		 */
+		explicit array_list(int initial_capacity = 0, const Allocator& allocator = Allocator()) :
+			my_size{ 0 }, my_capacity{ initial_capacity + k_spare_capacity }, allocator{ allocator }
+		{
+			this->data = this->acquire_storage(this->my_capacity);
+			try {
+				this->counts.allocate(this->my_capacity, counter_allocator(this->allocator));
+			}
+			catch (...) {
+				// No destructor runs for a constructor that throws.
+				this->release_storage(this->data, this->my_capacity);
+				throw;
+			}
+		}
+
+		/**
+		 * Constructs an empty list whose elements come from allocator.
+		 *
+		 * @param allocator the allocator the elements will come from.
+		 */
+		explicit array_list(const Allocator& allocator) : array_list(0, allocator)
+		{ }
+
+		/**
+		 * Constructs an array_list from the given list.
+		 * This instance will contain a copy of each of the elements in rhs, in the same order.
+		 *
+		 * @param rhs the list to copy.
+		 */
+		array_list(const array_list& rhs) :
+			array_list(rhs, allocator_traits::select_on_container_copy_construction(rhs.allocator))
+		{ }
+
+		/**
+		 * Constructs a copy of rhs whose elements come from allocator.
+		 *
+		 * @param rhs the list to copy.
+		 * @param allocator the allocator the elements will come from.
+		 */
+		array_list(const array_list& rhs, const Allocator& allocator) :
+			my_size{ 0 }, my_capacity{ 0 }, data{ nullptr }, pending{ rhs.pending }, stats{ rhs.stats },
+			scanner{ rhs.scanner }, my_scan_threshold{ rhs.my_scan_threshold }, allocator{ allocator }
+		{
+			// We are making a copy of one array to another.
+			this->take_copy(rhs.data, rhs);
+		}
+
+		/**
+		 * Assigns to this instance the given list.
+		 * This will replace its current contents, and modify its size accordingly.
+		 * The allocator is replaced too when it propagates on copy assignment.
+		 *
+		 * @param rhs the list to assign to this list.
+		 */
+		array_list& operator=(const array_list& rhs)
+		{
+			if (this == &rhs) {
+				return *this;
+			} // else, there is something to copy, do_nothing();
+
+			array_list copy(rhs, allocator_traits::propagate_on_container_copy_assignment::value ? rhs.allocator : this->allocator);
+			this->exchange(copy);
+			return *this;
+		}
+
+		/**
+		 * Destroys this instance and frees any allocated resources.
+		 */
+		~array_list()
+		{
+			if (this->data != nullptr) {
+				std::destroy(this->data, this->data + this->my_size);
+				this->release_storage(this->data, this->my_capacity);
+			} // else, this list was moved from, do_nothing();
+			this->counts.release(counter_allocator(this->allocator));
+		}
+
+		/**
+		 * Constructs an array_list from the given list.
+		 * This instance will contain a copy of each of the elements in rhs, in the same order.
+		 *
+		 * @param rhs the list to copy.
+		 */
+		array_list(array_list&& rhs) :
+			my_size{ 0 }, my_capacity{ 0 }, data{ nullptr }, allocator{ rhs.allocator }
+		{
+			// We take everything from rhs and leave it empty,
+			// holding nothing but what this instance started with.
+			this->exchange(rhs);
+		}
+
+		/**
+		 * Constructs a list from rhs whose elements come from allocator. The
+		 * storage of rhs is taken when allocator compares equal to its own,
+		 * otherwise the elements are moved over one by one.
+		 *
+		 * @param rhs the list to move from.
+		 * @param allocator the allocator the elements will come from.
+		 */
+		array_list(array_list&& rhs, const Allocator& allocator) :
+			my_size{ 0 }, my_capacity{ 0 }, data{ nullptr }, allocator{ allocator }
+		{
+			if (allocator_traits::is_always_equal::value || this->allocator == rhs.allocator) {
+				this->exchange(rhs);
+				return;
+			} // else, only the allocator of rhs can free its storage, do_nothing();
+
+			// Deferred hits refer to positions in rhs, apply them before the order is copied.
+			rhs.flush_promotions();
+			this->pending.set_batch_size(rhs.pending.batch_size());
+			std::swap(this->stats, rhs.stats);
+			this->scanner = rhs.scanner;
+			this->my_scan_threshold = rhs.my_scan_threshold;
+			this->take_copy(std::make_move_iterator(rhs.data), rhs);
+		}
+
+		/**
+		 * Assigns to this instance the given list.
+		 * This will replace its current contents, and modify its size accordingly.
+		 * When the allocator does not propagate on move assignment and differs
+		 * from the one of rhs, the elements are moved one by one into this
+		 * instance's storage instead.
+		 *
+		 * @param rhs the list to assign to this list.
+		 */
+		array_list& operator=(array_list&& rhs)
+		{
+			if constexpr (!allocator_traits::propagate_on_container_move_assignment::value && !allocator_traits::is_always_equal::value) {
+				if (this->allocator != rhs.allocator) {
+					array_list moved(std::move(rhs), this->allocator);
+					this->exchange(moved);
+					return *this;
+				} // else, the storage of rhs can be taken as is, do_nothing();
+			} // else, the allocator goes with the storage, do_nothing();
+
+			this->exchange(rhs);
+			return *this;
+		}
+
+		/**
+		 * Returns a copy of the allocator the elements come from.
+		 */
+		allocator_type get_allocator() const
+		{
+			return this->allocator;
+		}
+
+		/**
+		 * Returns whether if this instance is empty.
+		 *
+		 * @return true if this instance is empty, otherwise, false.
+		 */
+		bool empty() const
+		{
+			return this->size() == 0;
+		}
+
+		/**
+		 * Returns the number of elements in this instance.
+		 *
+		 * @return the current number of elements in this list.
+		 */
+		int size() const
+		{
+			return this->my_size;
+		}
+
+		/**
+		 * Returns the size of the storage space currently allocated for this instance.
+		 *
+		 * @return the size of the currently allocated storage capacity in this instance.
+		 */
+		int capacity() const
+		{
+			return this->my_capacity;
+		}
+
+		/**
+		 * Returns a reference to the element at position index in the list.
+		 *
+		 * @param index the index at which to get the value.
+		 */
+		T& operator[](int index)
+		{
+			if (index < 0 || index >= this->size()) {
+				throw std::out_of_range("Index out of range");
+			} // else, index is valid, do_nothing();
+
+			return this->data[index];
+		}
+
+		/**
+		 * Returns a constant reference to the element at position index in the list.
+		 *
+		 * @param index the index at which to get the value.
+		 */
+		const T& operator[](int index) const
+		{
+			if (index < 0 || index >= this->size()) {
+				throw std::out_of_range("Index out of range");
+			} // else, index is valid, do_nothing();
+
+			return this->data[index];
+		}
+
+		/**
+		 * Removes every element, keeping the capacity for reuse.
+		 */
+		void clear()
+		{
+			this->pending.clear();
+			std::destroy(this->data, this->data + this->my_size);
+			this->my_size = 0;
+		}
+
+		/**
+		 * Resizes this instance so that it contains new_size elements.
+		 *
+		 * @param new_size the new size of this list.
+		 */
+		void resize(int new_size)
+		{
+			if (new_size < this->my_size) {
+				// Deferred promotions may refer to elements about to be dropped.
+				this->flush_promotions();
+			} // else, every recorded index stays valid, do_nothing();
+
+			// Here all we need to check is new size is not less than the capacity.
+			if (new_size > this->my_capacity) {
+				reserve((new_size * 3) / 2);
+			} // else, the capacity is fine, do_nothing();
+
+			if (new_size < this->my_size) {
+				std::destroy(this->data + new_size, this->data + this->my_size);
+				this->my_size = new_size;
+			} // else, new elements are value-initialized below, do_nothing();
+
+			for (auto index = this->my_size; index < new_size; index++) {
+				allocator_traits::construct(this->allocator, this->data + index);
+				this->counts.reset(index);
+				this->my_size++;
+			}
+		}
+
+		/**
+		 * Requests that the list capacity be at least enough to contain new_capacity elements.
+		 *
+		 * @param new_capacity the new list capacity.
+		 */
+		void reserve(int new_capacity)
+		{
+			// if the new capacity is less than size, we have nothing to do. 
+			if (new_capacity < this->my_size) {
+				return;
+			} // else, we need to reserve more memory, do_nothing();
+
+			// The inline buffer is already as small as the list gets.
+			if (this->is_local(this->data) && new_capacity <= InlineCapacity) {
+				return;
+			} // else, the elements are moving, do_nothing();
+
+			// Allocate raw memory for the array, nothing is constructed yet. 
+			T* new_data = this->acquire_storage(new_capacity);
+			// The counters are allocated before any element moves, so a failure leaves the list untouched.
+			decltype(this->counts) grown;
+			try {
+				grown.allocate(new_capacity, counter_allocator(this->allocator));
+				// Relocate each live element into the new array, a single memcpy for trivially copyable T. 
+				detail::relocate(this->data, this->my_size, new_data);
+			}
+			catch (...) {
+				grown.release(counter_allocator(this->allocator));
+				this->release_storage(new_data, new_capacity);
+				throw;
+			}
+			grown.copy(this->counts, this->my_size);
+			this->counts.swap(grown);
+			grown.release(counter_allocator(this->allocator));
+			// Change my capacity to the new amount. 
+			std::swap(this->my_capacity, new_capacity);
+			// We do this so I do not have to delete data. 
+			std::swap(this->data, new_data);
+			// The old elements were destroyed by relocate, only the memory is left. 
+			this->release_storage(new_data, new_capacity);
+		}
+
+		/**
+		 * Adds a new element at the end of the list, after its current last element.
+		 *
+		 * @param value the value to add to the list.
+		 */
+		void push_back(const T& value)
+		{
+			if (this->my_size == this->my_capacity) {
+				// This means I have ran out of room
+				// I need a bigger array. value may live in the old one, so copy it first.
+				auto copy = value;
+				this->reserve(this->grown_capacity());
+				this->emplace_back(std::move(copy));
+				return;
+			} // else, the size is fine, do_nothing();
+			allocator_traits::construct(this->allocator, this->data + this->my_size, value);
+			this->counts.reset(this->my_size);
+			this->my_size++;
+		}
+
+		/**
+		 * Adds a new element at the end of the list, after its current last element.
+		 * This new element is constructed in place.
+		 *
+		 * @param value the value to add to the list.
+		 */
+
+		void emplace_back(T&& value)
+		{
+			if (this->my_size == this->my_capacity) {
+				// value may live in the old array, so move it out first.
+				auto moved = std::move(value);
+				this->reserve(this->grown_capacity());
+				this->emplace_back(std::move(moved));
+				return;
+			} // else, the size is find, do_nothing();
+			// Notice here, we can move the rvalue not copy it like in push_back
+			allocator_traits::construct(this->allocator, this->data + this->my_size, std::move(value));
+			this->counts.reset(this->my_size);
+			this->my_size++;
+		}
+
+		/**
+		 * Adds a new element at the front of the list, shifting every other element back one slot.
+		 *
+		 * @param value the value to add to the list.
+		 */
+		void push_front(const T& value)
+		{
+			// Deferred promotions refer to indices that are about to shift.
+			this->flush_promotions();
+			this->push_back(value);
+			detail::move_forward(this->data, this->my_size - 1, 0);
+			this->counts.move_forward(this->my_size - 1, 0);
+		}
+
+		/**
+		 * Removes the first element equal to key, shifting the elements behind it forward one slot.
+		 * The order of the other elements is unchanged.
+		 *
+		 * @param key the value to remove.
+		 * @return true if an element was removed.
+		 */
+		bool erase(const T& key)
+		{
+			// Deferred promotions refer to indices that are about to shift.
+			this->flush_promotions();
+			auto index = this->index_of(key);
+			if (index < 0) {
+				return false;
+			} // else, key was found at index, do_nothing();
+
+			std::move(this->data + index + 1, this->data + this->my_size, this->data + index);
+			this->counts.erase(index, this->my_size);
+			--this->my_size;
+			this->data[this->my_size].~T();
+			return true;
+		}
+
+		/**
+		 * Removes the last element in the list, this reduces the size of the list by one.
+		 */
+		void pop_back()
+		{
+			if (this->empty()) {
+				throw std::out_of_range("List is empty");
+			} // else, we have elements so remove the last one. 
+			this->flush_promotions();
+			--this->my_size;
+			this->data[this->my_size].~T();
+		}
+
+		/**
+		 * Returns constant a reference to the last element in the list.
+		 *
+		 * @return a constant last element in the list.
+		 */
+		const T& back() const
+		{
+			if (this->empty()) {
+				throw std::out_of_range("List is empty");
+			} // else, we have values, do_nothing();
+
+			return this->data[this->my_size - 1];
+		}
+
+		typedef T* iterator;
+		typedef const T* const_iterator;
+
+		/**
+		 * Returns an iterator pointing to the first element in the list.
+		 *
+		 * @return an iterator to the beginning of the list.
+		 */
+		iterator begin()
+		{
+			return &this->data[0];
+		}
+
+		/**
+		 * Returns a constant iterator pointing to the first element in the list.
+		 *
+		 * @return a constant iterator to the first element in the list.
+		 */
+		const_iterator begin() const
+		{
+			return &this->data[0];
+		}
+
+		/**
+		 * Returns an iterator referring to the past-the-end element in the list.
+		 *
+		 * @return an iterator to the element past the end of the list.
+		 */
+		iterator end()
+		{
+			return &this->data[this->size()];
+		}
+
+		/**
+		 * Returns a constant iterator pointing to the past-the-end element in the list.
+		 *
+		 * @return a constant iterator to the element past the end of the list.
+		 */
+		const_iterator end() const
+		{
+			return &this->data[this->size()];
+		}
+
+		/**
+		 * A modifier to ensure we do not have a zero (0) capacity in the list.
+		 */
+		static const int k_spare_capacity = 2;
+
+		/**
+		 * Searches array_list for key then moves it forward as decided by Policy
+		 * (to the front by default).
+		 * Arithmetic and pointer types are scanned with vector compares, and trivially
+		 * copyable types are shifted with a single memmove (see array_kernels.h).
+		 * key may be of any type comparable with element == key, such as a
+		 * std::string_view in an array_list<std::string>; it is never converted to T.
+		 *
+		 * @param key is the value you are searching for.
+		 */
+		template <typename K>
+		const bool find(const K& key)
+		{
+			return this->find_position(key) != this->end();
+		}
+
+		/**
+		 * Same as find, but returns where the found element is after its promotion,
+		 * so it can be read or updated without searching again.
+		 *
+		 * @param key is the value you are searching for.
+		 * @return an iterator to the found element, or end() if key is not in the list.
+		 *         Like any iterator into the array it is invalidated by the next change of order.
+		 */
+		template <typename K>
+		iterator find_position(const K& key)
+		{
+			auto timer = this->stats.begin_lookup();
+			auto index = this->index_of(key);												// O(n) due to search n times.
+			return this->found(timer, index);												// Overal run-time of O(n)
+		}
+
+		/**
+		 * Searches array_list for the first element matches accepts, then moves
+		 * it forward as decided by Policy. To look up a record by one of its
+		 * fields, compare the field in the predicate:
+		 *
+		 *     list.find_if([&id](const record& value) { return value.id == id; });
+		 *
+		 * @param matches called with a constant reference to each element, front to back.
+		 * @return an iterator to the found element, or end() if nothing matched.
+		 */
+		template <typename Predicate>
+		iterator find_if(Predicate matches)
+		{
+			auto timer = this->stats.begin_lookup();
+			auto index = detail::find_index_if(this->data, this->my_size, matches);			// O(n) due to search n times.
+			return this->found(timer, index);
+		}
+
+		/**
+		 * Returns whether key is in the list without changing the order.
+		 *
+		 * @param key is the value you are searching for.
+		 */
+		template <typename K>
+		bool contains(const K& key) const
+		{
+			return this->index_of(key) >= 0;
+		}
+
+		/**
+		 * Splits the scans of find, find_position, contains and erase across
+		 * the threads of pool whenever the list holds at least threshold
+		 * elements. The first matching element is found, exactly as by a
+		 * serial scan, and promoted as usual. find_if always scans serially,
+		 * since its predicate may not be safe to call from several threads.
+		 *
+		 * The pool is not owned and must outlive its use by this list; several
+		 * lists may share one. Comparing elements must be safe to do concurrently.
+		 *
+		 * @param pool the threads to scan with, or nullptr to scan serially again.
+		 * @param threshold the smallest size scanned in parallel.
+		 */
+		void scan_in_parallel(scan_pool* pool, int threshold = k_default_scan_threshold)
+		{
+			this->scanner = pool;
+			this->my_scan_threshold = std::max(0, threshold);
+		}
+
+		/**
+		 * The size from which scan_in_parallel splits scans by default: below
+		 * it, a serial scan finishes before the workers would have woken up.
+		 */
+		static const int k_default_scan_threshold = 1 << 18;
+
+		/**
+		 * The number of bytes a thread scans in parallel mode before checking
+		 * whether another thread has already found an earlier match.
+		 */
+		static const int k_scan_chunk_bytes = 1 << 16;
+
+		/**
+		 * Defers promotions: find only records where it found the key, and the
+		 * recorded promotions are applied together every batch_size hits (or on
+		 * flush_promotions), with repeated hits on one element coalesced.
+		 * Between batches find leaves the array untouched.
+		 *
+		 * Elements are promoted oldest last hit first, each as if find had
+		 * run once per hit. Under move_to_front the result is the order eager
+		 * finds give, and under frequency_count the counts are the same. Under
+		 * transpose and move_ahead_k an element may stop in a different place,
+		 * because its hits are no longer interleaved with those on others.
+		 *
+		 * @param batch_size the number of hits per batch, 0 to promote on every find again.
+		 */
+		void defer_promotions(int batch_size)
+		{
+			this->flush_promotions();
+			this->pending.set_batch_size(batch_size);
+		}
+
+		/**
+		 * Applies every deferred promotion now.
+		 * Under move_to_front the result is the same as promoting on every find,
+		 * done in a single pass over the array.
+		 */
+		void flush_promotions()
+		{
+			this->apply_promotions();
+		}
+
+		/**
+		 * Returns the number of hits recorded but not yet applied.
+		 */
+		int pending_promotions() const
+		{
+			return this->pending.size();
+		}
+
+		/**
+		 * Writes the elements in their current order to a snapshot file (see
+		 * snapshot.h), with their access counters if Policy keeps them, so a
+		 * restarted process can load the order find has learned.
+		 * Promotions that are still deferred are not included.
+		 *
+		 * @param path the file to write.
+		 */
+		void save(const std::string& path) const
+		{
+			snapshot_writer out(path);
+			detail::write_snapshot_header<T>(out, this->my_size, Policy::k_counts_accesses);
+			if constexpr (Policy::k_counts_accesses) {
+				out.write_bytes(this->counts.data(), this->my_size * sizeof(access_counter));
+			} // else, there are no counters to save, do_nothing();
+
+			if constexpr (detail::is_raw_snapshot_element<T>::value) {
+				out.write_bytes(this->data, this->my_size * sizeof(T));
+			} else {
+				for (auto index = 0; index < this->my_size; index++) {
+					snapshot_traits<T>::save(out, this->data[index]);
+				}
+			}
+			out.finish();
+		}
+
+		/**
+		 * Replaces the contents of this list with a snapshot written by save.
+		 * The file is memory mapped; trivially copyable elements are copied
+		 * out of it in one block, other types are decoded one by one into
+		 * storage reserved up front. Counters are restored when both the
+		 * snapshot and Policy have them, and start at zero otherwise. The
+		 * statistics, the deferred batch size and the parallel scan settings
+		 * are kept; hits still deferred are dropped.
+		 * A count that does not fit, or, for trivially copyable elements, one
+		 * the file is too short for, is rejected before storage is reserved.
+		 *
+		 * @param path the file to read.
+		 */
+		void load(const std::string& path)
+		{
+			detail::mapped_file file(path);
+			snapshot_reader in(file.data(), file.size());
+			auto header = detail::read_snapshot_header<T>(in, INT32_MAX - k_spare_capacity, sizeof(access_counter));
+			auto count = static_cast<int>(header.count);
+
+			array_list loaded(count, this->allocator);
+			if (header.flags & snapshot_header::k_has_counts) {
+				auto* counters = in.take(count * sizeof(access_counter));
+				if constexpr (Policy::k_counts_accesses) {
+					std::memcpy(loaded.counts.data(), counters, count * sizeof(access_counter));
+				} else {
+					(void)counters;
+				}
+			} // else, every counter starts at zero, do_nothing();
+
+			if constexpr (detail::is_raw_snapshot_element<T>::value) {
+				in.read_bytes(loaded.data, count * sizeof(T));
+				loaded.my_size = count;
+			} else {
+				for (; loaded.my_size < count; loaded.my_size++) {
+					allocator_traits::construct(loaded.allocator, loaded.data + loaded.my_size, snapshot_traits<T>::load(in));
+				}
+			}
+
+			loaded.pending.set_batch_size(this->pending.batch_size());
+			loaded.scan_in_parallel(this->scanner, this->my_scan_threshold);
+			// Only the elements are replaced, what find has recorded stays with this list.
+			std::swap(loaded.stats, this->stats);
+			this->exchange(loaded);
+		}
+
+		/**
+		 * Returns what find has recorded, e.g. statistics().snapshot() or
+		 * statistics().reset(). Records nothing unless Stats is access_stats.
+		 */
+		Stats& statistics()
+		{
+			return this->stats;
+		}
+
+		/**
+		 * Returns what find has recorded.
+		 */
+		const Stats& statistics() const
+		{
+			return this->stats;
+		}
+
+	private:
+		typedef std::allocator_traits<Allocator> allocator_traits;
+
+		typedef detail::rebind_allocator<Allocator, access_counter> counter_allocator;
+
+		/**
+		 * The current number of elements in the list.
+		 */
+		int my_size;
+		/**
+		 * The current capacity of the list.
+		 */
+		int my_capacity;
+		/**
+		 * A pointer to the backing array.
+		 */
+		T* data;
+		/**
+		 * Room for the first InlineCapacity elements, on the same cache line as the header.
+		 */
+		detail::inline_storage<T, InlineCapacity> local;
+		/**
+		 * Access counters parallel to data, empty unless Policy counts accesses.
+		 */
+		detail::access_counts<Policy::k_counts_accesses, counter_allocator, InlineCapacity> counts;
+		/**
+		 * Hits recorded by find while promotions are deferred.
+		 */
+		promotion_buffer<int> pending;
+		/**
+		 * Lookup and promotion counters, empty unless Stats records them.
+		 */
+		Stats stats;
+		/**
+		 * The threads that split long scans, nullptr to scan serially.
+		 */
+		scan_pool* scanner = nullptr;
+		/**
+		 * The smallest size scanned in parallel.
+		 */
+		int my_scan_threshold = k_default_scan_threshold;
+		/**
+		 * Where the elements and counters come from.
+		 */
+		Allocator allocator;
+
+		/**
+		 * Exchanges everything with rhs. The allocators are exchanged along with
+		 * the storage, or must compare equal when they cannot be swapped.
+		 */
+		void exchange(array_list& rhs)
+		{
+			detail::swap_allocators(this->allocator, rhs.allocator);
+			if (this->is_local(this->data) || rhs.is_local(rhs.data)) {
+				this->exchange_local(rhs);
+			}
+			else {
+				std::swap(this->my_capacity, rhs.my_capacity);
+				std::swap(this->data, rhs.data);
+			}
+			std::swap(this->my_size, rhs.my_size);
+			this->counts.swap(rhs.counts);
+			this->pending.swap(rhs.pending);
+			std::swap(this->stats, rhs.stats);
+			std::swap(this->scanner, rhs.scanner);
+			std::swap(this->my_scan_threshold, rhs.my_scan_threshold);
+		}
+
+		/**
+		 * Fills this empty list with rhs's capacity, elements and counters,
+		 * constructing each element from first through this list's allocator.
+		 *
+		 * @param first rhs's elements, or a std::move_iterator over them.
+		 * @param rhs the list being copied or moved from.
+		 */
+		template <typename InputIt>
+		void take_copy(InputIt first, const array_list& rhs)
+		{
+			auto capacity = rhs.my_capacity;
+			try {
+				this->data = this->acquire_storage(capacity);
+				this->counts.allocate(capacity, counter_allocator(this->allocator));
+				detail::uninitialized_copy_with(this->allocator, first, rhs.my_size, this->data);
+			}
+			catch (...) {
+				// uninitialized_copy_with destroyed whatever it had built.
+				if (this->data != nullptr) {
+					this->release_storage(this->data, capacity);
+					this->data = nullptr;
+				} // else, the storage was never allocated, do_nothing();
+				this->counts.release(counter_allocator(this->allocator));
+				throw;
+			}
+			this->counts.copy(rhs.counts, rhs.my_size);
+			this->my_size = rhs.my_size;
+			this->my_capacity = capacity;
+		}
+
+		/**
+		 * Exchanges the elements of this list and rhs when at least one of them
+		 * is inline. Inline elements cannot change owners, so they are relocated
+		 * into the other list's buffer, the ones of this list by way of a
+		 * scratch buffer so that neither is overwritten before it is read.
+		 * Sizes are left for the caller to swap.
+		 */
+		void exchange_local(array_list& rhs)
+		{
+			detail::inline_storage<T, InlineCapacity> parked;
+			auto* mine = this->data;
+			auto my_capacity = this->my_capacity;
+			if (this->is_local(mine)) {
+				detail::relocate(mine, this->my_size, parked.data());
+				mine = parked.data();
+			} // else, this pointer can be handed over as is, do_nothing();
+
+			if (rhs.is_local(rhs.data)) {
+				detail::relocate(rhs.data, rhs.my_size, this->local.data());
+				this->data = this->local.data();
+				this->my_capacity = InlineCapacity;
+			}
+			else {
+				this->data = rhs.data;
+				this->my_capacity = rhs.my_capacity;
+			}
+
+			if (mine == parked.data()) {
+				detail::relocate(mine, this->my_size, rhs.local.data());
+				rhs.data = rhs.local.data();
+				rhs.my_capacity = InlineCapacity;
+			}
+			else {
+				rhs.data = mine;
+				rhs.my_capacity = my_capacity;
+			}
+		}
+
+		/**
+		 * Returns whether storage is this list's inline buffer.
+		 */
+		bool is_local(const T* storage) const
+		{
+			return InlineCapacity > 0 && storage == this->local.data();
+		}
+
+		/**
+		 * Returns uninitialized storage for capacity elements: the inline buffer
+		 * when they fit in it, raising capacity to InlineCapacity, and memory
+		 * from the allocator otherwise.
+		 *
+		 * @param capacity the number of elements needed, updated to the number that fit.
+		 */
+		T* acquire_storage(int& capacity)
+		{
+			if (InlineCapacity > 0 && capacity <= InlineCapacity) {
+				capacity = InlineCapacity;
+				return this->local.data();
+			} // else, the elements do not fit inline, do_nothing();
+
+			return allocator_traits::allocate(this->allocator, capacity);
+		}
+
+		/**
+		 * Frees storage from acquire_storage. Every element in it must already be destroyed.
+		 */
+		void release_storage(T* storage, int capacity)
+		{
+			if (this->is_local(storage)) {
+				return;
+			} // else, the storage came from the allocator, do_nothing();
+
+			allocator_traits::deallocate(this->allocator, storage, capacity);
+		}
+
+		/**
+		 * Returns the capacity to grow to when the list is full, half again the current one.
+		 */
+		int grown_capacity() const
+		{
+			return this->my_capacity + std::max(1, this->my_capacity / 2);
+		}
+
+		/**
+		 * Returns the index of the first element equal to key, or -1, scanning
+		 * in parallel when the list is large enough and a scan_pool is set.
+		 */
+		template <typename K>
+		int index_of(const K& key) const
+		{
+			if (this->scanner == nullptr || this->my_size < this->my_scan_threshold) {
+				return detail::find_key_index(this->data, this->my_size, key);
+			} // else, the scan is long enough to split, do_nothing();
+
+			auto chunk_size = static_cast<int>(std::max<std::size_t>(1, k_scan_chunk_bytes / sizeof(T)));
+			return this->scanner->find_first(this->my_size, chunk_size, [this, &key](int from, int to) {
+				auto index = detail::find_key_index(this->data + from, to - from, key);
+				return index < 0 ? -1 : from + index;
+			});
+		}
+
+		/**
+		 * Finishes a lookup that found its element at index (or nothing, when
+		 * index is negative): promotes it, or records the hit while promotions
+		 * are deferred, and reports the lookup to stats.
+		 *
+		 * @return an iterator to where the element is now, or end().
+		 */
+		iterator found(const typename Stats::lookup_timer& timer, int index)
+		{
+			if (index < 0) {
+				this->stats.end_lookup(timer, false, this->my_size);
+				return this->end();
+			} // else, an element was found at index, do_nothing();
+
+			auto depth = index;
+			if (this->pending.deferring()) {
+				if (this->pending.record(index)) {
+					index = this->apply_promotions();
+				} // else, the batch is not full yet and the element has not moved, do_nothing();
+			}
+			else {
+				index = this->promote(index);												// O(n) shifting the prefix one slot.
+			}
+			this->stats.end_lookup(timer, true, depth);
+			return this->data + index;
+		}
+
+		/**
+		 * Applies every deferred promotion.
+		 *
+		 * @return the index the most recently found element ended up at, or -1 if nothing was deferred.
+		 */
+		int apply_promotions()
+		{
+			if (this->pending.empty()) {
+				return -1;
+			} // else, there is work to apply, do_nothing();
+
+			auto& hits = this->pending.take();
+			if constexpr (std::is_same<Policy, move_to_front>::value) {
+				this->move_all_to_front(hits, this->pending.taken_by_position());
+				return 0;
+			} else {
+				// Oldest first, so the most recent hit ends up furthest forward.
+				auto newest = -1;
+				for (auto entry = hits.rbegin(); entry != hits.rend(); ++entry) {
+					auto from = entry->position;
+					auto to = this->promote(from, entry->hits);
+					for (auto later = entry + 1; later != hits.rend(); ++later) {
+						if (later->position >= to && later->position < from) {
+							later->position++;
+						} // else, the move did not shift this element, do_nothing();
+					}
+					newest = to;
+				}
+				return newest;
+			}
+		}
+
+		/**
+		 * Moves the element at index forward as far as Policy decides.
+		 *
+		 * @param index the index of the element that was just found.
+		 * @param hits the number of times it was found.
+		 * @return the index the element moved to.
+		 */
+		int promote(int index, int hits = 1)
+		{
+			if constexpr (Policy::k_counts_accesses) {
+				this->counts[index] += hits;
+			} else {
+				// Without counters every hit is a step of its own, as if find had run hits times.
+				for (; hits > 1; hits--) {
+					index = this->promote(index);
+				}
+			}
+
+			auto ahead = index;
+			auto steps = Policy::steps(index, [this, index, &ahead]() {
+				--ahead;
+				if constexpr (Policy::k_counts_accesses) {
+					return this->counts[index] > this->counts[ahead];
+				} else {
+					return true;
+				}
+			});
+			detail::move_forward(this->data, index, index - steps);
+			this->counts.move_forward(index, index - steps);
+			this->stats.record_promotion(steps);
+			return index - steps;
+		}
+
+		/**
+		 * Applies a batch of move-to-front promotions in one pass: the found
+		 * elements are lifted out, everything else in front of the deepest one
+		 * slides back to close the gaps, and the found elements are placed at
+		 * the front, most recent first. They wait in the spare capacity past
+		 * the last element, which is grown once if it is too small, so a
+		 * flush does not allocate.
+		 *
+		 * @param hits the distinct indices found, most recent first.
+		 * @param found the same indices in ascending order.
+		 */
+		void move_all_to_front(const std::vector<typename promotion_buffer<int>::entry>& hits, const std::vector<int>& found)
+		{
+			auto lifted_count = static_cast<int>(hits.size());
+			if (this->my_capacity - this->my_size < lifted_count) {
+				this->reserve(this->my_size + lifted_count);
+			} // else, there is room to park the found elements, do_nothing();
+
+			auto* lifted = this->data + this->my_size;
+			for (auto index = 0; index < lifted_count; index++) {
+				allocator_traits::construct(this->allocator, lifted + index, std::move(this->data[hits[index].position]));
+			}
+
+			auto deepest = found.back();
+			auto next_found = lifted_count - 1;
+			auto write = deepest;
+			for (auto read = deepest; read >= 0; read--) {
+				if (next_found >= 0 && found[next_found] == read) {
+					next_found--;
+				}
+				else {
+					this->data[write--] = std::move(this->data[read]);
+				}
+			}
+
+			for (auto index = 0; index < lifted_count; index++) {
+				this->data[index] = std::move(lifted[index]);
+				allocator_traits::destroy(this->allocator, lifted + index);
+				this->stats.record_promotion(hits[index].position - index);
+			}
+		}
+	};
+
+	/**
+	 * An array_list that keeps up to InlineCapacity elements inside the object,
+	 * so small tables never allocate.
+	 */
+	template <typename T, int InlineCapacity, typename Policy = move_to_front, typename Stats = no_stats, typename Allocator = std::allocator<T>>
+	using small_array_list = array_list<T, Policy, Stats, Allocator, InlineCapacity>;
+
+	namespace pmr {
+
+		/**
+		 * An array_list whose elements come from a std::pmr::memory_resource.
+		 */
+		template <typename T, typename Policy = move_to_front, typename Stats = no_stats>
+		using array_list = nwacc::array_list<T, Policy, Stats, std::pmr::polymorphic_allocator<T>>;
+
+		/**
+		 * A small_array_list whose overflow storage comes from a std::pmr::memory_resource.
+		 */
+		template <typename T, int InlineCapacity, typename Policy = move_to_front, typename Stats = no_stats>
+		using small_array_list = nwacc::array_list<T, Policy, Stats, std::pmr::polymorphic_allocator<T>, InlineCapacity>;
+
+	}
+
+}
+
+#endif
@@ -0,0 +1,407 @@
+#ifndef SELF_ADJUSTING_CONCURRENT_LIST_H
+#define SELF_ADJUSTING_CONCURRENT_LIST_H
+
+#include <atomic>
+#include <cstdint>
+#include <mutex>
+#include <vector>
+
+#include "epoch_domain.h"
+#include "node_pool.h"
+
+namespace nwacc {
+
+	/**
+	 * A move-to-front doubly linked list that many threads can search at once.
+	 *
+	 * find walks the list without taking any lock; nodes that are erased while
+	 * a search may still be standing on them are only freed once every such
+	 * search has finished (see epoch_domain.h). Structural changes (relinking a
+	 * found node to the front, insert, erase) are serialized by one writer lock
+	 * that is held only for the constant time relink itself. Promotion is best
+	 * effort: when another thread is already relinking, find returns without
+	 * moving the node instead of waiting.
+	 *
+	 * A lock-free search can miss a key that a concurrent promotion moved
+	 * behind it, so a miss is only reported once a search has completed with no
+	 * relink in between; after k_optimistic_attempts tries the search is repeated
+	 * under the writer lock.
+	 *
+	 * Elements are immutable once inserted, so the list hands out no mutable
+	 * access and has no iterators; use for_each to visit the elements.
+	 *
+	 * @param T the element type.
+	 */
+	template <typename T>
+	class concurrent_list {
+	private:
+		/**
+		 * Constructs a node struct to create a doubly linked list.
+		 * next is read by searches without the lock, everything else is only
+		 * touched under the writer lock.
+		 */
+		struct node {
+
+			T data;
+
+			std::atomic<node*> next;
+
+			node* previous;
+
+			bool linked;
+
+			node(const T& data = T{ }) : data{ data }, next{ nullptr }, previous{ nullptr }, linked{ true } { }
+
+			node(T&& data) : data{ std::move(data) }, next{ nullptr }, previous{ nullptr }, linked{ true } { }
+		};
+
+	public:
+		concurrent_list() : my_size{ 0 }, relinks{ 0 }
+		{
+			this->head = this->pool.create();
+			this->tail = this->pool.create();
+			this->head->next.store(this->tail, std::memory_order_relaxed);
+			this->tail->previous = this->head;
+		}
+
+		/**
+		 * Destroys the list. No other thread may be using it.
+		 */
+		~concurrent_list()
+		{
+			auto* current = this->head->next.load(std::memory_order_relaxed);
+			while (current != this->tail) {
+				auto* next = current->next.load(std::memory_order_relaxed);
+				this->pool.destroy(current);
+				current = next;
+			}
+			this->reclaim();
+			this->pool.destroy(this->head);
+			this->pool.destroy(this->tail);
+		}
+
+		concurrent_list(const concurrent_list&) = delete;
+
+		concurrent_list& operator=(const concurrent_list&) = delete;
+
+		/**
+		* Returns size of the list.
+		*/
+		int size() const
+		{
+			return this->my_size.load(std::memory_order_relaxed);
+		}
+
+		/**
+		* Checks if list is empty.
+		*/
+		bool empty() const
+		{
+			return this->size() == 0;
+		}
+
+		/**
+		 * Adds a new element at the front of the list.
+		 *
+		 * @param value the value to add to the list.
+		 */
+		void push_front(const T& value)
+		{
+			std::lock_guard<std::mutex> lock(this->writer);
+			this->link_front(this->pool.create(value));
+			this->my_size.fetch_add(1, std::memory_order_relaxed);
+		}
+
+		/**
+		 * Adds a new element at the end of the list, after its current last element.
+		 *
+		 * @param value the value to add to the list.
+		 */
+		void push_back(const T& value)
+		{
+			std::lock_guard<std::mutex> lock(this->writer);
+			auto* created = this->pool.create(value);
+			auto* last = this->tail->previous;
+			created->previous = last;
+			created->next.store(this->tail, std::memory_order_relaxed);
+			this->tail->previous = created;
+			last->next.store(created, std::memory_order_release);
+			this->my_size.fetch_add(1, std::memory_order_relaxed);
+		}
+
+		/**
+		 * Erases the first element equal to key. The node is freed once no search can reach it.
+		 *
+		 * @param key is the value to erase.
+		 * @return true if an element was erased.
+		 */
+		bool erase(const T& key)
+		{
+			std::lock_guard<std::mutex> lock(this->writer);
+			auto* found = this->locked_scan(key);
+			if (found == nullptr) {
+				return false;
+			} // else, key is in the list, do_nothing();
+
+			this->unlink(found);
+			found->linked = false;
+			this->my_size.fetch_sub(1, std::memory_order_relaxed);
+			this->retired.push_back(found);
+			if (this->retired.size() >= k_retire_batch) {
+				this->readers.synchronize();
+				this->reclaim();
+			} // else, keep batching retired nodes, do_nothing();
+			return true;
+		}
+
+		/**
+		 * Erases every element.
+		 */
+		void clear()
+		{
+			std::lock_guard<std::mutex> lock(this->writer);
+			auto* current = this->head->next.load(std::memory_order_relaxed);
+			while (current != this->tail) {
+				current->linked = false;
+				this->retired.push_back(current);
+				current = current->next.load(std::memory_order_relaxed);
+			}
+			this->head->next.store(this->tail, std::memory_order_release);
+			this->tail->previous = this->head;
+			this->my_size.store(0, std::memory_order_relaxed);
+			this->readers.synchronize();
+			this->reclaim();
+		}
+
+		/**
+		 * Locates search key and moves it to the front of list.
+		 * The search takes no lock, and the move is skipped if another thread is relinking.
+		 *
+		 * @param key is the value to search the list for.
+		 */
+		bool find(const T& key)
+		{
+			for (auto attempt = 0; attempt < k_optimistic_attempts; attempt++) {
+				epoch_domain::guard reading(this->readers);
+				auto version = this->relinks.load(std::memory_order_acquire);
+				auto* found = this->scan(key);
+				if (found != nullptr) {
+					this->try_promote(found);
+					return true;
+				} // else, either key is absent or a relink moved it behind us.
+
+				if (version % 2 == 0 && this->relinks.load(std::memory_order_acquire) == version) {
+					return false;
+				} // else, a relink overlapped the search, retry.
+			}
+
+			std::lock_guard<std::mutex> lock(this->writer);
+			auto* found = this->locked_scan(key);
+			if (found == nullptr) {
+				return false;
+			} // else, key is in the list, do_nothing();
+			this->relink_front(found);
+			return true;
+		}
+
+		/**
+		 * Returns whether key is in the list without changing the order.
+		 *
+		 * @param key is the value to search the list for.
+		 */
+		bool contains(const T& key)
+		{
+			for (auto attempt = 0; attempt < k_optimistic_attempts; attempt++) {
+				epoch_domain::guard reading(this->readers);
+				auto version = this->relinks.load(std::memory_order_acquire);
+				if (this->scan(key) != nullptr) {
+					return true;
+				} // else, either key is absent or a relink moved it behind us.
+
+				if (version % 2 == 0 && this->relinks.load(std::memory_order_acquire) == version) {
+					return false;
+				} // else, a relink overlapped the search, retry.
+			}
+
+			std::lock_guard<std::mutex> lock(this->writer);
+			return this->locked_scan(key) != nullptr;
+		}
+
+		/**
+		 * Calls visit with each element from front to back without taking a lock.
+		 * Under concurrent finds an element may be visited more than once.
+		 * visit must not call erase or clear: they wait for every traversal in
+		 * progress, this one included, to finish and would never return.
+		 *
+		 * @param visit called with a constant reference to each element.
+		 */
+		template <typename Visitor>
+		void for_each(Visitor visit)
+		{
+			epoch_domain::guard reading(this->readers);
+			auto steps = 0;
+			auto limit = this->step_limit();
+			for (auto* current = this->head->next.load(std::memory_order_acquire);
+				current != this->tail && steps < limit;
+				current = current->next.load(std::memory_order_acquire), steps++) {
+				visit(static_cast<const T&>(current->data));
+			}
+		}
+
+	private:
+		/**
+		 * The number of lock-free searches tried before a search takes the writer lock.
+		 */
+		static const int k_optimistic_attempts = 4;
+
+		/**
+		 * The number of erased nodes collected before waiting for searches to drain and freeing them.
+		 */
+		static const std::size_t k_retire_batch = 64;
+
+		/**
+		 * The current number of nodes in the list.
+		 */
+		std::atomic<int> my_size;
+		/**
+		 * Bumped before and after every relink, so it is odd while one is in
+		 * progress. Searches use it to tell a real miss from one caused by a relink.
+		 */
+		std::atomic<std::uint64_t> relinks;
+		/**
+		 * Pointer to begining of list.
+		 */
+		node* head;
+		/**
+		 * Pointer to tail of the list.
+		 */
+		node* tail;
+		/**
+		 * Serializes every change to the links and to the pool.
+		 */
+		std::mutex writer;
+		/**
+		 * Tracks searches in progress so erased nodes are not freed under them.
+		 */
+		epoch_domain readers;
+		/**
+		 * Storage for every node of this list. Only used under the writer lock.
+		 */
+		node_pool<node> pool;
+		/**
+		 * Erased nodes waiting for in-flight searches to finish.
+		 */
+		std::vector<node*> retired;
+
+		/**
+		 * The most nodes a lock-free walk follows before giving up. Concurrent
+		 * relinks can send a walk back to the front, this bounds how often.
+		 */
+		int step_limit() const
+		{
+			return 2 * this->size() + 64;
+		}
+
+		/**
+		 * Searches without the lock. Must be called inside an epoch guard.
+		 */
+		node* scan(const T& key)
+		{
+			auto steps = 0;
+			auto limit = this->step_limit();
+			for (auto* current = this->head->next.load(std::memory_order_acquire);
+				current != this->tail && steps < limit;
+				current = current->next.load(std::memory_order_acquire), steps++) {
+				if (current->data == key) {
+					return current;
+				} // else, keep walking, do_nothing();
+			}
+			return nullptr;
+		}
+
+		/**
+		 * Searches with the writer lock held, so nothing can move.
+		 */
+		node* locked_scan(const T& key)
+		{
+			for (auto* current = this->head->next.load(std::memory_order_relaxed);
+				current != this->tail;
+				current = current->next.load(std::memory_order_relaxed)) {
+				if (current->data == key) {
+					return current;
+				} // else, keep walking, do_nothing();
+			}
+			return nullptr;
+		}
+
+		/**
+		 * Moves found to the front unless another thread holds the writer lock.
+		 * Must be called inside an epoch guard so found cannot be freed meanwhile.
+		 */
+		void try_promote(node* found)
+		{
+			std::unique_lock<std::mutex> lock(this->writer, std::try_to_lock);
+			if (!lock.owns_lock()) {
+				return;
+			} // else, we may relink, do_nothing();
+
+			if (found->linked) {
+				this->relink_front(found);
+			} // else, found was erased after we saw it, do_nothing();
+		}
+
+		/**
+		 * Moves a linked node to the front. Requires the writer lock.
+		 */
+		void relink_front(node* current)
+		{
+			if (current == this->head->next.load(std::memory_order_relaxed)) {
+				return;
+			} // else, current is somewhere behind the front, do_nothing();
+
+			// Announce the relink before any search can observe it, and again once it is complete.
+			this->relinks.fetch_add(1, std::memory_order_relaxed);
+			this->unlink(current);
+			this->link_front(current);
+			this->relinks.fetch_add(1, std::memory_order_release);
+		}
+
+		/**
+		 * Bypasses a node. Searches standing on it still reach the rest of the
+		 * list through its unchanged next pointer. Requires the writer lock.
+		 */
+		void unlink(node* current)
+		{
+			auto* previous = current->previous;
+			auto* next = current->next.load(std::memory_order_relaxed);
+			previous->next.store(next, std::memory_order_release);
+			next->previous = previous;
+		}
+
+		/**
+		 * Links a node directly after head and publishes it. Requires the writer lock.
+		 */
+		void link_front(node* current)
+		{
+			auto* first = this->head->next.load(std::memory_order_relaxed);
+			current->previous = this->head;
+			current->next.store(first, std::memory_order_release);
+			first->previous = current;
+			this->head->next.store(current, std::memory_order_release);
+		}
+
+		/**
+		 * Frees retired nodes. Requires the writer lock and a completed synchronize.
+		 */
+		void reclaim()
+		{
+			for (auto* dead : this->retired) {
+				this->pool.destroy(dead);
+			}
+			this->retired.clear();
+		}
+	};
+
+}
+
+#endif
@@ -0,0 +1,677 @@
+#ifndef SELF_ADJUSTING_HASHED_LIST_H
+#define SELF_ADJUSTING_HASHED_LIST_H
+
+#include <algorithm>
+#include <functional>
+#include <iostream>
+#include <unordered_map>
+
+#include "node_pool.h"
+
+namespace nwacc {
+
+	/**
+	 * A move-to-front doubly linked list with a hash index from each element to its node.
+	 *
+	 * The list keeps the recency order of linked_list, front being the most
+	 * recently found or inserted element, but find is O(1): the index locates
+	 * the node and a constant time relink promotes it. Elements are unique.
+	 *
+	 * With a capacity set, inserting into a full list evicts the element at the
+	 * back (the least recently used one) and passes it to the eviction callback
+	 * first, so the list can be used directly as an LRU cache.
+	 *
+	 * @param T the element type, also used as the key.
+	 * @param Hash the hash function for T.
+	 * @param KeyEqual the equality used by the index.
+	 */
+	template <typename T, typename Hash = std::hash<T>, typename KeyEqual = std::equal_to<T>>
+	class hashed_list {
+	private:
+		/**
+		 * Constructs a node struct to create a doubly linked list.
+		 */
+		struct node {
+
+			T data;
+
+			node* previous;
+
+			node* next;
+
+			node(const T& data = T{ }, node* previous = nullptr, node* next = nullptr)
+				: data{ data }, previous{ previous }, next{ next } { }
+
+			node(T&& data, node* previous = nullptr, node* next = nullptr)
+				: data{ std::move(data) }, previous{ previous }, next{ next } { }
+		};
+
+		/**
+		 * The index refers to the element stored in each node instead of copying it.
+		 */
+		typedef std::reference_wrapper<const T> key_reference;
+
+		struct key_hash {
+
+			Hash hash;
+
+			std::size_t operator()(const key_reference& key) const
+			{
+				return this->hash(key.get());
+			}
+		};
+
+		struct key_equal {
+
+			KeyEqual equal;
+
+			bool operator()(const key_reference& lhs, const key_reference& rhs) const
+			{
+				return this->equal(lhs.get(), rhs.get());
+			}
+		};
+
+	public:
+		/**
+		 * Called with each element just before it is evicted.
+		 */
+		typedef std::function<void(const T&)> eviction_callback;
+
+		class const_iterator {
+		public:
+
+			/**
+			 * Constructor for const iterator.
+			 */
+			const_iterator() : current{ nullptr }
+			{ }
+			/**
+			 * Returns the T stored at the current position.
+			*/
+			const T& operator*() const
+			{
+				return this->current->data;
+			}
+			/**
+			 * Overload of ++ operator to work with const iterator.
+			*/
+			const_iterator& operator++()
+			{
+				this->current = this->current->next;
+				return *this;
+			}
+			/**
+			 * Overload of ++ operator to work with const iterator.
+			*/
+			const_iterator operator++(int)
+			{
+				auto old = *this;
+				++(*this);
+				return old;
+			}
+			/**
+			 * Overload of -- operator to work with const iterator.
+			*/
+			const_iterator& operator--()
+			{
+				this->current = this->current->previous;
+				return *this;
+			}
+			/**
+			 * Overload of -- operator to work with const iterator.
+			*/
+			const_iterator operator--(int)
+			{
+				auto old = *this;
+				--(*this);
+				return old;
+			}
+			/**
+			 * Overload of == operator for comparison.
+			*/
+			bool operator==(const const_iterator& rhs) const
+			{
+				return this->current == rhs.current;
+			}
+			/**
+			 * Overload of != operator for comparison.
+			*/
+			bool operator!=(const const_iterator& rhs) const
+			{
+				return !(*this == rhs);
+			}
+
+		protected:
+			node* current;
+
+			// Protected constructor for const_iterator.
+			// Expects a pointer that represents the current position.
+			const_iterator(node* position) : current{ position }
+			{ }
+
+			friend class hashed_list<T, Hash, KeyEqual>;
+		};
+
+		/**
+		 * Elements double as index keys, so even this iterator only gives constant access.
+		 */
+		class iterator : public const_iterator {
+		public:
+
+			// Public constructor for iterator.
+			iterator()
+			{ }
+			/**
+			 * Overloaded ++ operator to work with iterator.
+			 */
+			iterator& operator++()
+			{
+				this->current = this->current->next;
+				return *this;
+			}
+			/**
+			 * Overloaded ++ operator to work with iterator.
+			 */
+			iterator operator++(int)
+			{
+				auto old = *this;
+				++(*this);
+				return old;
+			}
+			/**
+			 * Overloaded -- operator to work with iterator.
+			 */
+			iterator& operator--()
+			{
+				this->current = this->current->previous;
+				return *this;
+			}
+			/**
+			 * Overloaded -- operator to work with iterator.
+			 */
+			iterator operator--(int)
+			{
+				auto old = *this;
+				--(*this);
+				return old;
+			}
+
+		protected:
+			// Protected constructor for iterator.
+			// Expects the current position.
+			iterator(node* position) : const_iterator{ position }
+			{ }
+
+			friend class hashed_list<T, Hash, KeyEqual>;
+		};
+
+	public:
+		/**
+		 * Constructs an empty list.
+		 *
+		 * @param capacity the most elements the list holds before evicting, 0 for no limit.
+		 * @param on_evict called with each element just before it is evicted.
+		 */
+		explicit hashed_list(int capacity = 0, eviction_callback on_evict = nullptr)
+			: my_capacity{ capacity }, on_evict{ std::move(on_evict) }
+		{
+			this->init();
+		}
+
+		~hashed_list()
+		{
+			if (this->head != nullptr) {
+				this->clear();
+				this->pool.destroy(this->head);
+				this->pool.destroy(this->tail);
+			} // else, this list was moved from and owns no nodes, do_nothing();
+		}
+
+		/**
+		 * Copies the elements, recency order, capacity and eviction callback of rhs.
+		 */
+		hashed_list(const hashed_list& rhs)
+			: my_capacity{ rhs.my_capacity }, index{ rhs.index.bucket_count(), rhs.index.hash_function(), rhs.index.key_eq() }, on_evict{ rhs.on_evict }
+		{
+			this->init();
+			for (auto& value : rhs) {
+				this->push_back(value);
+			}
+		}
+
+		hashed_list& operator=(const hashed_list& rhs)
+		{
+			auto copy = rhs;
+			std::swap(*this, copy);
+			return *this;
+		}
+
+		hashed_list(hashed_list&& rhs)
+			: my_size{ rhs.my_size }, my_capacity{ rhs.my_capacity }, head{ rhs.head }, tail{ rhs.tail },
+			pool{ std::move(rhs.pool) }, index{ std::move(rhs.index) }, on_evict{ std::move(rhs.on_evict) }
+		{
+			rhs.my_size = 0;
+			rhs.head = nullptr;
+			rhs.tail = nullptr;
+			rhs.index.clear();
+		}
+
+		hashed_list& operator=(hashed_list&& rhs)
+		{
+			std::swap(this->my_size, rhs.my_size);
+			std::swap(this->my_capacity, rhs.my_capacity);
+			std::swap(this->head, rhs.head);
+			std::swap(this->tail, rhs.tail);
+			this->pool.swap(rhs.pool);
+			std::swap(this->index, rhs.index);
+			std::swap(this->on_evict, rhs.on_evict);
+			return *this;
+		}
+
+		/**
+		 * Return iterator representing beginning of list
+		 */
+		iterator begin()
+		{
+			return iterator(this->head->next);
+		}
+
+		/**
+		 * Return iterator representing beginning of list
+		 */
+		const_iterator begin() const
+		{
+			return const_iterator(this->head->next);
+		}
+
+		/**
+		 * Return iterator representing end marker of list
+		 */
+		iterator end()
+		{
+			return iterator(this->tail);
+		}
+
+		/**
+		* Returns a const_iterator to the tail of the list.
+		*/
+		const_iterator end() const
+		{
+			return const_iterator(this->tail);
+		}
+
+		/**
+		* Returns size of the list.
+		*/
+		int size() const
+		{
+			return this->my_size;
+		}
+
+		/**
+		* Checks if list is empty.
+		*/
+		bool empty() const
+		{
+			return this->size() == 0;
+		}
+
+		/**
+		* Returns the most elements the list holds before evicting, 0 for no limit.
+		*/
+		int capacity() const
+		{
+			return this->my_capacity;
+		}
+
+		/**
+		 * Changes the capacity, evicting from the back until the list fits.
+		 *
+		 * @param capacity the new capacity, 0 for no limit.
+		 */
+		void set_capacity(int capacity)
+		{
+			this->my_capacity = capacity;
+			while (this->my_capacity > 0 && this->my_size > this->my_capacity) {
+				this->evict();
+			}
+		}
+
+		/**
+		 * Replaces the eviction callback.
+		 *
+		 * @param callback called with each element just before it is evicted.
+		 */
+		void set_eviction_callback(eviction_callback callback)
+		{
+			this->on_evict = std::move(callback);
+		}
+
+		/**
+		* Clears the list. No element is reported as evicted.
+		*/
+		void clear()
+		{
+			this->index.clear();
+			auto* current = this->head->next;
+			while (current != this->tail) {
+				auto* next = current->next;
+				this->pool.destroy(current);
+				current = next;
+			}
+			this->head->next = this->tail;
+			this->tail->previous = this->head;
+			this->my_size = 0;
+		}
+
+		/**
+		* Returns value of the begining of the list.
+		*/
+		const T& front() const
+		{
+			return *this->begin();
+		}
+
+		/**
+		* Returns const value of the end of the list.
+		*/
+		const T& back() const
+		{
+			return *--this->end();
+		}
+
+		/**
+		 * Adds a new element at the front of the list.
+		 *
+		 * @param value the value to add to the list.
+		 */
+		void push_front(const T& value)
+		{
+			this->insert(this->begin(), value);
+		}
+
+		/**
+		 * Adds a new element at the end of the list, after its current last element.
+		 *
+		 * @param value the value to add to the list.
+		 */
+		void push_back(const T& value)
+		{
+			this->insert(this->end(), value);
+		}
+
+		/**
+		 * Adds a new element at the front of the list.
+		 *
+		 * @param value the value to add to the list.
+		 */
+		void push_front(T&& value)
+		{
+			this->insert(this->begin(), std::move(value));
+		}
+
+		/**
+		 * Adds a new element at the end of the list, after its current last element.
+		 *
+		 * @param value the value to add to the list.
+		 */
+		void push_back(T&& value)
+		{
+			this->insert(this->end(), std::move(value));
+		}
+
+		/**
+		 * Erases element at the begining of the list.
+		*/
+		void pop_front()
+		{
+			this->erase(this->begin());
+		}
+
+		/**
+		* Erases element at the end of the list.
+		*/
+		void pop_back()
+		{
+			this->erase(--this->end());
+		}
+
+		/**
+		 * Adds a new node before position. If an equal element is already in the
+		 * list nothing is inserted and an iterator to that element is returned.
+		 * A full list evicts its back element once the new node is built and
+		 * indexed, so an insert that throws evicts nothing.
+		 *
+		 * @param position the node the new node will precede.
+		 * @param value the value to place in the node.
+		 */
+		iterator insert(iterator position, const T& value)
+		{
+			auto existing = this->index.find(std::cref(value));
+			if (existing != this->index.end()) {
+				return iterator(existing->second);
+			} // else, value is new to the list, do_nothing();
+
+			return this->link(position.current, this->pool.create(value));
+		}
+
+		/**
+		 * Adds a new node before position. If an equal element is already in the
+		 * list nothing is inserted and an iterator to that element is returned.
+		 * A full list evicts its back element once the new node is built and
+		 * indexed, so an insert that throws evicts nothing.
+		 *
+		 * @param position the node the new node will precede.
+		 * @param value the value to place in the node.
+		 */
+		iterator insert(iterator position, T&& value)
+		{
+			auto existing = this->index.find(std::cref(value));
+			if (existing != this->index.end()) {
+				return iterator(existing->second);
+			} // else, value is new to the list, do_nothing();
+
+			return this->link(position.current, this->pool.create(std::move(value)));
+		}
+
+		/**
+		 * Isolates and erases a node at a given position.
+		 *
+		 * @param position is the node to be erased.
+		 */
+		iterator erase(iterator position)
+		{
+			auto* current_position = position.current;
+			iterator value(current_position->next);
+			this->index.erase(std::cref(current_position->data));
+			current_position->previous->next = current_position->next;
+			current_position->next->previous = current_position->previous;
+			this->pool.destroy(current_position);
+			this->my_size--;
+			return value;
+		}
+
+		/**
+		 * Isolates and erases a range of nodes.
+		 *
+		 * @param from is the starting position to be erased.
+		 * @param to is the ending position to be erased.
+		 */
+		iterator erase(iterator from, iterator to)
+		{
+			for (auto position = from; position != to;) {
+				position = erase(position);
+			}
+
+			return to;
+		}
+
+		/**
+		 * Locates search key through the index and moves it to the front of list.
+		 *
+		 * @param key is the value to search the list for.
+		 */
+		bool find(const T& key)
+		{
+			auto position = this->index.find(std::cref(key));							// O(1) expected hash lookup.
+			if (position == this->index.end()) {
+				return false;
+			} // else, key is in the list, do_nothing();
+
+			auto* current = position->second;
+			if (current != this->head->next) {
+				this->unlink(current);
+				this->link_before(this->head->next, current);							// Constant time relink.
+			} // else, key is already at the begining of the list. do_nothing();
+			return true;
+		}
+
+		/**
+		 * Returns whether key is in the list without changing the recency order.
+		 *
+		 * @param key is the value to search the list for.
+		 */
+		bool contains(const T& key) const
+		{
+			return this->index.find(std::cref(key)) != this->index.end();
+		}
+
+		friend std::ostream& operator<<(std::ostream& out, const hashed_list& list)
+		{
+			if (list.empty()) {
+				out << "Empty list";
+			}
+			else {
+				for (auto& value : list) {
+					out << value << " ";
+				}
+			}
+
+			return out;
+		}
+
+	private:
+		/**
+		 * The current number of nodes in the list.
+		 */
+		int my_size;
+		/**
+		 * The most nodes the list holds before evicting, 0 for no limit.
+		 */
+		int my_capacity;
+		/**
+		 * Pointer to begining of list.
+		 */
+		node* head;
+		/**
+		 * Pointer to tail of the list.
+		 */
+		node* tail;
+		/**
+		 * Storage for every node of this list, including head and tail.
+		 */
+		node_pool<node> pool;
+		/**
+		 * Maps each element to the node holding it.
+		 */
+		std::unordered_map<key_reference, node*, key_hash, key_equal> index;
+		/**
+		 * Called with each element just before it is evicted.
+		 */
+		eviction_callback on_evict;
+
+		/**
+		* Initialization of list.
+		*/
+		void init()
+		{
+			this->my_size = 0;
+			this->head = this->pool.create();
+			this->tail = this->pool.create();
+			this->head->next = this->tail;
+			this->tail->previous = this->head;
+		}
+
+		/**
+		* Evicts the back node if the list is full.
+		*
+		* @param position the node an insert is about to precede.
+		* @return position, or the node after it if position itself was evicted.
+		*/
+		node* make_room(node* position)
+		{
+			if (this->my_capacity > 0 && this->my_size >= this->my_capacity) {
+				if (position == this->tail->previous) {
+					position = this->tail;
+				} // else, position survives the eviction, do_nothing();
+				this->evict();
+			} // else, there is room for one more node, do_nothing();
+			return position;
+		}
+
+		/**
+		* Reports and erases the back node.
+		*/
+		void evict()
+		{
+			auto* victim = this->tail->previous;
+			if (this->on_evict) {
+				this->on_evict(victim->data);
+			} // else, nobody is listening for evictions, do_nothing();
+			this->erase(iterator(victim));
+		}
+
+		/**
+		* Indexes a new node, makes room for it, and links it in front of
+		* position. If indexing throws, or on_evict does, the node is destroyed
+		* and the list is left as it was.
+		*
+		* @param position the node the new node will precede.
+		* @param created the new node.
+		*/
+		iterator link(node* position, node* created)
+		{
+			try {
+				this->index.emplace(std::cref(created->data), created);
+			}
+			catch (...) {
+				this->pool.destroy(created);
+				throw;
+			}
+			try {
+				position = this->make_room(position);
+			}
+			catch (...) {
+				this->index.erase(std::cref(created->data));
+				this->pool.destroy(created);
+				throw;
+			}
+			this->link_before(position, created);
+			this->my_size++;
+			return iterator(created);
+		}
+
+		/**
+		* Unlinks a node from its neighbours.
+		*/
+		void unlink(node* current)
+		{
+			current->previous->next = current->next;
+			current->next->previous = current->previous;
+		}
+
+		/**
+		* Links a node directly in front of target.
+		*/
+		void link_before(node* target, node* current)
+		{
+			current->previous = target->previous;
+			current->next = target;
+			target->previous->next = current;
+			target->previous = current;
+		}
+	};
+
+}
+
+#endif
@@ -0,0 +1,528 @@
+#ifndef SELF_ADJUSTING_INTRUSIVE_LIST_H
+#define SELF_ADJUSTING_INTRUSIVE_LIST_H
+
+#include <iostream>
+#include <type_traits>
+#include <utility>
+
+namespace nwacc {
+
+	/**
+	 * The links an object needs to be an element of an intrusive_list.
+	 *
+	 * Derive from it once per list the object can be in at the same time,
+	 * telling the hooks apart with Tag:
+	 *
+	 *     struct session : intrusive_list_hook<by_recency>, intrusive_list_hook<by_owner> { ... };
+	 *
+	 * Copying an object does not copy its links; the copy starts unlinked.
+	 * An object must be erased from its list before it is destroyed.
+	 *
+	 * @param Tag any type naming the list this hook belongs to.
+	 */
+	template <typename Tag = void>
+	class intrusive_list_hook {
+	public:
+		intrusive_list_hook() : previous{ nullptr }, next{ nullptr }
+		{ }
+
+		intrusive_list_hook(const intrusive_list_hook&) : intrusive_list_hook()
+		{ }
+
+		intrusive_list_hook& operator=(const intrusive_list_hook&)
+		{
+			return *this;
+		}
+
+		/**
+		 * Returns whether the object is currently in a list through this hook.
+		 */
+		bool is_linked() const
+		{
+			return this->next != nullptr;
+		}
+
+	private:
+		intrusive_list_hook* previous;
+
+		intrusive_list_hook* next;
+
+		template <typename T, typename ListTag>
+		friend class intrusive_list;
+	};
+
+	/**
+	 * Move-to-front doubly linked list of objects it does not own.
+	 *
+	 * The links live in the objects themselves (see intrusive_list_hook), so
+	 * insert, erase and promotion never allocate or copy, and an object can be
+	 * erased in constant time given only a reference to it. The list never
+	 * creates or destroys objects; clearing or destroying it only unlinks them.
+	 *
+	 * @param T the object type, which derives from intrusive_list_hook<Tag>.
+	 * @param Tag which of the hooks of T this list uses.
+	 */
+	template <typename T, typename Tag = void>
+	class intrusive_list {
+	private:
+		typedef intrusive_list_hook<Tag> hook;
+
+		static_assert(std::is_base_of<hook, T>::value, "T must derive from intrusive_list_hook<Tag>");
+
+	public:
+		class const_iterator {
+		public:
+
+			/**
+			 * Constructor for const iterator.
+			 */
+			const_iterator() : current{ nullptr }
+			{ }
+			/**
+			 * Returns the object at the current position.
+			*/
+			const T& operator*() const
+			{
+				return this->retrieve();
+			}
+			/**
+			 * Returns a pointer to the object at the current position.
+			*/
+			const T* operator->() const
+			{
+				return &this->retrieve();
+			}
+			/**
+			 * Overload of ++ operator to work with const iterator.
+			*/
+			const_iterator& operator++()
+			{
+				this->current = this->current->next;
+				return *this;
+			}
+			/**
+			 * Overload of ++ operator to work with const iterator.
+			*/
+			const_iterator operator++(int)
+			{
+				auto old = *this;
+				++(*this);
+				return old;
+			}
+			/**
+			 * Overload of -- operator to work with const iterator.
+			*/
+			const_iterator& operator--()
+			{
+				this->current = this->current->previous;
+				return *this;
+			}
+			/**
+			 * Overload of -- operator to work with const iterator.
+			*/
+			const_iterator operator--(int)
+			{
+				auto old = *this;
+				--(*this);
+				return old;
+			}
+			/**
+			 * Overload of == operator for comparison.
+			*/
+			bool operator==(const const_iterator& rhs) const
+			{
+				return this->current == rhs.current;
+			}
+			/**
+			 * Overload of != operator for comparison.
+			*/
+			bool operator!=(const const_iterator& rhs) const
+			{
+				return !(*this == rhs);
+			}
+
+		protected:
+			hook* current;
+
+			// Protected helper in const_iterator that returns the object
+			// at the current position.
+			T& retrieve() const
+			{
+				return object_of(this->current);
+			}
+
+			// Protected constructor for const_iterator.
+			// Expects a pointer that represents the current position.
+			const_iterator(hook* position) : current{ position }
+			{ }
+
+			friend class intrusive_list<T, Tag>;
+		};
+
+		class iterator : public const_iterator {
+		public:
+
+			// Public constructor for iterator.
+			iterator()
+			{ }
+
+			T& operator*() const
+			{
+				return const_iterator::retrieve();
+			}
+			/**
+			 * Returns a pointer to the object at the current position.
+			 */
+			T* operator->() const
+			{
+				return &const_iterator::retrieve();
+			}
+			/**
+			 * Overloaded ++ operator to work with iterator.
+			 */
+			iterator& operator++()
+			{
+				this->current = this->current->next;
+				return *this;
+			}
+			/**
+			 * Overloaded ++ operator to work with iterator.
+			 */
+			iterator operator++(int)
+			{
+				auto old = *this;
+				++(*this);
+				return old;
+			}
+			/**
+			 * Overloaded -- operator to work with iterator.
+			 */
+			iterator& operator--()
+			{
+				this->current = this->current->previous;
+				return *this;
+			}
+			/**
+			 * Overloaded -- operator to work with iterator.
+			 */
+			iterator operator--(int)
+			{
+				auto old = *this;
+				--(*this);
+				return old;
+			}
+
+		protected:
+			// Protected constructor for iterator.
+			// Expects the current position.
+			iterator(hook* position) : const_iterator{ position }
+			{ }
+
+			friend class intrusive_list<T, Tag>;
+		};
+
+	public:
+		intrusive_list() : my_size{ 0 }
+		{
+			this->root.previous = this->root.next = &this->root;
+		}
+
+		/**
+		 * Unlinks every object. The objects themselves are left alone.
+		 */
+		~intrusive_list()
+		{
+			this->clear();
+		}
+
+		/**
+		 * An object can be in only one list per hook, so lists cannot be copied.
+		 */
+		intrusive_list(const intrusive_list&) = delete;
+
+		intrusive_list& operator=(const intrusive_list&) = delete;
+
+		/**
+		 * Takes every object from rhs, leaving rhs empty.
+		 *
+		 * @param rhs the list to take from.
+		 */
+		intrusive_list(intrusive_list&& rhs) : intrusive_list()
+		{
+			this->take(rhs);
+		}
+
+		/**
+		 * Unlinks the objects of this list and takes every object from rhs.
+		 *
+		 * @param rhs the list to take from.
+		 */
+		intrusive_list& operator=(intrusive_list&& rhs)
+		{
+			if (this != &rhs) {
+				this->clear();
+				this->take(rhs);
+			} // else, self assignment, do_nothing();
+			return *this;
+		}
+
+		/**
+		 * Return iterator representing beginning of list
+		 */
+		iterator begin()
+		{
+			return iterator(this->root.next);
+		}
+
+		/**
+		 * Return iterator representing beginning of list
+		 */
+		const_iterator begin() const
+		{
+			return const_iterator(this->root.next);
+		}
+
+		/**
+		 * Return iterator representing end marker of list
+		 */
+		iterator end()
+		{
+			return iterator(&this->root);
+		}
+		/**
+		* Returns a const_iterator to the end marker of the list.
+		*/
+		const_iterator end() const
+		{
+			return const_iterator(const_cast<hook*>(&this->root));
+		}
+
+		/**
+		* Returns size of the list.
+		*/
+		int size() const
+		{
+			return this->my_size;
+		}
+		/**
+		* Checks if list is empty.
+		*/
+		bool empty() const
+		{
+			return this->size() == 0;
+		}
+		/**
+		* Unlinks every object, leaving each one free to join another list.
+		*/
+		void clear()
+		{
+			auto* current = this->root.next;
+			while (current != &this->root) {
+				auto* next = current->next;
+				current->previous = current->next = nullptr;
+				current = next;
+			}
+			this->root.previous = this->root.next = &this->root;
+			this->my_size = 0;
+		}
+
+		// front, back, push_front, push_back, pop_front, and pop_back
+		// are the basic double-ended queue operations.
+		T& front()
+		{
+			return *this->begin();
+		}
+		/**
+		* Returns the object at the begining of the list.
+		*/
+		const T& front() const
+		{
+			return *this->begin();
+		}
+		/**
+		* Returns the object at the end of the list.
+		*/
+		T& back()
+		{
+			return *--this->end();
+		}
+		/**
+		* Returns the object at the end of the list.
+		*/
+		const T& back() const
+		{
+			return *--this->end();
+		}
+		/**
+		 * Links object at the front of the list.
+		 *
+		 * @param object an object that is not in a list through this hook.
+		 */
+		void push_front(T& object)
+		{
+			this->insert(this->begin(), object);
+		}
+		/**
+		 * Links object at the end of the list.
+		 *
+		 * @param object an object that is not in a list through this hook.
+		 */
+		void push_back(T& object)
+		{
+			this->insert(this->end(), object);
+		}
+		/**
+		 * Unlinks the object at the begining of the list.
+		*/
+		void pop_front()
+		{
+			this->erase(this->begin());
+		}
+		/**
+		* Unlinks the object at the end of the list.
+		*/
+		void pop_back()
+		{
+			this->erase(--this->end());
+		}
+		/**
+		 * Links object in front of position. Nothing is allocated or copied.
+		 *
+		 * @param position the element to insert in front of.
+		 * @param object an object that is not in a list through this hook.
+		 * @return an iterator to object.
+		 */
+		iterator insert(iterator position, T& object)
+		{
+			auto* current = static_cast<hook*>(&object);
+			link_before(current, position.current);
+			this->my_size++;
+			return iterator(current);
+		}
+		/**
+		 * Unlinks the object at position.
+		 *
+		 * @param position the object to unlink.
+		 * @return an iterator to the object that followed it.
+		 */
+		iterator erase(iterator position)
+		{
+			iterator following(position.current->next);
+			this->erase(position.retrieve());
+			return following;
+		}
+		/**
+		 * Unlinks object in constant time, without searching for it.
+		 *
+		 * @param object an object in this list.
+		 */
+		void erase(T& object)
+		{
+			auto* current = static_cast<hook*>(&object);
+			unlink(current);
+			current->previous = current->next = nullptr;
+			this->my_size--;
+		}
+		/**
+		 * Locates the first object equal to key and moves it to the front of list.
+		 *
+		 * @param key is compared with each object through operator==.
+		 * @return the object found, or nullptr.
+		 */
+		template <typename Key>
+		T* find(const Key& key)
+		{
+			return this->find_if([&key](const T& object) { return object == key; });
+		}
+		/**
+		 * Locates the first object matching predicate and moves it to the front of list.
+		 *
+		 * @param predicate called with each object from front to back until it returns true.
+		 * @return the object found, or nullptr.
+		 */
+		template <typename Predicate>
+		T* find_if(Predicate predicate)
+		{
+			for (auto* current = this->root.next; current != &this->root; current = current->next) {	// O(n) due to search n times.
+				if (predicate(static_cast<const T&>(object_of(current)))) {
+					if (current != this->root.next) {
+						unlink(current);
+						link_before(current, this->root.next);										// Constant time relink, nothing is copied.
+					} // else, current is already at the front, do_nothing();
+					return &object_of(current);
+				} // else, keep walking, do_nothing();
+			}
+			return nullptr;
+		}																							// Method has an overall O(n) run-time.
+
+		friend std::ostream& operator<<(std::ostream& out, const intrusive_list& list)
+		{
+			if (list.empty()) {
+				out << "Empty list";
+			}
+			else {
+				for (auto& object : list) {
+					out << object << " ";
+				}
+			}
+
+			return out;
+		}
+
+	private:
+		/**
+		 * The end marker: root.next is the first object and root.previous the last.
+		 */
+		hook root;
+		/**
+		 * The current number of objects in the list.
+		 */
+		int my_size;
+
+		static T& object_of(hook* current)
+		{
+			return static_cast<T&>(*current);
+		}
+
+		/**
+		* Links current directly in front of next.
+		*/
+		static void link_before(hook* current, hook* next)
+		{
+			current->previous = next->previous;
+			current->next = next;
+			next->previous->next = current;
+			next->previous = current;
+		}
+
+		/**
+		* Bypasses current, leaving its own links untouched.
+		*/
+		static void unlink(hook* current)
+		{
+			current->previous->next = current->next;
+			current->next->previous = current->previous;
+		}
+
+		/**
+		* Moves every object from rhs into this empty list, leaving rhs empty.
+		*/
+		void take(intrusive_list& rhs)
+		{
+			if (rhs.empty()) {
+				return;
+			} // else, re-point the first and last objects at our root, do_nothing();
+
+			this->root.next = rhs.root.next;
+			this->root.previous = rhs.root.previous;
+			this->root.next->previous = &this->root;
+			this->root.previous->next = &this->root;
+			this->my_size = rhs.my_size;
+			rhs.root.previous = rhs.root.next = &rhs.root;
+			rhs.my_size = 0;
+		}
+	};
+
+}
+
+#endif
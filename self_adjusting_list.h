@@ -1,478 +1,1545 @@
-#ifndef SELF_ADJUSTING_LIST_H
-#define SELF_ADJUSTING_LIST_H
-
-#include <algorithm>
-#include <iostream>
-
-namespace nwacc {
-	template <typename T>
-	class linked_list {
-	private:
-		/**
-		 * Constructs a node struct to create a doubly linked list.
-		 */
-		struct node {
-
-			T data;
-
-			node* previous;
-
-			node* next;
-
-			node(const T& data = T{ }, node* previous = nullptr, node* next = nullptr)
-				: data{ data }, previous{ previous }, next{ next } { }
-
-			node(T&& data, node* previous = nullptr, node* next = nullptr)
-				: data{ std::move(data) }, previous{ previous }, next{ next } { }
-		};
-
-	public:
-		class const_iterator {
-		public:
-
-			/**
-			 * Constructor for const iterator.
-			 */
-			const_iterator() : current{ nullptr }
-			{ }
-			/**
-			 * Returns the T stored at the current position.
-			*/
-			const T& operator*() const
-			{
-				return this->retrieve();
-			}
-			/**
-			 * Overload of ++ operator to work with const iterator.
-			*/
-			const_iterator& operator++()
-			{
-				// remember we have value++ and ++value
-				// We have two method for pre or post increment.
-				this->current = this->current->next;
-				return *this;
-			}
-			/**
-			 * Overload of ++ operator to work with const iterator.
-			*/
-			const_iterator operator++(int)
-			{
-				auto old = *this;
-				++(*this);
-				return old;
-			}
-			/**
-			 * Overload of -- operator to work with const iterator.
-			*/
-			const_iterator& operator--()
-			{
-				this->current = this->current->previous;
-				return *this;
-			}
-			/**
-			 * Overload of -- operator to work with const iterator.
-			*/
-			const_iterator operator--(int)
-			{
-				auto old = *this;
-				--(*this);
-				return old;
-			}
-			/**
-			 * Overload of == operator for comparison.
-			*/
-			bool operator==(const const_iterator& rhs) const
-			{
-				return this->current == rhs.current;
-			}
-			/**
-			 * Overload of != operator for comparison.
-			*/
-			bool operator!=(const const_iterator& rhs) const
-			{
-				return !(*this == rhs);
-			}
-
-		protected:
-			node* current;
-
-			// Protected helper in const_iterator that returns the T
-			// stored at the current position. Can be called by all
-			// three versions of operator* without any type conversions.
-			T& retrieve() const
-			{
-				return this->current->data;
-			}
-
-			// Protected constructor for const_iterator.
-			// Expects a pointer that represents the current position.
-			const_iterator(node* position) : current{ position }
-			{ }
-
-			friend class linked_list<T>;
-		};
-
-		class iterator : public const_iterator {
-		public:
-
-			// Public constructor for iterator.
-			iterator()
-			{ }
-
-			T& operator*()
-			{
-				return const_iterator::retrieve();
-			}
-			/**
-			 * Return the T stored at the current position.
-			 */
-			const T& operator*() const
-			{
-				return const_iterator::operator*();
-			}
-			/**
-			 * Overloaded ++ operator to work with iterator.
-			 */
-			iterator& operator++()
-			{
-				this->current = this->current->next;
-				return *this;
-			}
-			/**
-			 * Overloaded ++ operator to work with iterator.
-			 */
-			iterator operator++(int)
-			{
-				auto old = *this;
-				++(*this);
-				return old;
-			}
-			/**
-			 * Overloaded -- operator to work with iterator.
-			 */
-			iterator& operator--()
-			{
-				this->current = this->current->previous;
-				return *this;
-			}
-			/**
-			 * Overloaded -- operator to work with iterator.
-			 */
-			iterator operator--(int)
-			{
-				auto old = *this;
-				--(*this);
-				return old;
-			}
-
-		protected:
-			// Protected constructor for iterator.
-			// Expects the current position.
-			iterator(node* position) : const_iterator{ position }
-			{ }
-
-			friend class linked_list<T>;
-		};
-
-	public:
-		linked_list()
-		{
-			this->init();
-		}
-
-		~linked_list()
-		{
-			this->clear();
-			delete this->head;
-			delete this->tail;
-		}
-		/**
-		 *.
-		*/
-		linked_list(const linked_list& rhs)
-		{
-			this->init();
-			// Notice here, I can use a foreach loop because I have an iterator!
-			for (auto& value : rhs) {
-				this->push_back(value);
-			}
-		}
-
-		linked_list& operator=(const linked_list& rhs)
-		{
-			auto copy = rhs;
-			std::swap(*this, copy);
-			return *this;
-		}
-
-		linked_list(linked_list&& rhs)
-			: my_size{ rhs.my_size }, head{ rhs.head }, tail{ rhs.tail }
-		{
-			rhs.my_size = 0;
-			rhs.head = nullptr;
-			rhs.tail = nullptr;
-		}
-
-		linked_list& operator=(linked_list&& rhs)
-		{
-			std::swap(this->my_size, rhs.my_size);
-			std::swap(this->head, rhs.head);
-			std::swap(this->tail, rhs.tail);
-			return *this;
-		}
-
-		/**
-		 * Return iterator representing beginning of list
-		 */
-		iterator begin()
-		{
-			return iterator(this->head->next);
-		}
-
-		/**
-		 * Return iterator representing beginning of list
-		 */
-		const_iterator begin() const
-		{
-			return const_iterator(this->head->next);
-		}
-
-		/**
-		 * Return iterator representing end marker of list
-		 */
-		iterator end()
-		{
-			// This is a C++ thing. Begin in c++ starts always
-			// at the first element with a value.
-			// end always ends after the last element. 
-			return iterator(this->tail);
-		}
-		/**
-		* Returns a const_iterator to the tial of the list.
-		*/
-		const_iterator end() const
-		{
-			return const_iterator(this->tail);
-		}
-
-		/**
-		* Returns size of the list.
-		*/
-		int size() const
-		{
-			return this->my_size;
-		}
-		/**
-		* Checks if list is empty.
-		*/
-		bool empty() const
-		{
-			return this->size() == 0;
-		}
-		/**
-		* Clears the list.
-		*/
-		void clear()
-		{
-			while (!this->empty()) {
-				this->pop_front();
-			}
-		}
-
-		// front, back, push_front, push_back, pop_front, and pop_back
-		// are the basic double-ended queue operations.
-		T& front()
-		{
-			return *this->begin();
-		}
-		/**
-		* Returns value of the begining of the list.
-		*/
-		const T& front() const
-		{
-			return *this->begin();
-		}
-		/**
-		* Returns value of the end of the list.
-		*/
-		T& back()
-		{
-			return *--this->end();
-		}
-		/**
-		* Returns const value of the end of the list.
-		*/
-		const T& back() const
-		{
-			return *--this->end();
-		}
-		/**
-		 * Adds a new element at the end of the list, after its current last element.
-		 *
-		 * @param value the value to add to the list.
-		 */
-		void push_front(const T& value)
-		{
-			this->insert(this->begin(), value);
-		}
-		/**
-		 * Adds a new element at the end of the list, after its current last element.
-		 *
-		 * @param value the value to add to the list.
-		 */
-		void push_back(const T& value)
-		{
-			// Remember, we are inserting BEFORE the given iterator, so end here is fine. 
-			this->insert(this->end(), value);
-		}
-		/**
-		 * Adds a new element at the front of the list.
-		 *
-		 * @param value the value to add to the list.
-		*/
-		void push_front(T&& value)
-		{
-			this->insert(this->begin(), std::move(value));
-		}
-		/**
-		 * Adds a new element at the end of the list, after its current last element.
-		 *
-		* @param value the value to add to the list.
-		*/
-		void push_back(T&& value)
-		{
-			this->insert(this->end(), std::move(value));
-		}
-		/**
-		 * Erases element at the begining of the list.
-		*/
-		void pop_front()
-		{
-			this->erase(this->begin());
-		}
-		/**
-		* Erases element at the end of the list.
-		*/
-		void pop_back()
-		{
-			this->erase(--this->end());
-		}
-		/**
-		 * Adds a new node at the end of the list, after its current node.
-		 *
-		 * @param value the value to place in the node.
-		 */	
-		iterator insert(iterator position, const T& value)
-		{
-			// I need the current node in the iterator.
-			// This is a pointer to the node of the iterator. 
-			auto* current_node = position.current;
-			this->my_size++;
-			return  iterator(
-				current_node->previous = current_node->previous->next =
-				new node{ value, current_node->previous, current_node });
-		}
-		/**
-		 * Adds a new node at the end of the list, after its current node.
-		 *
-		 * @param value the value to place in the node.
-		 */
-		iterator insert(iterator position, T&& value)
-		{
-			auto* current_position = position.current;
-			this->my_size++;
-			return iterator(current_position->previous = current_position->previous->next =
-				new node{ std::move(value), current_position->previous, current_position });
-
-		}
-		/**
-		 * Isolates and erases a node at a given position.
-		 *
-		 * @param position is the node to be erased.
-		 */
-		iterator erase(iterator position)
-		{
-			auto* current_position = position.current;
-			iterator value(current_position->next);
-			current_position->previous->next = current_position->next;
-			current_position->next->previous = current_position->previous;
-			// Now I have isolated current position
-			delete current_position;
-			this->my_size--;
-			return value;
-		}
-		/**
-		 * Isolates and erases a range of nodes.
-		 *
-		 * @param from is the starting position to be erased.
-		 * @param to is the ending position to be erased.
-		 */
-		iterator erase(iterator from, iterator to)
-		{
-			for (auto position = from; position != to;) {
-				position = erase(position);
-			}
-
-			return to;
-		}
-		/**
-		 * Locates search key and moves it to the front of list.
-		 *
-		 * @param key is the value to search the list for.
-		 */
-		bool find(T key)
-		{
-			for (auto position = begin(); position != end(); position++) {					// O(n) due to search n times.
-				if (*position == key)
-				{
-					push_front(*position);													// Constant time insertion operation.
-					erase(position);														// Constant time erasure operation.
-					return true;
-				} // else, key is already at the begining of the list. do_nothing();
-			}
-			return false;
-		}																					// Method has an overall O(n) run-time.
-
-		friend std::ostream& operator<<(std::ostream& out, const linked_list& list)
-		{
-			if (list.empty()) {
-				out << "Empty list";
-			}
-			else {
-				for (auto& value : list) {
-					out << value << " ";
-				}
-			}
-
-			return out;
-		}
-
-	private:
-		/**
-		 * The current number of nodes in the list.
-		 */
-		int my_size;
-		/**
-		 * Pointer to begining of list.
-		 */
-		node* head;
-		/**
-		 * Pointer to tail of the list.
-		 */
-		node* tail;
-
-		/**
-		* Initialization of list.
-		*/
-		void init()
-		{
-			this->my_size = 0;
-			this->head = new node;
-			this->tail = new node;
-			this->head->next = this->tail;
-			this->tail->previous = this->head;
-		}
-	};
-
-}
-#endif
+#ifndef SELF_ADJUSTING_LIST_H
+#define SELF_ADJUSTING_LIST_H
+
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <initializer_list>
+#include <iostream>
+#include <iterator>
+#include <memory>
+#include <memory_resource>
+#include <string>
+#include <type_traits>
+
+#if defined(_MSC_VER)
+#include <xmmintrin.h>
+#endif
+
+#include "access_stats.h"
+#include "adjustment_policy.h"
+#include "allocator_support.h"
+#include "node_pool.h"
+#include "promotion_buffer.h"
+#include "snapshot.h"
+
+namespace nwacc {
+
+	namespace detail {
+
+		/**
+		 * Enables an overload only for types that are input iterators, so a
+		 * range constructor is never picked for two values of another type.
+		 */
+		template <typename InputIt>
+		using require_input_iterator = typename std::enable_if<std::is_convertible<
+			typename std::iterator_traits<InputIt>::iterator_category, std::input_iterator_tag>::value>::type;
+
+	}
+
+	/**
+	 * Doubly linked list whose find moves the found element forward.
+	 *
+	 * Nodes come from a node_pool whose slabs come from Allocator, which may
+	 * be std::pmr::polymorphic_allocator (see nwacc::pmr::linked_list) to put
+	 * a list on a memory resource, e.g. a monotonic buffer on the stack.
+	 * Copies, moves and assignments follow the allocator's propagation
+	 * traits the way the standard containers do.
+	 *
+	 * @param T the element type.
+	 * @param Policy how find reorganizes the list (see adjustment_policy.h).
+	 * @param Stats what find records about itself, nothing by default (see access_stats.h).
+	 * @param Allocator the allocator for the elements, rebound to allocate nodes.
+	 */
+	template <typename T, typename Policy = move_to_front, typename Stats = no_stats, typename Allocator = std::allocator<T>>
+	class linked_list {
+
+		static_assert(std::is_same<typename std::allocator_traits<Allocator>::value_type, T>::value,
+			"linked_list requires an allocator whose value_type is T");
+
+	private:
+		/**
+		 * Constructs a node struct to create a doubly linked list.
+		 * Nodes carry an access counter only when Policy counts accesses.
+		 *
+		 * A node is allocator aware so that std::pmr::polymorphic_allocator
+		 * builds it through the std::allocator_arg constructors, which hand
+		 * the allocator on to an allocator aware T such as std::pmr::string.
+		 */
+		struct node : detail::node_access_count<Policy::k_counts_accesses> {
+
+			typedef Allocator allocator_type;
+
+			T data;
+
+			node* previous;
+
+			node* next;
+
+			node(const T& data = T{ }, node* previous = nullptr, node* next = nullptr)
+				: data{ data }, previous{ previous }, next{ next } { }
+
+			node(T&& data, node* previous = nullptr, node* next = nullptr)
+				: data{ std::move(data) }, previous{ previous }, next{ next } { }
+
+			node(std::allocator_arg_t, const allocator_type& allocator)
+				: data(detail::make_using_allocator<T>(allocator)), previous{ nullptr }, next{ nullptr } { }
+
+			template <typename Value>
+			node(std::allocator_arg_t, const allocator_type& allocator, Value&& data, node* previous, node* next)
+				: data(detail::make_using_allocator<T>(allocator, std::forward<Value>(data))), previous{ previous }, next{ next } { }
+		};
+
+		typedef std::allocator_traits<Allocator> allocator_traits;
+
+		typedef detail::rebind_allocator<Allocator, node> node_allocator;
+
+	public:
+		class const_iterator {
+		public:
+			typedef std::bidirectional_iterator_tag iterator_category;
+			typedef T value_type;
+			typedef std::ptrdiff_t difference_type;
+			typedef const T* pointer;
+			typedef const T& reference;
+
+			/**
+			 * Constructor for const iterator.
+			 */
+			const_iterator() : current{ nullptr }
+			{ }
+			/**
+			 * Returns the T stored at the current position.
+			*/
+			const T& operator*() const
+			{
+				return this->retrieve();
+			}
+			/**
+			 * Overload of ++ operator to work with const iterator.
+			*/
+			const_iterator& operator++()
+			{
+				// remember we have value++ and ++value
+				// We have two method for pre or post increment.
+				this->current = this->current->next;
+				return *this;
+			}
+			/**
+			 * Overload of ++ operator to work with const iterator.
+			*/
+			const_iterator operator++(int)
+			{
+				auto old = *this;
+				++(*this);
+				return old;
+			}
+			/**
+			 * Overload of -- operator to work with const iterator.
+			*/
+			const_iterator& operator--()
+			{
+				this->current = this->current->previous;
+				return *this;
+			}
+			/**
+			 * Overload of -- operator to work with const iterator.
+			*/
+			const_iterator operator--(int)
+			{
+				auto old = *this;
+				--(*this);
+				return old;
+			}
+			/**
+			 * Overload of == operator for comparison.
+			*/
+			bool operator==(const const_iterator& rhs) const
+			{
+				return this->current == rhs.current;
+			}
+			/**
+			 * Overload of != operator for comparison.
+			*/
+			bool operator!=(const const_iterator& rhs) const
+			{
+				return !(*this == rhs);
+			}
+
+		protected:
+			node* current;
+
+			// Protected helper in const_iterator that returns the T
+			// stored at the current position. Can be called by all
+			// three versions of operator* without any type conversions.
+			T& retrieve() const
+			{
+				return this->current->data;
+			}
+
+			// Protected constructor for const_iterator.
+			// Expects a pointer that represents the current position.
+			const_iterator(node* position) : current{ position }
+			{ }
+
+			friend class linked_list;
+		};
+
+		class iterator : public const_iterator {
+		public:
+			typedef T* pointer;
+			typedef T& reference;
+
+			// Public constructor for iterator.
+			iterator()
+			{ }
+
+			T& operator*()
+			{
+				return const_iterator::retrieve();
+			}
+			/**
+			 * Return the T stored at the current position.
+			 */
+			const T& operator*() const
+			{
+				return const_iterator::operator*();
+			}
+			/**
+			 * Overloaded ++ operator to work with iterator.
+			 */
+			iterator& operator++()
+			{
+				this->current = this->current->next;
+				return *this;
+			}
+			/**
+			 * Overloaded ++ operator to work with iterator.
+			 */
+			iterator operator++(int)
+			{
+				auto old = *this;
+				++(*this);
+				return old;
+			}
+			/**
+			 * Overloaded -- operator to work with iterator.
+			 */
+			iterator& operator--()
+			{
+				this->current = this->current->previous;
+				return *this;
+			}
+			/**
+			 * Overloaded -- operator to work with iterator.
+			 */
+			iterator operator--(int)
+			{
+				auto old = *this;
+				--(*this);
+				return old;
+			}
+
+		protected:
+			// Protected constructor for iterator.
+			// Expects the current position.
+			iterator(node* position) : const_iterator{ position }
+			{ }
+
+			friend class linked_list;
+		};
+
+	public:
+		typedef Allocator allocator_type;
+
+		linked_list()
+		{
+			this->init();
+		}
+
+		/**
+		 * Constructs an empty list whose nodes come from allocator.
+		 *
+		 * @param allocator the allocator the nodes will come from.
+		 */
+		explicit linked_list(const Allocator& allocator) : pool{ node_allocator(allocator) }
+		{
+			this->init();
+		}
+
+		/**
+		 * Constructs a list holding the elements of [first, last), in order.
+		 * The nodes are allocated together, see insert(position, first, last).
+		 *
+		 * @param first the first element to copy.
+		 * @param last the end of the range.
+		 * @param allocator the allocator the nodes will come from.
+		 */
+		template <typename InputIt, typename = detail::require_input_iterator<InputIt>>
+		linked_list(InputIt first, InputIt last, const Allocator& allocator = Allocator()) : linked_list(allocator)
+		{
+			this->insert(this->end(), first, last);
+		}
+
+		/**
+		 * Constructs a list holding values, in order.
+		 *
+		 * @param values the elements of the new list.
+		 * @param allocator the allocator the nodes will come from.
+		 */
+		linked_list(std::initializer_list<T> values, const Allocator& allocator = Allocator()) :
+			linked_list(values.begin(), values.end(), allocator)
+		{ }
+
+		~linked_list()
+		{
+			if (this->head != nullptr) {
+				this->clear();
+				this->pool.destroy(this->head);
+				this->pool.destroy(this->tail);
+			} // else, this list was moved from and owns no nodes, do_nothing();
+		}
+		/**
+		 *.
+		*/
+		linked_list(const linked_list& rhs) :
+			linked_list(rhs, allocator_traits::select_on_container_copy_construction(rhs.get_allocator()))
+		{ }
+
+		/**
+		 * Constructs a copy of rhs whose nodes come from allocator.
+		 *
+		 * @param rhs the list to copy.
+		 * @param allocator the allocator the nodes will come from.
+		 */
+		linked_list(const linked_list& rhs, const Allocator& allocator) :
+			pool{ node_allocator(allocator) }, stats{ rhs.stats }
+		{
+			this->init();
+			// Deferred hits refer to the nodes of rhs, so only the batch size is copied.
+			this->pending.set_batch_size(rhs.pending.batch_size());
+			this->insert(this->end(), rhs.begin(), rhs.end());
+		}
+
+		/**
+		 * Replaces the contents of this list with a copy of rhs. The allocator
+		 * is replaced too when it propagates on copy assignment.
+		 */
+		linked_list& operator=(const linked_list& rhs)
+		{
+			if (this == &rhs) {
+				return *this;
+			} // else, there is something to copy, do_nothing();
+
+			linked_list copy(rhs, allocator_traits::propagate_on_container_copy_assignment::value ? rhs.get_allocator() : this->get_allocator());
+			this->exchange(copy);
+			return *this;
+		}
+
+		linked_list(linked_list&& rhs)
+			: my_size{ rhs.my_size }, head{ rhs.head }, tail{ rhs.tail }, pool{ std::move(rhs.pool) }
+		{
+			this->pending.swap(rhs.pending);
+			std::swap(this->stats, rhs.stats);
+			rhs.my_size = 0;
+			rhs.head = nullptr;
+			rhs.tail = nullptr;
+		}
+
+		/**
+		 * Constructs a list from rhs whose nodes come from allocator. The nodes
+		 * of rhs are taken when allocator compares equal to its own, otherwise
+		 * the elements, and their counters, are moved over one by one.
+		 *
+		 * @param rhs the list to move from.
+		 * @param allocator the allocator the nodes will come from.
+		 */
+		linked_list(linked_list&& rhs, const Allocator& allocator) : linked_list(allocator)
+		{
+			if (this->can_adopt(rhs)) {
+				this->exchange(rhs);
+				return;
+			} // else, only the allocator of rhs can free its nodes, do_nothing();
+
+			// Deferred hits refer to the nodes of rhs, apply them before the order is copied.
+			rhs.flush_promotions();
+			this->pending.set_batch_size(rhs.pending.batch_size());
+			std::swap(this->stats, rhs.stats);
+			this->pool.reserve(rhs.my_size);
+			auto* source = rhs.head->next;
+			this->insert_nodes(this->end(), [this, &source, &rhs](node* previous) -> node* {
+				if (source == rhs.tail) {
+					return nullptr;
+				} // else, there is another element to move, do_nothing();
+
+				auto* created = this->pool.create(std::move(source->data), previous, nullptr);
+				if constexpr (Policy::k_counts_accesses) {
+					created->count = source->count;
+				} // else, the nodes have no counters, do_nothing();
+				source = source->next;
+				return created;
+			});
+		}
+
+		/**
+		 * Replaces the contents of this list with those of rhs. When the
+		 * allocator does not propagate on move assignment and differs from the
+		 * one of rhs, the elements are moved one by one into this list's nodes instead.
+		 */
+		linked_list& operator=(linked_list&& rhs)
+		{
+			if constexpr (!allocator_traits::propagate_on_container_move_assignment::value && !allocator_traits::is_always_equal::value) {
+				if (this->get_allocator() != rhs.get_allocator()) {
+					linked_list moved(std::move(rhs), this->get_allocator());
+					this->exchange(moved);
+					return *this;
+				} // else, the nodes of rhs can be taken as is, do_nothing();
+			} // else, the allocator goes with the nodes, do_nothing();
+
+			this->exchange(rhs);
+			return *this;
+		}
+
+		/**
+		 * Returns a copy of the allocator the nodes come from.
+		 */
+		allocator_type get_allocator() const
+		{
+			return allocator_type(this->pool.get_allocator());
+		}
+
+		/**
+		 * Return iterator representing beginning of list
+		 */
+		iterator begin()
+		{
+			return iterator(this->head->next);
+		}
+
+		/**
+		 * Return iterator representing beginning of list
+		 */
+		const_iterator begin() const
+		{
+			return const_iterator(this->head->next);
+		}
+
+		/**
+		 * Return iterator representing end marker of list
+		 */
+		iterator end()
+		{
+			// This is a C++ thing. Begin in c++ starts always
+			// at the first element with a value.
+			// end always ends after the last element. 
+			return iterator(this->tail);
+		}
+		/**
+		* Returns a const_iterator to the tial of the list.
+		*/
+		const_iterator end() const
+		{
+			return const_iterator(this->tail);
+		}
+
+		/**
+		* Returns size of the list.
+		*/
+		int size() const
+		{
+			return this->my_size;
+		}
+		/**
+		* Checks if list is empty.
+		*/
+		bool empty() const
+		{
+			return this->size() == 0;
+		}
+		/**
+		* Clears the list. The nodes go back to the pool for reuse.
+		*/
+		void clear()
+		{
+			this->pending.clear();
+			auto* current = this->head->next;
+			while (current != this->tail) {
+				auto* next = current->next;
+				this->pool.destroy(current);
+				current = next;
+			}
+			this->head->next = this->tail;
+			this->tail->previous = this->head;
+			this->my_size = 0;
+		}
+
+		// front, back, push_front, push_back, pop_front, and pop_back
+		// are the basic double-ended queue operations.
+		T& front()
+		{
+			return *this->begin();
+		}
+		/**
+		* Returns value of the begining of the list.
+		*/
+		const T& front() const
+		{
+			return *this->begin();
+		}
+		/**
+		* Returns value of the end of the list.
+		*/
+		T& back()
+		{
+			return *--this->end();
+		}
+		/**
+		* Returns const value of the end of the list.
+		*/
+		const T& back() const
+		{
+			return *--this->end();
+		}
+		/**
+		 * Adds a new element at the end of the list, after its current last element.
+		 *
+		 * @param value the value to add to the list.
+		 */
+		void push_front(const T& value)
+		{
+			this->insert(this->begin(), value);
+		}
+		/**
+		 * Adds a new element at the end of the list, after its current last element.
+		 *
+		 * @param value the value to add to the list.
+		 */
+		void push_back(const T& value)
+		{
+			// Remember, we are inserting BEFORE the given iterator, so end here is fine. 
+			this->insert(this->end(), value);
+		}
+		/**
+		 * Adds a new element at the front of the list.
+		 *
+		 * @param value the value to add to the list.
+		*/
+		void push_front(T&& value)
+		{
+			this->insert(this->begin(), std::move(value));
+		}
+		/**
+		 * Adds a new element at the end of the list, after its current last element.
+		 *
+		* @param value the value to add to the list.
+		*/
+		void push_back(T&& value)
+		{
+			this->insert(this->end(), std::move(value));
+		}
+		/**
+		 * Erases element at the begining of the list.
+		*/
+		void pop_front()
+		{
+			this->erase(this->begin());
+		}
+		/**
+		* Erases element at the end of the list.
+		*/
+		void pop_back()
+		{
+			this->erase(--this->end());
+		}
+		/**
+		 * Adds a new node at the end of the list, after its current node.
+		 *
+		 * @param value the value to place in the node.
+		 */	
+		iterator insert(iterator position, const T& value)
+		{
+			// I need the current node in the iterator.
+			// This is a pointer to the node of the iterator. 
+			auto* current_node = position.current;
+			this->my_size++;
+			return  iterator(
+				current_node->previous = current_node->previous->next =
+				this->pool.create(value, current_node->previous, current_node));
+		}
+		/**
+		 * Adds a new node at the end of the list, after its current node.
+		 *
+		 * @param value the value to place in the node.
+		 */
+		iterator insert(iterator position, T&& value)
+		{
+			auto* current_position = position.current;
+			this->my_size++;
+			return iterator(current_position->previous = current_position->previous->next =
+				this->pool.create(std::move(value), current_position->previous, current_position));
+
+		}
+		/**
+		 * Adds copies of the elements of [first, last) before position, in order.
+		 *
+		 * When the range can be measured up front, its nodes come from the pool
+		 * in one piece. The new nodes are chained together first and linked into
+		 * the list at the end, so if copying an element throws the list is left
+		 * as it was.
+		 *
+		 * @param position the element the new ones go in front of.
+		 * @param first the first element to copy.
+		 * @param last the end of the range.
+		 * @return an iterator to the first new element, or position if the range is empty.
+		 */
+		template <typename InputIt, typename = detail::require_input_iterator<InputIt>>
+		iterator insert(iterator position, InputIt first, InputIt last)
+		{
+			if constexpr (std::is_convertible<typename std::iterator_traits<InputIt>::iterator_category, std::forward_iterator_tag>::value) {
+				this->pool.reserve(static_cast<int>(std::distance(first, last)));
+			} // else, the range can only be read once, do_nothing();
+
+			return this->insert_nodes(position, [this, &first, &last](node* previous) -> node* {
+				if (first == last) {
+					return nullptr;
+				} // else, there is another element to copy, do_nothing();
+
+				auto* created = this->pool.create(*first, previous, nullptr);
+				++first;
+				return created;
+			});
+		}
+		/**
+		 * Adds values before position, in order.
+		 *
+		 * @param position the element the new ones go in front of.
+		 * @param values the values to add.
+		 * @return an iterator to the first new element, or position if values is empty.
+		 */
+		iterator insert(iterator position, std::initializer_list<T> values)
+		{
+			return this->insert(position, values.begin(), values.end());
+		}
+		/**
+		 * Moves every element of other in front of position, in constant time.
+		 * No element is copied or moved: the nodes are relinked, and iterators
+		 * to them stay valid, now referring into this list. The pool of this
+		 * list keeps the slabs of other alive. other is left empty, and its
+		 * deferred promotions are applied first.
+		 *
+		 * When the allocators do not compare equal, the nodes of other cannot be
+		 * freed through this list, so its elements are moved one by one into
+		 * new nodes instead, in time linear in their number, and iterators to
+		 * them are invalidated.
+		 *
+		 * @param position the element the spliced ones go in front of.
+		 * @param other the list to take the elements from.
+		 */
+		void splice(iterator position, linked_list& other)
+		{
+			if (this == &other || other.empty()) {
+				return;
+			} // else, there are nodes to take, do_nothing();
+
+			other.flush_promotions();
+			this->splice(position, other, other.begin(), other.end(), other.my_size);
+		}
+		/**
+		 * Moves the element at it from other in front of position, in constant time.
+		 * other may be this list.
+		 *
+		 * @param position the element the spliced one goes in front of.
+		 * @param other the list holding it.
+		 * @param it the element to move.
+		 */
+		void splice(iterator position, linked_list& other, iterator it)
+		{
+			auto last = it;
+			this->splice(position, other, it, ++last, 1);
+		}
+		/**
+		 * Moves the elements of [first, last) from other in front of position.
+		 * Within one list this takes constant time. Across lists the range is
+		 * first counted, so it takes as long as the range is long; pass the
+		 * count when it is known to avoid that.
+		 *
+		 * @param position the element the spliced ones go in front of; it may not be in [first, last).
+		 * @param other the list holding the range, which may be this list.
+		 * @param first the first element to move.
+		 * @param last the end of the range.
+		 */
+		void splice(iterator position, linked_list& other, iterator first, iterator last)
+		{
+			auto count = 0;
+			if (this != &other) {
+				for (auto* current = first.current; current != last.current; current = current->next) {	// O(n) in the length of the range.
+					count++;
+				}
+			} // else, the size does not change, do_nothing();
+
+			this->splice(position, other, first, last, count);
+		}
+		/**
+		 * Moves the count elements of [first, last) from other in front of
+		 * position, in constant time whichever list they come from.
+		 *
+		 * The range is taken in the order other has now. If other has deferred
+		 * hits, those on the moved elements are dropped and the rest applied,
+		 * which takes time linear in the length of the range.
+		 *
+		 * @param position the element the spliced ones go in front of; it may not be in [first, last).
+		 * @param other the list holding the range, which may be this list.
+		 * @param first the first element to move.
+		 * @param last the end of the range.
+		 * @param count the number of elements in [first, last).
+		 */
+		void splice(iterator position, linked_list& other, iterator first, iterator last, int count)
+		{
+			if (first == last) {
+				return;
+			} // else, there are nodes to move, do_nothing();
+
+			if (this == &other) {
+				this->relink(position.current, first.current, last.current);
+				return;
+			} // else, the nodes change lists, do_nothing();
+
+			if (!this->can_adopt(other)) {
+				// Only the allocator of other can free its nodes, so the elements move into new ones.
+				auto* source = first.current;
+				auto* end = last.current;
+				this->insert_nodes(position, [this, &source, end](node* previous) -> node* {
+					if (source == end) {
+						return nullptr;
+					} // else, there is another element to move, do_nothing();
+
+					auto* created = this->pool.create(std::move(source->data), previous, nullptr);
+					if constexpr (Policy::k_counts_accesses) {
+						created->count = source->count;
+					} // else, the nodes have no counters, do_nothing();
+					source = source->next;
+					return created;
+				});
+				other.erase(first, last);
+				return;
+			} // else, the nodes can be relinked as they are, do_nothing();
+
+			this->pool.share(other.pool);
+			other.my_size -= count;
+			this->my_size += count;
+			if (other.pending.empty()) {
+				this->relink(position.current, first.current, last.current);
+				return;
+			} // else, the deferred hits of other must not reorder the range, do_nothing();
+
+			// Take the range out before other applies its hits, skipping those on the range.
+			detach(first.current, last.current);
+			other.flush_promotions();
+			auto* final = first.current;
+			final->previous = position.current->previous;
+			while (final->next != last.current) {
+				final->next->previous = final;
+				final = final->next;
+			}
+			final->next = position.current;
+			position.current->previous->next = first.current;
+			position.current->previous = final;
+		}
+		/**
+		 * Moves every element of other into this list, interleaved by recency,
+		 * without copying or moving any element. Both lists keep the relative
+		 * order find has given them. An element that is a fraction f of the way
+		 * down its own list ends up a fraction f of the way down the merged one,
+		 * so the recently found elements of both stay near the front; elements
+		 * of this list go first on ties. When Policy counts accesses the lists
+		 * are merged by access count instead, highest first.
+		 * Runs in O(n + m). When the allocators do not compare equal, the
+		 * elements of other are first moved into new nodes, as splice does.
+		 *
+		 * @param other the list to merge in, left empty.
+		 */
+		void merge(linked_list& other)
+		{
+			if (this == &other || other.empty()) {
+				return;
+			} // else, there are nodes to merge, do_nothing();
+
+			if (!this->can_adopt(other)) {
+				linked_list moved(this->get_allocator());
+				moved.splice(moved.end(), other);
+				this->merge(moved);
+				return;
+			} // else, the nodes can be relinked as they are, do_nothing();
+
+			this->flush_promotions();
+			other.flush_promotions();
+			this->pool.share(other.pool);
+			auto mine = static_cast<std::int64_t>(this->my_size);
+			auto theirs = static_cast<std::int64_t>(other.my_size);
+			std::int64_t index = 0;
+			std::int64_t other_index = 0;
+			auto* current = this->head->next;
+			auto* incoming = other.head->next;
+			while (incoming != other.tail) {
+				auto keep_mine = false;
+				if (current != this->tail) {
+					if constexpr (Policy::k_counts_accesses) {
+						keep_mine = current->count >= incoming->count;
+					} else {
+						// Compares (index + 1/2) / mine with (other_index + 1/2) / theirs.
+						keep_mine = (2 * index + 1) * theirs <= (2 * other_index + 1) * mine;
+					}
+				} // else, the rest of other goes at the back, do_nothing();
+
+				if (keep_mine) {
+					current = current->next;
+					index++;
+				}
+				else {
+					auto* next = incoming->next;
+					incoming->previous = current->previous;
+					incoming->next = current;
+					current->previous->next = incoming;
+					current->previous = incoming;
+					incoming = next;
+					other_index++;
+				}
+			}
+
+			this->my_size += other.my_size;
+			other.my_size = 0;
+			other.head->next = other.tail;
+			other.tail->previous = other.head;
+		}
+		/**
+		 * Isolates and erases a node at a given position.
+		 *
+		 * @param position is the node to be erased.
+		 */
+		iterator erase(iterator position)
+		{
+			// Deferred hits may refer to the node about to be destroyed.
+			this->flush_promotions();
+			auto* current_position = position.current;
+			iterator value(current_position->next);
+			current_position->previous->next = current_position->next;
+			current_position->next->previous = current_position->previous;
+			// Now I have isolated current position
+			this->pool.destroy(current_position);
+			this->my_size--;
+			return value;
+		}
+		/**
+		 * Removes the first element equal to key. The order of the other elements is unchanged.
+		 *
+		 * @param key the value to remove.
+		 * @return true if an element was removed.
+		 */
+		bool erase(const T& key)
+		{
+			for (auto position = begin(); position != end(); position++) {
+				if (*position == key) {
+					this->erase(position);
+					return true;
+				} // else, keep looking, do_nothing();
+			}
+			return false;
+		}
+		/**
+		 * Isolates and erases a range of nodes. The range is taken in the order
+		 * the list has now, before any deferred promotion is applied; hits
+		 * recorded on the erased elements are dropped.
+		 *
+		 * @param from is the starting position to be erased.
+		 * @param to is the ending position to be erased.
+		 */
+		iterator erase(iterator from, iterator to)
+		{
+			if (from == to) {
+				return to;
+			} // else, there are nodes to erase, do_nothing();
+
+			auto count = this->detach(from.current, to.current);
+			// Deferred hits may refer to the detached nodes, apply the others before destroying them.
+			this->flush_promotions();
+			for (auto* current = from.current; current != to.current;) {
+				auto* next = current->next;
+				this->pool.destroy(current);
+				current = next;
+			}
+			this->my_size -= count;
+			return to;
+		}
+		/**
+		 * Locates search key and moves it forward as decided by Policy
+		 * (to the front of list by default).
+		 * key may be of any type comparable with element == key, such as a
+		 * std::string_view in a linked_list<std::string>; it is never copied or converted to T.
+		 *
+		 * @param key is the value to search the list for.
+		 */
+		template <typename K>
+		bool find(const K& key)
+		{
+			return this->find_position(key) != this->end();
+		}
+
+		/**
+		 * Same as find, but returns the found element, so it can be read or
+		 * updated without walking the list again.
+		 *
+		 * @param key is the value to search the list for.
+		 * @return an iterator to the found element, or end() if key is not in the list.
+		 */
+		template <typename K>
+		iterator find_position(const K& key)
+		{
+			return this->find_if([&key](const T& value) { return value == key; });
+		}
+
+		/**
+		 * Locates the first element matches accepts and moves it forward as
+		 * decided by Policy. To look up a record by one of its fields, compare
+		 * the field in the predicate:
+		 *
+		 *     list.find_if([&id](const record& value) { return value.id == id; });
+		 *
+		 * @param matches called with a constant reference to each element, front to back.
+		 * @return an iterator to the found element, or end() if nothing matched.
+		 */
+		template <typename Predicate>
+		iterator find_if(Predicate matches)
+		{
+			auto timer = this->stats.begin_lookup();
+			auto index = 0;
+			for (auto position = begin(); position != end(); position++, index++) {			// O(n) due to search n times.
+				if (matches(*position))
+				{
+					if (this->pending.deferring()) {
+						if (this->pending.record(position.current)) {
+							this->flush_promotions();
+						} // else, the batch is not full yet, do_nothing();
+					}
+					else {
+						this->promote(position.current, index);								// Constant time relink, nothing is copied.
+					}
+					this->stats.end_lookup(timer, true, index);
+					return position;														// Relinking leaves the node, and so position, valid.
+				} // else, key is already at the begining of the list. do_nothing();
+			}
+			this->stats.end_lookup(timer, false, index);
+			return end();
+		}																					// Method has an overall O(n) run-time.
+
+		/**
+		 * Returns whether key is in the list without changing the order.
+		 *
+		 * @param key is the value to search the list for.
+		 */
+		template <typename K>
+		bool contains(const K& key) const
+		{
+			for (const auto& value : *this) {
+				if (value == key) {
+					return true;
+				} // else, keep looking, do_nothing();
+			}
+			return false;
+		}
+
+		/**
+		 * Looks up count keys at once and then promotes every key that was found.
+		 *
+		 * The searches for up to k_lookup_lanes keys are interleaved: each step
+		 * compares one node for one key, moves that key on to its next node and
+		 * prefetches it, then turns to the next key. While one search waits for
+		 * its node to arrive from memory, the others make progress, which hides
+		 * most of the cache misses of a list that does not fit in cache.
+		 *
+		 * Promotions are applied after the searches, in key order, so the list
+		 * ends up exactly as if find had been called on each key in turn. Each
+		 * search remembers how deep it found its key, and the depths are kept
+		 * up to date as earlier promotions shift nodes, so no promotion walks
+		 * the list to find where its node is.
+		 * Stats counts every key as a lookup but does not time them.
+		 *
+		 * @param keys the values to search the list for, of any type comparable
+		 *        with element == key, as in find.
+		 * @param count the number of keys.
+		 * @param found receives, for each key, whether it was in the list. May be nullptr.
+		 * @return the number of keys found.
+		 */
+		template <typename K>
+		int find_many(const K* keys, int count, bool* found = nullptr)
+		{
+			auto hits = 0;
+			node* matches[k_lookup_batch];
+			int depths[k_lookup_batch];
+			int positions[k_lookup_batch];
+			for (auto batch_start = 0; batch_start < count; batch_start += k_lookup_batch) {
+				auto batch_size = std::min(k_lookup_batch, count - batch_start);
+				this->search_interleaved(keys + batch_start, batch_size, matches, depths);
+				if constexpr (!std::is_same<Policy, move_to_front>::value) {
+					std::copy(depths, depths + batch_size, positions);
+				} // else, promotions go to the front whatever the depth, do_nothing();
+
+				for (auto index = 0; index < batch_size; index++) {
+					auto* match = matches[index];
+					if (found != nullptr) {
+						found[batch_start + index] = match != nullptr;
+					} // else, the caller only wants the count, do_nothing();
+					if constexpr (Stats::k_enabled) {
+						this->stats.record_lookup(match != nullptr, depths[index]);
+					} // else, nothing is recorded, do_nothing();
+					if (match == nullptr) {
+						continue;
+					} // else, the key was found, promote it, do_nothing();
+
+					hits++;
+					if (this->pending.deferring()) {
+						if (this->pending.record(match)) {
+							this->flush_promotions();
+						} // else, the batch is not full yet, do_nothing();
+					}
+					else if constexpr (std::is_same<Policy, move_to_front>::value) {
+						this->promote_to_front(match);
+					}
+					else {
+						auto from = positions[index];
+						auto to = this->promote(match, from);
+						// The move shifted the nodes in [to, from) back one place.
+						for (auto later = index + 1; later < batch_size; later++) {
+							if (matches[later] == match) {
+								positions[later] = to;
+							}
+							else if (positions[later] >= to && positions[later] < from) {
+								positions[later]++;
+							} // else, the node of that key did not move, do_nothing();
+						}
+					}
+				}
+			}
+			return hits;
+		}
+
+		/**
+		 * Defers promotions: find only records the node it found, and the
+		 * recorded promotions are applied together every batch_size hits (or on
+		 * flush_promotions), with repeated hits on one node coalesced.
+		 * Between batches find writes nothing to the nodes.
+		 *
+		 * Nodes are promoted oldest last hit first, each as if find had run
+		 * once per hit. Under move_to_front the result is the order eager
+		 * finds give, and under frequency_count the counts are the same. Under
+		 * transpose and move_ahead_k a node may stop in a different place,
+		 * because its hits are no longer interleaved with those on others.
+		 *
+		 * @param batch_size the number of hits per batch, 0 to promote on every find again.
+		 */
+		void defer_promotions(int batch_size)
+		{
+			this->flush_promotions();
+			this->pending.set_batch_size(batch_size);
+		}
+
+		/**
+		 * Applies every deferred promotion now, oldest hit first, so the most
+		 * recently found element ends up furthest forward.
+		 */
+		void flush_promotions()
+		{
+			if (this->pending.empty()) {
+				return;
+			} // else, there is work to apply, do_nothing();
+
+			auto& hits = this->pending.take();
+			for (auto entry = hits.rbegin(); entry != hits.rend(); ++entry) {
+				auto* current = entry->position;
+				if (current->previous == nullptr) {
+					continue;
+				} // else, the node is still linked into this list, do_nothing();
+
+				if constexpr (std::is_same<Policy, move_to_front>::value) {
+					this->promote_to_front(current);
+				} else {
+					this->promote(current, this->position_of(current), entry->hits);
+				}
+			}
+		}
+
+		/**
+		 * Returns the number of hits recorded but not yet applied.
+		 */
+		int pending_promotions() const
+		{
+			return this->pending.size();
+		}
+
+		/**
+		 * Writes the elements in their current order to a snapshot file (see
+		 * snapshot.h), with their access counters if Policy keeps them, so a
+		 * restarted process can load the order find has learned.
+		 * Promotions that are still deferred are not included.
+		 *
+		 * @param path the file to write.
+		 */
+		void save(const std::string& path) const
+		{
+			snapshot_writer out(path);
+			detail::write_snapshot_header<T>(out, this->my_size, Policy::k_counts_accesses);
+			if constexpr (Policy::k_counts_accesses) {
+				for (auto* current = this->head->next; current != this->tail; current = current->next) {
+					out.write(current->count);
+				}
+			} // else, there are no counters to save, do_nothing();
+
+			for (auto* current = this->head->next; current != this->tail; current = current->next) {
+				if constexpr (detail::is_raw_snapshot_element<T>::value) {
+					out.write(current->data);
+				} else {
+					snapshot_traits<T>::save(out, current->data);
+				}
+			}
+			out.finish();
+		}
+
+		/**
+		 * Replaces the contents of this list with a snapshot written by save.
+		 * The file is memory mapped and each element is built straight from it
+		 * into a pooled node. Counters are restored when both the snapshot and
+		 * Policy have them, and start at zero otherwise. The statistics and the
+		 * deferred batch size are kept; hits still deferred are dropped.
+		 * A count that does not fit, or, for trivially copyable elements, one
+		 * the file is too short for, is rejected before storage is reserved.
+		 *
+		 * @param path the file to read.
+		 */
+		void load(const std::string& path)
+		{
+			detail::mapped_file file(path);
+			snapshot_reader in(file.data(), file.size());
+			auto header = detail::read_snapshot_header<T>(in, INT32_MAX, sizeof(access_counter));
+			auto count = static_cast<int>(header.count);
+
+			const char* counters = nullptr;
+			if (header.flags & snapshot_header::k_has_counts) {
+				counters = in.take(count * sizeof(access_counter));
+			} // else, every counter starts at zero, do_nothing();
+
+			linked_list loaded(this->get_allocator());
+			loaded.pending.set_batch_size(this->pending.batch_size());
+			loaded.pool.reserve(count);
+			auto index = 0;
+			loaded.insert_nodes(loaded.end(), [&loaded, &in, &index, count, counters](node* previous) -> node* {
+				if (index == count) {
+					return nullptr;
+				} // else, there is another element to read, do_nothing();
+
+				node* created = nullptr;
+				if constexpr (detail::is_raw_snapshot_element<T>::value) {
+					created = loaded.pool.create(in.template read<T>(), previous, nullptr);
+				} else {
+					created = loaded.pool.create(snapshot_traits<T>::load(in), previous, nullptr);
+				}
+				if constexpr (Policy::k_counts_accesses) {
+					if (counters != nullptr) {
+						std::memcpy(&created->count, counters + index * sizeof(access_counter), sizeof(access_counter));
+					} // else, the snapshot has no counters, do_nothing();
+				} else {
+					(void)counters;
+				}
+				index++;
+				return created;
+			});
+			// Only the elements are replaced, what find has recorded stays with this list.
+			std::swap(loaded.stats, this->stats);
+			this->exchange(loaded);
+		}
+
+		/**
+		 * Returns what find has recorded, e.g. statistics().snapshot() or
+		 * statistics().reset(). Records nothing unless Stats is access_stats.
+		 */
+		Stats& statistics()
+		{
+			return this->stats;
+		}
+
+		/**
+		 * Returns what find has recorded.
+		 */
+		const Stats& statistics() const
+		{
+			return this->stats;
+		}
+
+		friend std::ostream& operator<<(std::ostream& out, const linked_list& list)
+		{
+			if (list.empty()) {
+				out << "Empty list";
+			}
+			else {
+				for (auto& value : list) {
+					out << value << " ";
+				}
+			}
+
+			return out;
+		}
+
+	private:
+		/**
+		 * The current number of nodes in the list.
+		 */
+		int my_size;
+		/**
+		 * Pointer to begining of list.
+		 */
+		node* head;
+		/**
+		 * Pointer to tail of the list.
+		 */
+		node* tail;
+		/**
+		 * Storage for every node of this list, including head and tail.
+		 */
+		node_pool<node, node_allocator> pool;
+		/**
+		 * Hits recorded by find while promotions are deferred.
+		 */
+		promotion_buffer<node*> pending;
+		/**
+		 * Lookup and promotion counters, empty unless Stats records them.
+		 */
+		Stats stats;
+
+		/**
+		 * The number of searches find_many keeps in flight at once.
+		 */
+		static constexpr int k_lookup_lanes = 8;
+
+		/**
+		 * The number of keys find_many searches before applying their promotions.
+		 */
+		static constexpr int k_lookup_batch = 64;
+
+		/**
+		 * Whether find_many needs the depth of each search: for Stats, or to
+		 * promote without walking the list under policies other than move_to_front.
+		 */
+		static constexpr bool k_tracks_depths = Stats::k_enabled || !std::is_same<Policy, move_to_front>::value;
+
+		/**
+		* Asks the processor to start loading a node into cache.
+		*/
+		static void prefetch(const node* address)
+		{
+#if defined(__GNUC__) || defined(__clang__)
+			__builtin_prefetch(address);
+#elif defined(_MSC_VER)
+			_mm_prefetch(reinterpret_cast<const char*>(address), _MM_HINT_T0);
+#else
+			(void)address;
+#endif
+		}
+
+		/**
+		* Searches for count keys with up to k_lookup_lanes searches interleaved.
+		* Nothing is moved, so every search sees the same list.
+		*
+		* @param keys the values to search for.
+		* @param count the number of keys, at most k_lookup_batch.
+		* @param matches receives the node holding each key, or nullptr.
+		* @param depths receives the number of nodes each search passed, only when k_tracks_depths.
+		*/
+		template <typename K>
+		void search_interleaved(const K* keys, int count, node** matches, int* depths)
+		{
+			node* current[k_lookup_lanes];
+			int searching[k_lookup_lanes];
+			auto next_key = 0;
+			auto active = 0;
+
+			for (auto lane = 0; lane < k_lookup_lanes; lane++) {
+				searching[lane] = -1;
+				current[lane] = this->head->next;
+				if (next_key < count) {
+					searching[lane] = next_key++;
+					active++;
+					if constexpr (k_tracks_depths) {
+						depths[searching[lane]] = 0;
+					} // else, depths are not recorded, do_nothing();
+				} // else, there are fewer keys than lanes, do_nothing();
+			}
+			prefetch(this->head->next);
+
+			while (active > 0) {
+				for (auto lane = 0; lane < k_lookup_lanes; lane++) {
+					if (searching[lane] < 0) {
+						continue;
+					} // else, this lane has a search in flight, do_nothing();
+
+					auto* position = current[lane];
+					auto finished = position == this->tail;
+					if (finished) {
+						matches[searching[lane]] = nullptr;
+					}
+					else if (position->data == keys[searching[lane]]) {
+						matches[searching[lane]] = position;
+						finished = true;
+					}
+					else {
+						current[lane] = position->next;
+						prefetch(position->next);
+						if constexpr (k_tracks_depths) {
+							depths[searching[lane]]++;
+						} // else, depths are not recorded, do_nothing();
+					}
+
+					if (finished) {
+						if (next_key < count) {
+							searching[lane] = next_key++;
+							current[lane] = this->head->next;
+							if constexpr (k_tracks_depths) {
+								depths[searching[lane]] = 0;
+							} // else, depths are not recorded, do_nothing();
+						}
+						else {
+							searching[lane] = -1;
+							active--;
+						}
+					} // else, the search continues on the next round, do_nothing();
+				}
+			}
+		}
+
+		/**
+		 * Returns whether this list may take the nodes of other as they are,
+		 * that is whether its allocator can free them.
+		 */
+		bool can_adopt(const linked_list& other) const
+		{
+			return allocator_traits::is_always_equal::value || this->get_allocator() == other.get_allocator();
+		}
+
+		/**
+		 * Links the nodes make creates in front of position as one chain. make
+		 * is called with the node it created last, nullptr at first, and
+		 * returns a new node whose previous is that node, or nullptr when there
+		 * are no more. If make throws, the nodes created so far are destroyed
+		 * and the list is left as it was.
+		 *
+		 * @return an iterator to the first new node, or position if none was created.
+		 */
+		template <typename Make>
+		iterator insert_nodes(iterator position, Make make)
+		{
+			node* chain_head = nullptr;
+			node* chain_tail = nullptr;
+			auto count = 0;
+			try {
+				for (auto* created = make(chain_tail); created != nullptr; created = make(chain_tail)) {
+					if (chain_tail == nullptr) {
+						chain_head = created;
+					} else {
+						chain_tail->next = created;
+					}
+					chain_tail = created;
+					count++;
+				}
+			}
+			catch (...) {
+				while (chain_head != nullptr) {
+					auto* next = chain_head->next;
+					this->pool.destroy(chain_head);
+					chain_head = next;
+				}
+				throw;
+			}
+
+			if (count == 0) {
+				return position;
+			} // else, link the whole chain in at once, do_nothing();
+
+			auto* current_position = position.current;
+			chain_head->previous = current_position->previous;
+			chain_tail->next = current_position;
+			current_position->previous->next = chain_head;
+			current_position->previous = chain_tail;
+			this->my_size += count;
+			return iterator(chain_head);
+		}
+
+		/**
+		 * Exchanges everything with rhs. The allocators are exchanged along with
+		 * the nodes, or must compare equal when they cannot be swapped.
+		 */
+		void exchange(linked_list& rhs)
+		{
+			std::swap(this->my_size, rhs.my_size);
+			std::swap(this->head, rhs.head);
+			std::swap(this->tail, rhs.tail);
+			this->pool.swap(rhs.pool);
+			this->pending.swap(rhs.pending);
+			std::swap(this->stats, rhs.stats);
+		}
+
+		/**
+		* Initialization of list.
+		*/
+		void init()
+		{
+			this->my_size = 0;
+			this->head = this->pool.create();
+			this->tail = this->pool.create();
+			this->head->next = this->tail;
+			this->tail->previous = this->head;
+		}
+
+		/**
+		* Moves a node that was just found forward as far as Policy decides.
+		*
+		* @param current the node to promote.
+		* @param index the position of current in the list.
+		* @param hits the number of times current was found.
+		* @return the position current moved to.
+		*/
+		int promote(node* current, int index, int hits = 1)
+		{
+			if constexpr (Policy::k_counts_accesses) {
+				current->count += hits;
+			} else {
+				// Without counters every hit is a step of its own, as if find had run hits times.
+				for (; hits > 1; hits--) {
+					index = this->promote(current, index);
+				}
+			}
+
+			auto* ahead = current;
+			auto steps = Policy::steps(index, [current, &ahead]() {
+				ahead = ahead->previous;
+				if constexpr (Policy::k_counts_accesses) {
+					return current->count > ahead->count;
+				} else {
+					return true;
+				}
+			});
+
+			if (steps == 0) {
+				return index;
+			} // else, current moves forward, do_nothing();
+
+			this->stats.record_promotion(steps);
+			// Moving all the way to the front needs no walk back through the list.
+			auto* target = this->head->next;
+			if (steps < index) {
+				target = current;
+				for (auto step = 0; step < steps; step++) {
+					target = target->previous;
+				}
+			} // else, current goes to the front, do_nothing();
+			this->move_before(current, target);
+			return index - steps;
+		}
+
+		/**
+		* Moves a node to the front without knowing its position.
+		* The position is only looked up when Stats needs it.
+		*/
+		void promote_to_front(node* current)
+		{
+			if (current == this->head->next) {
+				return;
+			} // else, current is somewhere behind the front, do_nothing();
+
+			if constexpr (Stats::k_enabled) {
+				this->stats.record_promotion(this->position_of(current));
+			} // else, nothing is recorded, do_nothing();
+			this->move_before(current, this->head->next);
+		}
+
+		/**
+		* Returns the position of a node by walking back to head.
+		*/
+		int position_of(const node* current) const
+		{
+			auto index = 0;
+			for (auto* ahead = current->previous; ahead != this->head; ahead = ahead->previous) {
+				index++;
+			}
+			return index;
+		}
+
+		/**
+		* Relinks the nodes of [first, last) directly in front of position.
+		* position may not be one of them, except first, which leaves them in place.
+		*
+		* @param position the node the range will precede.
+		* @param first the first node to move.
+		* @param last the node after the last one to move.
+		*/
+		static void relink(node* position, node* first, node* last)
+		{
+			if (first == last || position == first || position == last) {
+				return;
+			} // else, the range is not already in front of position, do_nothing();
+
+			auto* final = last->previous;
+			first->previous->next = last;
+			last->previous = first->previous;
+			first->previous = position->previous;
+			final->next = position;
+			position->previous->next = first;
+			position->previous = final;
+		}
+
+		/**
+		* Unlinks the nodes of [first, last) as one chain, in their current
+		* order, and clears their previous pointers so that flush_promotions
+		* skips any hits recorded on them. The chain still ends at last.
+		*
+		* @param first the first node to unlink.
+		* @param last the node after the last one to unlink.
+		* @return the number of nodes unlinked.
+		*/
+		static int detach(node* first, node* last)
+		{
+			first->previous->next = last;
+			last->previous = first->previous;
+			auto count = 0;
+			for (auto* current = first; current != last; current = current->next) {
+				current->previous = nullptr;
+				count++;
+			}
+			return count;
+		}
+
+		/**
+		* Unlinks a node and relinks it directly in front of target.
+		*
+		* @param current the node to move.
+		* @param target the node current will precede.
+		*/
+		void move_before(node* current, node* target)
+		{
+			current->previous->next = current->next;
+			current->next->previous = current->previous;
+			current->previous = target->previous;
+			current->next = target;
+			target->previous->next = current;
+			target->previous = current;
+		}
+	};
+
+	namespace pmr {
+
+		/**
+		 * A linked_list whose nodes come from a std::pmr::memory_resource.
+		 */
+		template <typename T, typename Policy = move_to_front, typename Stats = no_stats>
+		using linked_list = nwacc::linked_list<T, Policy, Stats, std::pmr::polymorphic_allocator<T>>;
+
+	}
+
+}
+#endif
@@ -0,0 +1,421 @@
+#ifndef SELF_ADJUSTING_MAP_H
+#define SELF_ADJUSTING_MAP_H
+
+#include <algorithm>
+#include <deque>
+#include <memory>
+#include <optional>
+#include <utility>
+#include <vector>
+
+#include "adjustment_policy.h"
+#include "array_kernels.h"
+
+namespace nwacc {
+
+	/**
+	 * Self-adjusting key-value map in the style of array_list, laid out as a
+	 * structure of arrays.
+	 *
+	 * The keys are kept in one contiguous array in search order, next to a
+	 * parallel array of value slots. find scans only the keys (with the vector
+	 * compares of array_kernels.h for arithmetic and pointer keys), so the
+	 * values never pass through the cache during a search. Promotion moves a
+	 * key and its slot number; the values themselves stay where they were
+	 * inserted and are never moved, so pointers to them remain valid until
+	 * their key is erased.
+	 *
+	 * @param K the key type.
+	 * @param V the value type.
+	 * @param Policy how find reorganizes the keys (see adjustment_policy.h).
+	 */
+	template <typename K, typename V, typename Policy = move_to_front>
+	class self_adjusting_map {
+
+	public:
+
+		/**
+		 * Constructs an empty map with room for initial_capacity keys.
+		 *
+		 * @param initial_capacity the initial capacity of the key array.
+		 */
+		explicit self_adjusting_map(int initial_capacity = 0) :
+			my_size{ 0 }, my_capacity{ initial_capacity + k_spare_capacity }, keys{ nullptr }, slots{ nullptr }
+		{
+			try {
+				this->keys = detail::allocate_storage<K>(this->my_capacity);
+				this->slots = detail::allocate_storage<int>(this->my_capacity);
+				this->counts.allocate(this->my_capacity);
+			}
+			catch (...) {
+				this->release();
+				throw;
+			}
+		}
+
+		/**
+		 * Constructs a copy of rhs, with the keys in the same order.
+		 *
+		 * @param rhs the map to copy.
+		 */
+		self_adjusting_map(const self_adjusting_map& rhs) :
+			my_size{ 0 }, my_capacity{ rhs.my_capacity }, keys{ nullptr }, slots{ nullptr },
+			values{ rhs.values }, free_slots{ rhs.free_slots }
+		{
+			try {
+				this->keys = detail::allocate_storage<K>(this->my_capacity);
+				// uninitialized_copy destroys what it built if a copy throws.
+				std::uninitialized_copy(rhs.keys, rhs.keys + rhs.my_size, this->keys);
+				this->my_size = rhs.my_size;
+				this->slots = detail::allocate_storage<int>(this->my_capacity);
+				std::copy(rhs.slots, rhs.slots + rhs.my_size, this->slots);
+				this->counts.allocate(this->my_capacity);
+				this->counts.copy(rhs.counts, this->my_size);
+			}
+			catch (...) {
+				this->release();
+				throw;
+			}
+		}
+
+		self_adjusting_map& operator=(const self_adjusting_map& rhs)
+		{
+			auto copy = rhs;
+			this->swap(copy);
+			return *this;
+		}
+
+		self_adjusting_map(self_adjusting_map&& rhs) :
+			my_size{ 0 }, my_capacity{ 0 }, keys{ nullptr }, slots{ nullptr }
+		{
+			this->swap(rhs);
+		}
+
+		self_adjusting_map& operator=(self_adjusting_map&& rhs)
+		{
+			this->swap(rhs);
+			return *this;
+		}
+
+		/**
+		 * Destroys this instance and frees any allocated resources.
+		 */
+		~self_adjusting_map()
+		{
+			this->release();
+		}
+
+		void swap(self_adjusting_map& rhs)
+		{
+			std::swap(this->my_size, rhs.my_size);
+			std::swap(this->my_capacity, rhs.my_capacity);
+			std::swap(this->keys, rhs.keys);
+			std::swap(this->slots, rhs.slots);
+			this->counts.swap(rhs.counts);
+			this->values.swap(rhs.values);
+			this->free_slots.swap(rhs.free_slots);
+		}
+
+		/**
+		 * Returns whether this instance is empty.
+		 */
+		bool empty() const
+		{
+			return this->size() == 0;
+		}
+
+		/**
+		 * Returns the number of keys in this instance.
+		 */
+		int size() const
+		{
+			return this->my_size;
+		}
+
+		/**
+		 * Returns the number of keys the key array has room for.
+		 */
+		int capacity() const
+		{
+			return this->my_capacity;
+		}
+
+		/**
+		 * Requests that the key array have room for at least new_capacity keys.
+		 *
+		 * @param new_capacity the new capacity.
+		 */
+		void reserve(int new_capacity)
+		{
+			if (new_capacity <= this->my_capacity) {
+				return;
+			} // else, we need to reserve more memory, do_nothing();
+
+			auto* new_keys = detail::allocate_storage<K>(new_capacity);
+			int* new_slots = nullptr;
+			// Everything is allocated before any key moves, so a failure leaves the map untouched.
+			decltype(this->counts) grown;
+			try {
+				new_slots = detail::allocate_storage<int>(new_capacity);
+				grown.allocate(new_capacity);
+				detail::relocate(this->keys, this->my_size, new_keys);
+			}
+			catch (...) {
+				grown.release();
+				detail::release_storage(new_slots);
+				detail::release_storage(new_keys);
+				throw;
+			}
+			detail::relocate(this->slots, this->my_size, new_slots);
+			grown.copy(this->counts, this->my_size);
+			this->counts.swap(grown);
+			grown.release();
+			this->my_capacity = new_capacity;
+			std::swap(this->keys, new_keys);
+			std::swap(this->slots, new_slots);
+			detail::release_storage(new_keys);
+			detail::release_storage(new_slots);
+		}
+
+		/**
+		 * Searches the keys for key, moves it forward as decided by Policy
+		 * (to the front by default) and returns its value.
+		 * Only the key array is scanned, and only the key and its slot number move.
+		 *
+		 * @param key is the key you are searching for.
+		 * @return the value of key, or nullptr if key is not in the map.
+		 */
+		V* find(const K& key)
+		{
+			auto index = detail::find_index(this->keys, this->my_size, key);				// O(n) scanning keys only.
+			if (index < 0) {
+				return nullptr;
+			} // else, key was found at index, do_nothing();
+
+			index = this->promote(index);													// O(n) shifting keys and slot numbers.
+			return &*this->values[this->slots[index]];										// Overal run-time of O(n)
+		}
+
+		/**
+		 * Returns whether key is in the map without changing the order.
+		 *
+		 * @param key is the key you are searching for.
+		 */
+		bool contains(const K& key) const
+		{
+			return detail::find_index(this->keys, this->my_size, key) >= 0;
+		}
+
+		/**
+		 * Adds key with value at the end of the search order, unless key is already in the map.
+		 *
+		 * @param key the key to add.
+		 * @param value the value of key.
+		 * @return true if key was added, false if it was already in the map (its value is unchanged).
+		 */
+		bool insert(const K& key, const V& value)
+		{
+			return this->insert(key, V(value));
+		}
+
+		/**
+		 * Adds key with value at the end of the search order, unless key is already in the map.
+		 *
+		 * @param key the key to add.
+		 * @param value the value of key.
+		 * @return true if key was added, false if it was already in the map (its value is unchanged).
+		 */
+		bool insert(const K& key, V&& value)
+		{
+			if (this->contains(key)) {
+				return false;
+			} // else, key is new, do_nothing();
+
+			this->append(key, std::move(value));
+			return true;
+		}
+
+		/**
+		 * Returns the value of key, promoting it, or inserts key with a
+		 * value-initialized value at the end of the search order.
+		 *
+		 * @param key the key to look up.
+		 */
+		V& operator[](const K& key)
+		{
+			auto* found = this->find(key);
+			if (found != nullptr) {
+				return *found;
+			} // else, key is new, do_nothing();
+
+			return this->append(key, V());
+		}
+
+		/**
+		 * Removes key and its value.
+		 *
+		 * @param key the key to remove.
+		 * @return true if key was in the map.
+		 */
+		bool erase(const K& key)
+		{
+			auto index = detail::find_index(this->keys, this->my_size, key);
+			if (index < 0) {
+				return false;
+			} // else, key was found at index, do_nothing();
+
+			auto slot = this->slots[index];
+			this->values[slot].reset();
+			this->free_slots.push_back(slot);
+
+			std::move(this->keys + index + 1, this->keys + this->my_size, this->keys + index);
+			std::move(this->slots + index + 1, this->slots + this->my_size, this->slots + index);
+			this->counts.erase(index, this->my_size);
+			this->keys[--this->my_size].~K();
+			return true;
+		}
+
+		/**
+		 * Removes every key and value. The capacity is kept.
+		 */
+		void clear()
+		{
+			std::destroy(this->keys, this->keys + this->my_size);
+			this->my_size = 0;
+			this->values.clear();
+			this->free_slots.clear();
+		}
+
+		/**
+		 * Calls visit with each key and its value, in search order.
+		 *
+		 * @param visit called as visit(const K&, V&).
+		 */
+		template <typename Visitor>
+		void for_each(Visitor visit)
+		{
+			for (auto index = 0; index < this->my_size; index++) {
+				visit(static_cast<const K&>(this->keys[index]), *this->values[this->slots[index]]);
+			}
+		}
+
+		/**
+		 * A modifier to ensure we do not have a zero (0) capacity in the map.
+		 */
+		static const int k_spare_capacity = 2;
+
+	private:
+		/**
+		 * The current number of keys.
+		 */
+		int my_size;
+		/**
+		 * The current capacity of the key and slot arrays.
+		 */
+		int my_capacity;
+		/**
+		 * The keys in search order. Only the first my_size are constructed.
+		 */
+		K* keys;
+		/**
+		 * For each key, the index of its value in values.
+		 */
+		int* slots;
+		/**
+		 * Access counters parallel to keys, empty unless Policy counts accesses.
+		 */
+		detail::access_counts<Policy::k_counts_accesses> counts;
+		/**
+		 * The values, at the slot they were inserted into. A deque never moves
+		 * its elements when it grows, and erased slots are empty until reused.
+		 */
+		std::deque<std::optional<V>> values;
+		/**
+		 * Slots of erased values, reused before values grows.
+		 */
+		std::vector<int> free_slots;
+
+		/**
+		 * Destroys the keys and frees whichever of the key, slot and counter
+		 * arrays are allocated; a map that was moved from holds none.
+		 */
+		void release()
+		{
+			if (this->keys != nullptr) {
+				std::destroy(this->keys, this->keys + this->my_size);
+				detail::release_storage(this->keys);
+			} // else, there are no keys, do_nothing();
+
+			if (this->slots != nullptr) {
+				detail::release_storage(this->slots);
+			} // else, there are no slots, do_nothing();
+			this->counts.release();
+		}
+
+		/**
+		 * Adds key with value at the end of the search order.
+		 *
+		 * @return the stored value.
+		 */
+		V& append(const K& key, V&& value)
+		{
+			if (this->my_size == this->my_capacity) {
+				this->reserve((this->my_capacity * 3) / 2 + k_spare_capacity);
+			} // else, the size is fine, do_nothing();
+
+			int slot;
+			if (this->free_slots.empty()) {
+				slot = static_cast<int>(this->values.size());
+				this->values.emplace_back(std::move(value));
+			}
+			else {
+				slot = this->free_slots.back();
+				this->values[slot].emplace(std::move(value));
+				this->free_slots.pop_back();
+			}
+
+			try {
+				::new (static_cast<void*>(this->keys + this->my_size)) K(key);
+			}
+			catch (...) {
+				this->values[slot].reset();
+				this->free_slots.push_back(slot);
+				throw;
+			}
+			this->slots[this->my_size] = slot;
+			this->counts.reset(this->my_size);
+			this->my_size++;
+			return *this->values[slot];
+		}
+
+		/**
+		 * Moves the key at index, and its slot number, forward as far as Policy decides.
+		 *
+		 * @param index the index of the key that was just found.
+		 * @return the index the key moved to.
+		 */
+		int promote(int index)
+		{
+			if constexpr (Policy::k_counts_accesses) {
+				this->counts[index]++;
+			} // else, nothing is counted, do_nothing();
+
+			auto ahead = index;
+			auto steps = Policy::steps(index, [this, index, &ahead]() {
+				--ahead;
+				if constexpr (Policy::k_counts_accesses) {
+					return this->counts[index] > this->counts[ahead];
+				} else {
+					return true;
+				}
+			});
+			detail::move_forward(this->keys, index, index - steps);
+			detail::move_forward(this->slots, index, index - steps);
+			this->counts.move_forward(index, index - steps);
+			return index - steps;
+		}
+	};
+
+}
+
+#endif
@@ -0,0 +1,209 @@
+#ifndef SELF_ADJUSTING_SHARDED_LIST_H
+#define SELF_ADJUSTING_SHARDED_LIST_H
+
+#include <algorithm>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+
+#include "self_adjusting_array.h"
+
+namespace nwacc {
+
+	/**
+	 * A set of self-adjusting lists that many threads can use at once,
+	 * partitioned by hash.
+	 *
+	 * Each key belongs to exactly one shard, picked from its hash, and every
+	 * operation on a key locks only that shard. Threads looking up keys in
+	 * different shards never wait for each other, and no two shards share a
+	 * cache line, so promotions in one shard do not slow down another. Each
+	 * shard holds about size() / shard_count() elements and keeps its own
+	 * recently found keys in front, so lists stay short and hot.
+	 *
+	 * Elements are unique. The table hands out no references to its
+	 * elements, since they may move as soon as the shard lock is released;
+	 * use for_each to visit them.
+	 *
+	 * @param T the element type, also used as the key.
+	 * @param Shard the list each shard holds: array_list (the default) or linked_list,
+	 *        with any policy. It needs find, contains, push_back, erase(key), clear and iteration.
+	 * @param Hash the hash function for T.
+	 */
+	template <typename T, typename Shard = array_list<T>, typename Hash = std::hash<T>>
+	class sharded_list {
+	public:
+
+		/**
+		 * Constructs an empty table.
+		 *
+		 * @param shard_count the number of shards, rounded up to a power of two;
+		 *        by default four per hardware thread.
+		 */
+		explicit sharded_list(int shard_count = 4 * static_cast<int>(std::thread::hardware_concurrency())) :
+			my_shard_bits{ 0 }
+		{
+			while ((1 << this->my_shard_bits) < shard_count && this->my_shard_bits < 16) {
+				this->my_shard_bits++;
+			}
+			this->shards.reset(new shard[1 << this->my_shard_bits]);
+		}
+
+		sharded_list(const sharded_list&) = delete;
+
+		sharded_list& operator=(const sharded_list&) = delete;
+
+		/**
+		 * Returns the number of shards.
+		 */
+		int shard_count() const
+		{
+			return 1 << this->my_shard_bits;
+		}
+
+		/**
+		 * Returns the number of elements, adding up the shards one at a time.
+		 * With other threads inserting or erasing the count is only approximate.
+		 */
+		int size() const
+		{
+			auto total = 0;
+			for (auto index = 0; index < this->shard_count(); index++) {
+				std::lock_guard<std::mutex> lock(this->shards[index].guard);
+				total += this->shards[index].list.size();
+			}
+			return total;
+		}
+
+		/**
+		 * Checks if the table is empty.
+		 */
+		bool empty() const
+		{
+			return this->size() == 0;
+		}
+
+		/**
+		 * Locates search key and moves it forward within its shard, as decided by the shard's policy.
+		 *
+		 * @param key is the value to search for.
+		 */
+		bool find(const T& key)
+		{
+			auto& owner = this->shard_of(key);
+			std::lock_guard<std::mutex> lock(owner.guard);
+			return owner.list.find(key);
+		}
+
+		/**
+		 * Returns whether key is in the table without changing any order.
+		 *
+		 * @param key is the value to search for.
+		 */
+		bool contains(const T& key) const
+		{
+			auto& owner = this->shard_of(key);
+			std::lock_guard<std::mutex> lock(owner.guard);
+			return owner.list.contains(key);
+		}
+
+		/**
+		 * Adds value at the back of its shard unless it is already in the table.
+		 *
+		 * @param value the value to add.
+		 * @return true if value was added.
+		 */
+		bool insert(const T& value)
+		{
+			auto& owner = this->shard_of(value);
+			std::lock_guard<std::mutex> lock(owner.guard);
+			if (owner.list.contains(value)) {
+				return false;
+			} // else, value is new, do_nothing();
+
+			owner.list.push_back(value);
+			return true;
+		}
+
+		/**
+		 * Removes key from its shard.
+		 *
+		 * @param key the value to remove.
+		 * @return true if key was in the table.
+		 */
+		bool erase(const T& key)
+		{
+			auto& owner = this->shard_of(key);
+			std::lock_guard<std::mutex> lock(owner.guard);
+			return owner.list.erase(key);
+		}
+
+		/**
+		 * Removes every element.
+		 */
+		void clear()
+		{
+			for (auto index = 0; index < this->shard_count(); index++) {
+				std::lock_guard<std::mutex> lock(this->shards[index].guard);
+				this->shards[index].list.clear();
+			}
+		}
+
+		/**
+		 * Calls visit with each element, shard by shard, each shard front to
+		 * back under its lock. visit must not call back into the table.
+		 *
+		 * @param visit called with a constant reference to each element.
+		 */
+		template <typename Visitor>
+		void for_each(Visitor visit) const
+		{
+			for (auto index = 0; index < this->shard_count(); index++) {
+				std::lock_guard<std::mutex> lock(this->shards[index].guard);
+				for (const auto& value : this->shards[index].list) {
+					visit(value);
+				}
+			}
+		}
+
+	private:
+		/**
+		 * One list and its lock, alone on its cache lines.
+		 */
+		struct alignas(64) shard {
+
+			mutable std::mutex guard;
+
+			Shard list;
+		};
+
+		/**
+		 * log2 of the number of shards.
+		 */
+		int my_shard_bits;
+
+		std::unique_ptr<shard[]> shards;
+
+		Hash hash;
+
+		/**
+		 * Returns the shard key belongs to. The hash is multiplied by 2^64 / phi
+		 * and its top bits taken, so keys whose hashes differ only in their
+		 * high bits (or an identity hash of sequential ints) still spread evenly.
+		 */
+		shard& shard_of(const T& key) const
+		{
+			if (this->my_shard_bits == 0) {
+				return this->shards[0];
+			} // else, there is a choice to make, do_nothing();
+
+			auto mixed = static_cast<std::uint64_t>(this->hash(key)) * 0x9E3779B97F4A7C15ULL;
+			return this->shards[static_cast<std::size_t>(mixed >> (64 - this->my_shard_bits))];
+		}
+	};
+
+}
+
+#endif
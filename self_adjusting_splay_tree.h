@@ -0,0 +1,569 @@
+#ifndef SELF_ADJUSTING_SPLAY_TREE_H
+#define SELF_ADJUSTING_SPLAY_TREE_H
+
+#include <functional>
+#include <iostream>
+#include <utility>
+
+#include "node_pool.h"
+
+namespace nwacc {
+
+	/**
+	 * Self-adjusting binary search tree (Sleator and Tarjan's splay tree).
+	 *
+	 * Every find, insert and erase splays the node it reaches to the root with
+	 * rotations, which is the tree analogue of move-to-front: recently used
+	 * keys sit near the root and are found in few steps. Any sequence of
+	 * operations costs amortized O(log n) each, and by the working-set property
+	 * a key accessed again after touching only k distinct keys costs
+	 * O(log k), so hot sets stay cheap no matter how large the table is.
+	 *
+	 * Elements are unique and iterate in Compare order. Nodes come from a
+	 * node_pool, and nothing is recursive, so degenerate shapes (for example
+	 * after inserting sorted keys) cannot overflow the stack.
+	 *
+	 * @param T the element type, also used as the key.
+	 * @param Compare the strict weak ordering of T.
+	 */
+	template <typename T, typename Compare = std::less<T>>
+	class splay_tree {
+	private:
+		/**
+		 * Constructs a node struct to create a binary tree.
+		 */
+		struct node {
+
+			T data;
+
+			node* left;
+
+			node* right;
+
+			node* parent;
+
+			node(const T& data, node* parent = nullptr)
+				: data{ data }, left{ nullptr }, right{ nullptr }, parent{ parent } { }
+
+			node(T&& data, node* parent = nullptr)
+				: data{ std::move(data) }, left{ nullptr }, right{ nullptr }, parent{ parent } { }
+		};
+
+	public:
+		class const_iterator {
+		public:
+
+			/**
+			 * Constructor for const iterator.
+			 */
+			const_iterator() : current{ nullptr }, tree{ nullptr }
+			{ }
+			/**
+			 * Returns the T stored at the current position.
+			*/
+			const T& operator*() const
+			{
+				return this->current->data;
+			}
+			/**
+			 * Moves to the next larger element. Iterating does not splay.
+			*/
+			const_iterator& operator++()
+			{
+				if (this->current->right != nullptr) {
+					this->current = leftmost(this->current->right);
+				}
+				else {
+					auto* child = this->current;
+					this->current = this->current->parent;
+					while (this->current != nullptr && child == this->current->right) {
+						child = this->current;
+						this->current = this->current->parent;
+					}
+				}
+				return *this;
+			}
+			/**
+			 * Overload of ++ operator to work with const iterator.
+			*/
+			const_iterator operator++(int)
+			{
+				auto old = *this;
+				++(*this);
+				return old;
+			}
+			/**
+			 * Moves to the next smaller element, from end() to the largest one.
+			*/
+			const_iterator& operator--()
+			{
+				if (this->current == nullptr) {
+					this->current = rightmost(this->tree->root);
+				}
+				else if (this->current->left != nullptr) {
+					this->current = rightmost(this->current->left);
+				}
+				else {
+					auto* child = this->current;
+					this->current = this->current->parent;
+					while (this->current != nullptr && child == this->current->left) {
+						child = this->current;
+						this->current = this->current->parent;
+					}
+				}
+				return *this;
+			}
+			/**
+			 * Overload of -- operator to work with const iterator.
+			*/
+			const_iterator operator--(int)
+			{
+				auto old = *this;
+				--(*this);
+				return old;
+			}
+			/**
+			 * Overload of == operator for comparison.
+			*/
+			bool operator==(const const_iterator& rhs) const
+			{
+				return this->current == rhs.current;
+			}
+			/**
+			 * Overload of != operator for comparison.
+			*/
+			bool operator!=(const const_iterator& rhs) const
+			{
+				return !(*this == rhs);
+			}
+
+		protected:
+			node* current;
+
+			const splay_tree* tree;
+
+			// Protected constructor for const_iterator.
+			// Expects the current node, nullptr for end.
+			const_iterator(node* position, const splay_tree* tree) : current{ position }, tree{ tree }
+			{ }
+
+			friend class splay_tree<T, Compare>;
+		};
+
+		/**
+		 * Elements are keys, so the tree only hands out constant access.
+		 */
+		typedef const_iterator iterator;
+
+	public:
+		splay_tree() : my_size{ 0 }, root{ nullptr }
+		{ }
+
+		~splay_tree()
+		{
+			this->clear();
+		}
+
+		/**
+		 * Constructs a copy of rhs with the same shape, so the copy keeps what rhs has learned.
+		 */
+		splay_tree(const splay_tree& rhs) : my_size{ rhs.my_size }, root{ nullptr }, compare{ rhs.compare }
+		{
+			if (rhs.root == nullptr) {
+				return;
+			} // else, copy node by node, do_nothing();
+
+			// Walk rhs with its parent links, creating each node the first time we reach it.
+			this->root = this->pool.create(rhs.root->data);
+			auto* source = rhs.root;
+			auto* copy = this->root;
+			try {
+				while (source != nullptr) {
+					if (source->left != nullptr && copy->left == nullptr) {
+						copy->left = this->pool.create(source->left->data, copy);
+						source = source->left;
+						copy = copy->left;
+					}
+					else if (source->right != nullptr && copy->right == nullptr) {
+						copy->right = this->pool.create(source->right->data, copy);
+						source = source->right;
+						copy = copy->right;
+					}
+					else {
+						source = source->parent;
+						copy = copy->parent;
+					}
+				}
+			}
+			catch (...) {
+				// The nodes copied so far form a valid tree, destroy them before the pool goes.
+				this->clear();
+				throw;
+			}
+		}
+
+		splay_tree& operator=(const splay_tree& rhs)
+		{
+			auto copy = rhs;
+			std::swap(*this, copy);
+			return *this;
+		}
+
+		splay_tree(splay_tree&& rhs)
+			: my_size{ rhs.my_size }, root{ rhs.root }, pool{ std::move(rhs.pool) }, compare{ rhs.compare }
+		{
+			rhs.my_size = 0;
+			rhs.root = nullptr;
+		}
+
+		splay_tree& operator=(splay_tree&& rhs)
+		{
+			std::swap(this->my_size, rhs.my_size);
+			std::swap(this->root, rhs.root);
+			this->pool.swap(rhs.pool);
+			std::swap(this->compare, rhs.compare);
+			return *this;
+		}
+
+		/**
+		 * Return iterator to the smallest element.
+		 */
+		const_iterator begin() const
+		{
+			return const_iterator(this->root == nullptr ? nullptr : leftmost(this->root), this);
+		}
+
+		/**
+		 * Return iterator representing end marker of tree.
+		 */
+		const_iterator end() const
+		{
+			return const_iterator(nullptr, this);
+		}
+
+		/**
+		* Returns size of the tree.
+		*/
+		int size() const
+		{
+			return this->my_size;
+		}
+		/**
+		* Checks if tree is empty.
+		*/
+		bool empty() const
+		{
+			return this->size() == 0;
+		}
+		/**
+		* Clears the tree. The nodes go back to the pool for reuse.
+		*/
+		void clear()
+		{
+			// Rotate left children up until the root has none, then free it and go right.
+			auto* current = this->root;
+			while (current != nullptr) {
+				if (current->left != nullptr) {
+					auto* left = current->left;
+					current->left = left->right;
+					left->right = current;
+					current = left;
+				}
+				else {
+					auto* right = current->right;
+					this->pool.destroy(current);
+					current = right;
+				}
+			}
+			this->root = nullptr;
+			this->my_size = 0;
+		}
+
+		/**
+		 * Adds value unless an equivalent element is present, then splays it to the root.
+		 *
+		 * @param value the value to add to the tree.
+		 * @return true if value was added.
+		 */
+		bool insert(const T& value)
+		{
+			return this->emplace(value);
+		}
+
+		/**
+		 * Adds value unless an equivalent element is present, then splays it to the root.
+		 *
+		 * @param value the value to add to the tree.
+		 * @return true if value was added.
+		 */
+		bool insert(T&& value)
+		{
+			return this->emplace(std::move(value));
+		}
+
+		/**
+		 * Removes the element equivalent to key.
+		 *
+		 * @param key is the value to remove.
+		 * @return true if an element was removed.
+		 */
+		bool erase(const T& key)
+		{
+			if (!this->find(key)) {
+				return false;
+			} // else, key is now at the root, do_nothing();
+			this->remove_root();
+			return true;
+		}
+
+		/**
+		 * Removes the element at position.
+		 *
+		 * @param position the element to remove.
+		 * @return an iterator to the next larger element.
+		 */
+		const_iterator erase(const_iterator position)
+		{
+			auto next = position;
+			++next;
+			this->splay(position.current);
+			this->remove_root();
+			return next;
+		}
+
+		/**
+		 * Locates search key and splays it to the root. On a miss the last
+		 * node visited is splayed instead, which keeps the amortized bound.
+		 *
+		 * @param key is the value to search the tree for.
+		 */
+		bool find(const T& key)
+		{
+			auto* current = this->root;
+			node* last = nullptr;
+			while (current != nullptr) {													// Amortized O(log n) steps.
+				last = current;
+				if (this->compare(key, current->data)) {
+					current = current->left;
+				}
+				else if (this->compare(current->data, key)) {
+					current = current->right;
+				}
+				else {
+					this->splay(current);
+					return true;
+				}
+			}
+			if (last != nullptr) {
+				this->splay(last);
+			} // else, the tree is empty, do_nothing();
+			return false;
+		}
+
+		/**
+		 * Returns whether key is in the tree without splaying.
+		 *
+		 * @param key is the value to search the tree for.
+		 */
+		bool contains(const T& key) const
+		{
+			auto* current = this->root;
+			while (current != nullptr) {
+				if (this->compare(key, current->data)) {
+					current = current->left;
+				}
+				else if (this->compare(current->data, key)) {
+					current = current->right;
+				}
+				else {
+					return true;
+				}
+			}
+			return false;
+		}
+
+		/**
+		 * Returns the element at the root, the most recently accessed one.
+		 */
+		const T& top() const
+		{
+			return this->root->data;
+		}
+
+		friend std::ostream& operator<<(std::ostream& out, const splay_tree& tree)
+		{
+			if (tree.empty()) {
+				out << "Empty tree";
+			}
+			else {
+				for (auto& value : tree) {
+					out << value << " ";
+				}
+			}
+
+			return out;
+		}
+
+	private:
+		/**
+		 * The current number of nodes in the tree.
+		 */
+		int my_size;
+		/**
+		 * The most recently accessed node.
+		 */
+		node* root;
+		/**
+		 * Storage for every node of this tree.
+		 */
+		node_pool<node> pool;
+		/**
+		 * The ordering of the elements.
+		 */
+		Compare compare;
+
+		static node* leftmost(node* current)
+		{
+			while (current->left != nullptr) {
+				current = current->left;
+			}
+			return current;
+		}
+
+		static node* rightmost(node* current)
+		{
+			while (current->right != nullptr) {
+				current = current->right;
+			}
+			return current;
+		}
+
+		/**
+		* Inserts a new node below the node where the search for value ends.
+		*/
+		template <typename Value>
+		bool emplace(Value&& value)
+		{
+			auto* current = this->root;
+			node* parent = nullptr;
+			auto goes_left = false;
+			while (current != nullptr) {
+				parent = current;
+				if (this->compare(value, current->data)) {
+					goes_left = true;
+					current = current->left;
+				}
+				else if (this->compare(current->data, value)) {
+					goes_left = false;
+					current = current->right;
+				}
+				else {
+					this->splay(current);
+					return false;
+				}
+			}
+
+			auto* created = this->pool.create(std::forward<Value>(value), parent);
+			if (parent == nullptr) {
+				this->root = created;
+			}
+			else if (goes_left) {
+				parent->left = created;
+			}
+			else {
+				parent->right = created;
+			}
+			this->my_size++;
+			this->splay(created);
+			return true;
+		}
+
+		/**
+		* Rotates current above its parent, keeping the search order.
+		*/
+		void rotate(node* current)
+		{
+			auto* parent = current->parent;
+			auto* grandparent = parent->parent;
+			if (current == parent->left) {
+				parent->left = current->right;
+				if (current->right != nullptr) {
+					current->right->parent = parent;
+				} // else, there is no subtree to hand over, do_nothing();
+				current->right = parent;
+			}
+			else {
+				parent->right = current->left;
+				if (current->left != nullptr) {
+					current->left->parent = parent;
+				} // else, there is no subtree to hand over, do_nothing();
+				current->left = parent;
+			}
+			parent->parent = current;
+			current->parent = grandparent;
+
+			if (grandparent == nullptr) {
+				this->root = current;
+			}
+			else if (grandparent->left == parent) {
+				grandparent->left = current;
+			}
+			else {
+				grandparent->right = current;
+			}
+		}
+
+		/**
+		* Moves current to the root with zig, zig-zig and zig-zag steps.
+		*/
+		void splay(node* current)
+		{
+			while (current->parent != nullptr) {
+				auto* parent = current->parent;
+				auto* grandparent = parent->parent;
+				if (grandparent == nullptr) {
+					this->rotate(current);
+				}
+				else if ((current == parent->left) == (parent == grandparent->left)) {
+					this->rotate(parent);
+					this->rotate(current);
+				}
+				else {
+					this->rotate(current);
+					this->rotate(current);
+				}
+			}
+		}
+
+		/**
+		* Frees the root and joins its two subtrees: the largest element on the
+		* left is splayed up, leaving it no right child to take the right subtree.
+		*/
+		void remove_root()
+		{
+			auto* removed = this->root;
+			auto* left = removed->left;
+			auto* right = removed->right;
+			if (left == nullptr) {
+				this->root = right;
+			}
+			else {
+				left->parent = nullptr;
+				this->root = left;
+				this->splay(rightmost(left));
+				this->root->right = right;
+			}
+			if (this->root != nullptr) {
+				this->root->parent = nullptr;
+				if (right != nullptr && this->root != right) {
+					right->parent = this->root;
+				} // else, right is the root or there is none, do_nothing();
+			} // else, the tree is now empty, do_nothing();
+			this->pool.destroy(removed);
+			this->my_size--;
+		}
+	};
+
+}
+
+#endif
@@ -0,0 +1,319 @@
+#ifndef SELF_ADJUSTING_STATIC_ARRAY_H
+#define SELF_ADJUSTING_STATIC_ARRAY_H
+
+#include <array>
+#include <initializer_list>
+#include <stdexcept>
+#include <type_traits>
+#include <utility>
+
+#include "adjustment_policy.h"
+
+namespace nwacc {
+
+	/**
+	 * Fixed-capacity self-adjusting array for small alphabets such as opcodes
+	 * or protocol tags.
+	 *
+	 * The elements live in a std::array inside the object, so there is no
+	 * heap at all, and every operation is constexpr: a table can be built,
+	 * and even searched, at compile time and used as a constant. find moves
+	 * the found element forward exactly like array_list::find with the same
+	 * Policy. The search always runs over all N slots, so the compiler can
+	 * unroll it; for arithmetic elements it has no branches at all and
+	 * becomes a handful of vector compares.
+	 *
+	 * @param T the element type. It must be default constructible, and a
+	 *        literal type for the array to be used in constant expressions.
+	 * @param N the maximum number of elements.
+	 * @param Policy how find reorganizes the array (see adjustment_policy.h).
+	 *        Policies that count accesses are not supported.
+	 */
+	template <typename T, int N, typename Policy = move_to_front>
+	class static_self_adjusting_array {
+
+		static_assert(N > 0, "static_self_adjusting_array needs room for at least one element");
+
+		static_assert(!Policy::k_counts_accesses, "static_self_adjusting_array has no access counters");
+
+	public:
+
+		typedef T* iterator;
+		typedef const T* const_iterator;
+
+		/**
+		 * Constructs an empty array.
+		 */
+		constexpr static_self_adjusting_array() : slots{ }, my_size{ 0 }
+		{ }
+
+		/**
+		 * Constructs an array holding values, in order.
+		 *
+		 * @param values at most N values.
+		 */
+		constexpr static_self_adjusting_array(std::initializer_list<T> values) : slots{ }, my_size{ 0 }
+		{
+			for (const auto& value : values) {
+				this->push_back(value);
+			}
+		}
+
+		/**
+		 * Returns the number of elements.
+		 */
+		constexpr int size() const
+		{
+			return this->my_size;
+		}
+
+		/**
+		 * Returns the maximum number of elements, N.
+		 */
+		static constexpr int capacity()
+		{
+			return N;
+		}
+
+		/**
+		 * Checks if the array is empty.
+		 */
+		constexpr bool empty() const
+		{
+			return this->my_size == 0;
+		}
+
+		/**
+		 * Checks if the array holds N elements.
+		 */
+		constexpr bool full() const
+		{
+			return this->my_size == N;
+		}
+
+		/**
+		 * Returns a reference to the element at position index.
+		 *
+		 * @param index the index at which to get the value.
+		 */
+		constexpr T& operator[](int index)
+		{
+			if (index < 0 || index >= this->my_size) {
+				throw std::out_of_range("Index out of range");
+			} // else, index is valid, do_nothing();
+
+			return this->slots[index];
+		}
+
+		/**
+		 * Returns a constant reference to the element at position index.
+		 *
+		 * @param index the index at which to get the value.
+		 */
+		constexpr const T& operator[](int index) const
+		{
+			if (index < 0 || index >= this->my_size) {
+				throw std::out_of_range("Index out of range");
+			} // else, index is valid, do_nothing();
+
+			return this->slots[index];
+		}
+
+		/**
+		 * Returns a constant reference to the first element.
+		 */
+		constexpr const T& front() const
+		{
+			return (*this)[0];
+		}
+
+		/**
+		 * Returns a constant reference to the last element.
+		 */
+		constexpr const T& back() const
+		{
+			return (*this)[this->my_size - 1];
+		}
+
+		constexpr iterator begin()
+		{
+			return this->slots.data();
+		}
+
+		constexpr const_iterator begin() const
+		{
+			return this->slots.data();
+		}
+
+		constexpr iterator end()
+		{
+			return this->slots.data() + this->my_size;
+		}
+
+		constexpr const_iterator end() const
+		{
+			return this->slots.data() + this->my_size;
+		}
+
+		/**
+		 * Adds a new element at the end of the array.
+		 *
+		 * @param value the value to add.
+		 */
+		constexpr void push_back(const T& value)
+		{
+			if (this->full()) {
+				throw std::length_error("Array is full");
+			} // else, there is room, do_nothing();
+
+			this->slots[this->my_size++] = value;
+		}
+
+		/**
+		 * Adds a new element at the end of the array, moving it in.
+		 *
+		 * @param value the value to add.
+		 */
+		constexpr void push_back(T&& value)
+		{
+			if (this->full()) {
+				throw std::length_error("Array is full");
+			} // else, there is room, do_nothing();
+
+			this->slots[this->my_size++] = std::move(value);
+		}
+
+		/**
+		 * Removes the last element. Its slot is reset to T{ }.
+		 */
+		constexpr void pop_back()
+		{
+			if (this->empty()) {
+				throw std::out_of_range("List is empty");
+			} // else, we have elements so remove the last one.
+
+			this->slots[--this->my_size] = T{ };
+		}
+
+		/**
+		 * Removes the first element equal to key. The order of the other elements is unchanged.
+		 *
+		 * @param key the value to remove.
+		 * @return true if key was found and removed.
+		 */
+		template <typename K>
+		constexpr bool erase(const K& key)
+		{
+			auto index = this->index_of(key);
+			if (index < 0) {
+				return false;
+			} // else, key was found at index, do_nothing();
+
+			for (; index + 1 < this->my_size; index++) {
+				this->slots[index] = std::move(this->slots[index + 1]);
+			}
+			this->slots[--this->my_size] = T{ };
+			return true;
+		}
+
+		/**
+		 * Removes every element.
+		 */
+		constexpr void clear()
+		{
+			while (!this->empty()) {
+				this->pop_back();
+			}
+		}
+
+		/**
+		 * Locates search key and moves it forward as decided by Policy.
+		 *
+		 * @param key is the value you are searching for.
+		 */
+		template <typename K>
+		constexpr bool find(const K& key)
+		{
+			auto index = this->index_of(key);												// O(N) unrolled for small N.
+			if (index < 0) {
+				return false;
+			} // else, key was found at index, do_nothing();
+
+			this->move_forward(index, index - Policy::steps(index, [] { return false; }));
+			return true;
+		}
+
+		/**
+		 * Returns whether key is in the array without changing any order.
+		 *
+		 * @param key is the value you are searching for.
+		 */
+		template <typename K>
+		constexpr bool contains(const K& key) const
+		{
+			return this->index_of(key) >= 0;
+		}
+
+		/**
+		 * Returns the index of the first element equal to key, or -1.
+		 *
+		 * @param key is the value you are searching for.
+		 */
+		template <typename K>
+		constexpr int index_of(const K& key) const
+		{
+			if constexpr (std::is_arithmetic<T>::value && std::is_arithmetic<K>::value) {
+				// Compare every slot without branching, keeping the smallest matching
+				// index: a min reduction the compiler unrolls into vector compares.
+				auto first = N;
+				for (auto index = 0; index < N; index++) {
+					auto candidate = key == this->slots[index] ? index : N;
+					first = candidate < first ? candidate : first;
+				}
+				return first < this->my_size ? first : -1;
+			} // else, comparisons may be costly, stop at the first match, do_nothing();
+
+			// The trip count is N, not size(), so the loop can be unrolled.
+			for (auto index = 0; index < N; index++) {
+				if (index == this->my_size) {
+					break;
+				} // else, index holds an element, do_nothing();
+
+				if (key == this->slots[index]) {
+					return index;
+				} // else, keep looking, do_nothing();
+			}
+			return -1;
+		}
+
+	private:
+		/**
+		 * The elements, the first my_size of them in use.
+		 */
+		std::array<T, N> slots;
+		/**
+		 * The current number of elements.
+		 */
+		int my_size;
+
+		/**
+		 * Rotates the element at from back to to, shifting the ones in between back one slot.
+		 * The same rotation as detail::move_forward, written out so it can run at compile time.
+		 */
+		constexpr void move_forward(int from, int to)
+		{
+			if (from <= to) {
+				return;
+			} // else, the element has somewhere to go, do_nothing();
+
+			auto moving = std::move(this->slots[from]);
+			for (auto index = from; index > to; index--) {
+				this->slots[index] = std::move(this->slots[index - 1]);
+			}
+			this->slots[to] = std::move(moving);
+		}
+	};
+
+}
+
+#endif
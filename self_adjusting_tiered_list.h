@@ -0,0 +1,209 @@
+#ifndef SELF_ADJUSTING_TIERED_LIST_H
+#define SELF_ADJUSTING_TIERED_LIST_H
+
+#include <algorithm>
+#include <functional>
+#include <unordered_set>
+
+#include "self_adjusting_array.h"
+
+namespace nwacc {
+
+	/**
+	 * A set split into a small move-to-front hot tier and a hashed cold tier.
+	 *
+	 * The hot tier is an array_list of at most hot_capacity elements, searched
+	 * linearly with vector compares exactly like array_list::find. Everything
+	 * else lives in an unordered_set. find looks in the hot tier first; on a
+	 * miss there it asks the cold tier, which costs O(1) instead of a scan of
+	 * the whole table. A key found in the cold tier is promoted to the front of
+	 * the hot tier, and when the hot tier is full its last (least recently
+	 * found) element is demoted to the cold tier to make room.
+	 *
+	 * A lookup therefore costs at most hot_capacity compares plus one hash
+	 * probe, however large the table grows, while keys in the hot set are found
+	 * as fast as in a small array_list. Elements are unique.
+	 *
+	 * @param T the element type, also used as the key.
+	 * @param Hash the hash function for T used by the cold tier.
+	 */
+	template <typename T, typename Hash = std::hash<T>>
+	class tiered_list {
+	public:
+
+		/**
+		 * The hot tier capacity used when none is given: a few cache lines of small keys.
+		 */
+		static const int k_default_hot_capacity = 64;
+
+		/**
+		 * Constructs an empty set.
+		 *
+		 * @param hot_capacity the most elements kept in the hot tier, at least 1.
+		 */
+		explicit tiered_list(int hot_capacity = k_default_hot_capacity) :
+			my_hot_capacity{ std::max(1, hot_capacity) }, hot(std::max(1, hot_capacity))
+		{ }
+
+		/**
+		 * Returns the number of elements in both tiers.
+		 */
+		int size() const
+		{
+			return this->hot.size() + static_cast<int>(this->cold.size());
+		}
+
+		/**
+		 * Checks if the set is empty.
+		 */
+		bool empty() const
+		{
+			return this->size() == 0;
+		}
+
+		/**
+		 * Returns the most elements the hot tier holds.
+		 */
+		int hot_capacity() const
+		{
+			return this->my_hot_capacity;
+		}
+
+		/**
+		 * Returns the number of elements in the hot tier.
+		 */
+		int hot_size() const
+		{
+			return this->hot.size();
+		}
+
+		/**
+		 * Returns the number of elements in the cold tier.
+		 */
+		int cold_size() const
+		{
+			return static_cast<int>(this->cold.size());
+		}
+
+		/**
+		 * Adds value unless it is already in the set. New elements fill the
+		 * hot tier from the back while it has room, and go to the cold tier
+		 * after that, until they are found.
+		 *
+		 * @param value the value to add.
+		 * @return true if value was added.
+		 */
+		bool insert(const T& value)
+		{
+			if (this->contains(value)) {
+				return false;
+			} // else, value is new, do_nothing();
+
+			if (this->hot.size() < this->my_hot_capacity) {
+				this->hot.push_back(value);
+			}
+			else {
+				this->cold.insert(value);
+			}
+			return true;
+		}
+
+		/**
+		 * Removes key from whichever tier holds it.
+		 *
+		 * @param key the value to remove.
+		 * @return true if key was in the set.
+		 */
+		bool erase(const T& key)
+		{
+			return this->hot.erase(key) || this->cold.erase(key) > 0;
+		}
+
+		/**
+		 * Removes every element.
+		 */
+		void clear()
+		{
+			this->hot.resize(0);
+			this->cold.clear();
+		}
+
+		/**
+		 * Returns whether key is in the set without moving anything.
+		 *
+		 * @param key is the value to search for.
+		 */
+		bool contains(const T& key) const
+		{
+			return this->hot.contains(key) || this->cold.count(key) > 0;
+		}
+
+		/**
+		 * Locates search key and moves it to the front of the hot tier,
+		 * demoting the last hot element if a cold key needs its slot.
+		 *
+		 * @param key is the value to search for.
+		 */
+		bool find(const T& key)
+		{
+			if (this->hot.find(key)) {																// O(hot_capacity) scan, promoted in place.
+				return true;
+			} // else, key is not hot, ask the cold tier, do_nothing();
+
+			auto cold_position = this->cold.find(key);											// O(1) expected.
+			if (cold_position == this->cold.end()) {
+				return false;
+			} // else, key is cold, promote it, do_nothing();
+
+			// Take key out before demoting, an insert may rehash and invalidate cold_position.
+			auto promoted = this->cold.extract(cold_position);
+			try {
+				if (this->hot.size() == this->my_hot_capacity) {
+					this->cold.insert(this->hot.back());
+					this->hot.pop_back();
+				} // else, the hot tier has room, do_nothing();
+				this->hot.push_front(promoted.value());										// O(hot_capacity) shift.
+			}
+			catch (...) {
+				// Copying a key failed; key goes back to the cold tier so the set keeps it.
+				this->cold.insert(std::move(promoted));
+				throw;
+			}
+			return true;
+		}																						// Overall O(hot_capacity) run-time.
+
+		/**
+		 * Calls visit with each element: the hot tier from front to back, then
+		 * the cold tier in no particular order.
+		 *
+		 * @param visit called with a constant reference to each element.
+		 */
+		template <typename Visitor>
+		void for_each(Visitor visit) const
+		{
+			for (const auto& value : this->hot) {
+				visit(value);
+			}
+			for (const auto& value : this->cold) {
+				visit(value);
+			}
+		}
+
+	private:
+		/**
+		 * The most elements the hot tier holds.
+		 */
+		int my_hot_capacity;
+		/**
+		 * The recently found elements, most recent first.
+		 */
+		array_list<T> hot;
+		/**
+		 * Every other element.
+		 */
+		std::unordered_set<T, Hash> cold;
+	};
+
+}
+
+#endif
@@ -0,0 +1,695 @@
+#ifndef SELF_ADJUSTING_UNROLLED_LIST_H
+#define SELF_ADJUSTING_UNROLLED_LIST_H
+
+#include <algorithm>
+#include <iostream>
+#include <type_traits>
+
+#if defined(_MSC_VER)
+#include <xmmintrin.h>
+#endif
+
+#include "array_kernels.h"
+#include "node_pool.h"
+
+namespace nwacc {
+	/**
+	 * Move-to-front list that stores its elements in a doubly linked list of
+	 * small arrays (blocks) instead of one node per element.
+	 *
+	 * Each block fills k_block_bytes, two cache lines, so a search reads
+	 * k_block_capacity elements contiguously (with the vector compares of
+	 * array_kernels.h) for every pointer it follows, and the two links are
+	 * shared by the whole block. find moves the element it found into the
+	 * first block: the gap it leaves is closed within its own block, and a
+	 * full first block is split in two to make room. Blocks that fall below
+	 * half full are merged with a neighbour, so memory stays within about
+	 * twice that of the elements themselves.
+	 *
+	 * Unlike linked_list, elements move between slots, so insert, erase and
+	 * find invalidate iterators.
+	 *
+	 * @param T the element type, which must be default constructible.
+	 */
+	template <typename T>
+	class unrolled_list {
+	public:
+
+		/**
+		 * The size of a block, header included.
+		 */
+		static constexpr int k_block_bytes = 128;
+
+		/**
+		 * The number of elements one block holds, at least 4.
+		 */
+		static constexpr int k_block_capacity =
+			std::max<int>(4, static_cast<int>((k_block_bytes - 2 * sizeof(void*) - sizeof(int)) / sizeof(T)));
+
+	private:
+		/**
+		 * Up to k_block_capacity elements, the first count of which are in use.
+		 */
+		struct alignas(64) block {
+
+			block* previous;
+
+			block* next;
+
+			int count;
+
+			T items[k_block_capacity];
+
+			block() : previous{ nullptr }, next{ nullptr }, count{ 0 }, items{ } { }
+		};
+
+	public:
+		class const_iterator {
+		public:
+
+			/**
+			 * Constructor for const iterator.
+			 */
+			const_iterator() : current{ nullptr }, index{ 0 }
+			{ }
+			/**
+			 * Returns the T stored at the current position.
+			*/
+			const T& operator*() const
+			{
+				return this->retrieve();
+			}
+			/**
+			 * Moves to the next element, into the next block after the last one in this block.
+			*/
+			const_iterator& operator++()
+			{
+				if (++this->index == this->current->count) {
+					this->current = this->current->next;
+					this->index = 0;
+				} // else, the next element is in the same block, do_nothing();
+				return *this;
+			}
+			/**
+			 * Overload of ++ operator to work with const iterator.
+			*/
+			const_iterator operator++(int)
+			{
+				auto old = *this;
+				++(*this);
+				return old;
+			}
+			/**
+			 * Moves to the previous element, into the previous block before the first one in this block.
+			*/
+			const_iterator& operator--()
+			{
+				if (this->index == 0) {
+					this->current = this->current->previous;
+					this->index = this->current->count;
+				} // else, the previous element is in the same block, do_nothing();
+				this->index--;
+				return *this;
+			}
+			/**
+			 * Overload of -- operator to work with const iterator.
+			*/
+			const_iterator operator--(int)
+			{
+				auto old = *this;
+				--(*this);
+				return old;
+			}
+			/**
+			 * Overload of == operator for comparison.
+			*/
+			bool operator==(const const_iterator& rhs) const
+			{
+				return this->current == rhs.current && this->index == rhs.index;
+			}
+			/**
+			 * Overload of != operator for comparison.
+			*/
+			bool operator!=(const const_iterator& rhs) const
+			{
+				return !(*this == rhs);
+			}
+
+		protected:
+			block* current;
+
+			int index;
+
+			// Protected helper in const_iterator that returns the T
+			// stored at the current position.
+			T& retrieve() const
+			{
+				return this->current->items[this->index];
+			}
+
+			// Protected constructor for const_iterator.
+			// Expects the block and the slot within it.
+			const_iterator(block* position, int index) : current{ position }, index{ index }
+			{ }
+
+			friend class unrolled_list<T>;
+		};
+
+		class iterator : public const_iterator {
+		public:
+
+			// Public constructor for iterator.
+			iterator()
+			{ }
+
+			T& operator*()
+			{
+				return const_iterator::retrieve();
+			}
+			/**
+			 * Return the T stored at the current position.
+			 */
+			const T& operator*() const
+			{
+				return const_iterator::operator*();
+			}
+			/**
+			 * Overloaded ++ operator to work with iterator.
+			 */
+			iterator& operator++()
+			{
+				const_iterator::operator++();
+				return *this;
+			}
+			/**
+			 * Overloaded ++ operator to work with iterator.
+			 */
+			iterator operator++(int)
+			{
+				auto old = *this;
+				++(*this);
+				return old;
+			}
+			/**
+			 * Overloaded -- operator to work with iterator.
+			 */
+			iterator& operator--()
+			{
+				const_iterator::operator--();
+				return *this;
+			}
+			/**
+			 * Overloaded -- operator to work with iterator.
+			 */
+			iterator operator--(int)
+			{
+				auto old = *this;
+				--(*this);
+				return old;
+			}
+
+		protected:
+			// Protected constructor for iterator.
+			// Expects the block and the slot within it.
+			iterator(block* position, int index) : const_iterator{ position, index }
+			{ }
+
+			friend class unrolled_list<T>;
+		};
+
+	public:
+		unrolled_list()
+		{
+			this->init();
+		}
+
+		~unrolled_list()
+		{
+			if (this->head != nullptr) {
+				this->clear();
+				this->pool.destroy(this->head);
+				this->pool.destroy(this->tail);
+			} // else, this list was moved from and owns no blocks, do_nothing();
+		}
+
+		unrolled_list(const unrolled_list& rhs)
+		{
+			this->init();
+			for (auto& value : rhs) {
+				this->push_back(value);
+			}
+		}
+
+		unrolled_list& operator=(const unrolled_list& rhs)
+		{
+			auto copy = rhs;
+			std::swap(*this, copy);
+			return *this;
+		}
+
+		unrolled_list(unrolled_list&& rhs)
+			: my_size{ rhs.my_size }, head{ rhs.head }, tail{ rhs.tail }, pool{ std::move(rhs.pool) }
+		{
+			rhs.my_size = 0;
+			rhs.head = nullptr;
+			rhs.tail = nullptr;
+		}
+
+		unrolled_list& operator=(unrolled_list&& rhs)
+		{
+			std::swap(this->my_size, rhs.my_size);
+			std::swap(this->head, rhs.head);
+			std::swap(this->tail, rhs.tail);
+			this->pool.swap(rhs.pool);
+			return *this;
+		}
+
+		/**
+		 * Return iterator representing beginning of list
+		 */
+		iterator begin()
+		{
+			return iterator(this->head->next, 0);
+		}
+
+		/**
+		 * Return iterator representing beginning of list
+		 */
+		const_iterator begin() const
+		{
+			return const_iterator(this->head->next, 0);
+		}
+
+		/**
+		 * Return iterator representing end marker of list
+		 */
+		iterator end()
+		{
+			return iterator(this->tail, 0);
+		}
+		/**
+		* Returns a const_iterator to the tail of the list.
+		*/
+		const_iterator end() const
+		{
+			return const_iterator(this->tail, 0);
+		}
+
+		/**
+		* Returns size of the list.
+		*/
+		int size() const
+		{
+			return this->my_size;
+		}
+		/**
+		* Checks if list is empty.
+		*/
+		bool empty() const
+		{
+			return this->size() == 0;
+		}
+		/**
+		* Returns the number of blocks holding elements.
+		*/
+		int blocks() const
+		{
+			auto count = 0;
+			for (auto* current = this->head->next; current != this->tail; current = current->next) {
+				count++;
+			}
+			return count;
+		}
+		/**
+		* Clears the list. The blocks go back to the pool for reuse.
+		*/
+		void clear()
+		{
+			auto* current = this->head->next;
+			while (current != this->tail) {
+				auto* next = current->next;
+				this->pool.destroy(current);
+				current = next;
+			}
+			this->head->next = this->tail;
+			this->tail->previous = this->head;
+			this->my_size = 0;
+		}
+
+		// front, back, push_front, push_back, pop_front, and pop_back
+		// are the basic double-ended queue operations.
+		T& front()
+		{
+			return *this->begin();
+		}
+		/**
+		* Returns value of the begining of the list.
+		*/
+		const T& front() const
+		{
+			return *this->begin();
+		}
+		/**
+		* Returns value of the end of the list.
+		*/
+		T& back()
+		{
+			return *--this->end();
+		}
+		/**
+		* Returns const value of the end of the list.
+		*/
+		const T& back() const
+		{
+			return *--this->end();
+		}
+		/**
+		 * Adds a new element at the front of the list.
+		 *
+		 * @param value the value to add to the list.
+		 */
+		void push_front(const T& value)
+		{
+			this->insert(this->begin(), value);
+		}
+		/**
+		 * Adds a new element at the end of the list, after its current last element.
+		 *
+		 * @param value the value to add to the list.
+		 */
+		void push_back(const T& value)
+		{
+			this->insert(this->end(), value);
+		}
+		/**
+		 * Adds a new element at the front of the list.
+		 *
+		 * @param value the value to add to the list.
+		*/
+		void push_front(T&& value)
+		{
+			this->insert(this->begin(), std::move(value));
+		}
+		/**
+		 * Adds a new element at the end of the list, after its current last element.
+		 *
+		* @param value the value to add to the list.
+		*/
+		void push_back(T&& value)
+		{
+			this->insert(this->end(), std::move(value));
+		}
+		/**
+		 * Erases element at the begining of the list.
+		*/
+		void pop_front()
+		{
+			this->erase(this->begin());
+		}
+		/**
+		* Erases element at the end of the list.
+		*/
+		void pop_back()
+		{
+			this->erase(--this->end());
+		}
+		/**
+		 * Inserts value in front of position, splitting its block if it is full.
+		 *
+		 * @param position the element to insert in front of.
+		 * @param value the value to insert.
+		 * @return an iterator to the inserted element.
+		 */
+		iterator insert(iterator position, const T& value)
+		{
+			auto copy = value;
+			return this->insert(position, std::move(copy));
+		}
+		/**
+		 * Inserts value in front of position, splitting its block if it is full.
+		 *
+		 * @param position the element to insert in front of.
+		 * @param value the value to insert.
+		 * @return an iterator to the inserted element.
+		 */
+		iterator insert(iterator position, T&& value)
+		{
+			auto inserted = this->place(position.current, position.index, std::move(value));
+			this->my_size++;
+			return inserted;
+		}
+		/**
+		 * Erases the element at position, merging its block with a neighbour if
+		 * it falls below half full.
+		 *
+		 * @param position is the element to be erased.
+		 * @return an iterator to the element that followed it.
+		 */
+		iterator erase(iterator position)
+		{
+			auto following = this->remove(position.current, position.index);
+			this->my_size--;
+			return following;
+		}
+		/**
+		 * Erases a range of elements.
+		 *
+		 * @param from is the starting position to be erased.
+		 * @param to is the ending position to be erased.
+		 */
+		iterator erase(iterator from, iterator to)
+		{
+			// to moves when its block is merged, so count the elements first.
+			auto count = 0;
+			for (auto position = from; position != to; ++position) {
+				count++;
+			}
+			auto position = from;
+			for (; count > 0; count--) {
+				position = erase(position);
+			}
+			return position;
+		}
+		/**
+		 * Locates search key and moves it to the front of list.
+		 * Each block is scanned as a small array while the next one is prefetched.
+		 *
+		 * @param key is the value to search the list for.
+		 */
+		bool find(const T& key)
+		{
+			for (auto* current = this->head->next; current != this->tail; current = current->next) {	// O(n / k_block_capacity) blocks.
+				prefetch(current->next);
+				auto index = detail::find_index(current->items, current->count, key);				// O(k_block_capacity) contiguous compares.
+				if (index >= 0) {
+					this->promote(current, index);													// O(k_block_capacity) shifting two blocks.
+					return true;
+				} // else, key is not in this block, do_nothing();
+			}
+			return false;
+		}																						// Method has an overall O(n) run-time.
+
+		friend std::ostream& operator<<(std::ostream& out, const unrolled_list& list)
+		{
+			if (list.empty()) {
+				out << "Empty list";
+			}
+			else {
+				for (auto& value : list) {
+					out << value << " ";
+				}
+			}
+
+			return out;
+		}
+
+	private:
+		/**
+		 * The current number of elements in the list.
+		 */
+		int my_size;
+		/**
+		 * Empty block in front of the first one.
+		 */
+		block* head;
+		/**
+		 * Empty block after the last one, end() points at it.
+		 */
+		block* tail;
+		/**
+		 * Storage for every block of this list, including head and tail.
+		 */
+		node_pool<block> pool;
+
+		/**
+		* Asks the processor to start loading a block into cache.
+		*/
+		static void prefetch(const block* address)
+		{
+#if defined(__GNUC__) || defined(__clang__)
+			__builtin_prefetch(address);
+			__builtin_prefetch(reinterpret_cast<const char*>(address) + 64);
+#elif defined(_MSC_VER)
+			_mm_prefetch(reinterpret_cast<const char*>(address), _MM_HINT_T0);
+			_mm_prefetch(reinterpret_cast<const char*>(address) + 64, _MM_HINT_T0);
+#else
+			(void)address;
+#endif
+		}
+
+		/**
+		* Initialization of list.
+		*/
+		void init()
+		{
+			this->my_size = 0;
+			this->head = this->pool.create();
+			this->tail = this->pool.create();
+			this->head->next = this->tail;
+			this->tail->previous = this->head;
+		}
+
+		/**
+		* Creates an empty block and links it in front of next.
+		*/
+		block* create_before(block* next)
+		{
+			auto* created = this->pool.create();
+			created->previous = next->previous;
+			created->next = next;
+			next->previous->next = created;
+			next->previous = created;
+			return created;
+		}
+
+		/**
+		* Unlinks an empty block and returns it to the pool.
+		*/
+		void destroy_block(block* current)
+		{
+			current->previous->next = current->next;
+			current->next->previous = current->previous;
+			this->pool.destroy(current);
+		}
+
+		/**
+		* Moves the upper half of a full block into a new block after it.
+		*/
+		void split(block* current)
+		{
+			auto* upper = this->create_before(current->next);
+			auto keep = current->count / 2;
+			std::move(current->items + keep, current->items + current->count, upper->items);
+			upper->count = current->count - keep;
+			this->clear_slots(current, keep);
+		}
+
+		/**
+		* Appends the elements of the block after current to current and frees that block.
+		*/
+		void merge_next(block* current)
+		{
+			auto* next = current->next;
+			std::move(next->items, next->items + next->count, current->items + current->count);
+			current->count += next->count;
+			next->count = 0;
+			this->destroy_block(next);
+		}
+
+		/**
+		* Resets the slots of current from index on to T{ } so they release any
+		* resources, and makes index the new count.
+		*/
+		void clear_slots(block* current, int index)
+		{
+			if constexpr (!std::is_trivially_destructible<T>::value) {
+				for (auto slot = index; slot < current->count; slot++) {
+					current->items[slot] = T{ };
+				}
+			} // else, stale slots hold nothing to release, do_nothing();
+			current->count = index;
+		}
+
+		/**
+		* Places value at slot index of current, shifting the rest of the block
+		* back. Inserting at end uses the last block while it has room.
+		*
+		* @return an iterator to the placed element.
+		*/
+		iterator place(block* current, int index, T&& value)
+		{
+			if (current == this->tail) {
+				current = this->tail->previous;
+				if (current == this->head || current->count == k_block_capacity) {
+					current = this->create_before(this->tail);
+				} // else, the last block has room, do_nothing();
+				index = current->count;
+			}
+			else if (current->count == k_block_capacity) {
+				this->split(current);
+				if (index > current->count) {
+					index -= current->count;
+					current = current->next;
+				} // else, index stays in the lower half, do_nothing();
+			} // else, current has room, do_nothing();
+
+			std::move_backward(current->items + index, current->items + current->count, current->items + current->count + 1);
+			current->items[index] = std::move(value);
+			current->count++;
+			return iterator(current, index);
+		}
+
+		/**
+		* Removes slot index of current and closes the gap. A block that empties
+		* is freed; one that drops below half full is merged with a neighbour
+		* when they fit in one block.
+		*
+		* @return an iterator to the element that followed the removed one.
+		*/
+		iterator remove(block* current, int index)
+		{
+			std::move(current->items + index + 1, current->items + current->count, current->items + index);
+			this->clear_slots(current, current->count - 1);
+
+			if (current->count == 0) {
+				auto* next = current->next;
+				this->destroy_block(current);
+				return iterator(next, 0);
+			} // else, current still holds elements, do_nothing();
+
+			if (current->count < k_block_capacity / 2) {
+				if (current->next != this->tail && current->count + current->next->count <= k_block_capacity) {
+					this->merge_next(current);
+				}
+				else if (current->previous != this->head && current->previous->count + current->count <= k_block_capacity) {
+					index += current->previous->count;
+					current = current->previous;
+					this->merge_next(current);
+				} // else, neither neighbour has room, do_nothing();
+			} // else, current is at least half full, do_nothing();
+
+			if (index == current->count) {
+				return iterator(current->next, 0);
+			} // else, the following element is in the same block, do_nothing();
+			return iterator(current, index);
+		}
+
+		/**
+		* Moves the element at slot index of current to the front of the list.
+		*/
+		void promote(block* current, int index)
+		{
+			if (current == this->head->next) {
+				detail::move_forward(current->items, index, 0);
+				return;
+			} // else, the element leaves its block for the first one, do_nothing();
+
+			auto value = std::move(current->items[index]);
+			this->remove(current, index);
+			this->place(this->head->next, 0, std::move(value));
+		}
+	};
+
+}
+
+#endif
@@ -0,0 +1,361 @@
+#ifndef SNAPSHOT_H
+#define SNAPSHOT_H
+
+#include <cstdint>
+#include <cstring>
+#include <fstream>
+#include <stdexcept>
+#include <string>
+#include <type_traits>
+#include <vector>
+
+#if defined(__unix__) || defined(__APPLE__)
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#define NWACC_HAS_MMAP 1
+#endif
+
+namespace nwacc {
+
+	/**
+	 * The fixed header at the start of every snapshot file.
+	 *
+	 * A snapshot holds a container's elements in their current order,
+	 * optionally preceded by one access_counter per element:
+	 *
+	 *     snapshot_header | counters (count x access_counter) | elements
+	 *
+	 * Trivially copyable elements are stored as their raw bytes, anything else
+	 * through snapshot_traits. Numbers are in the byte order of the machine
+	 * that wrote the file, so snapshots are meant to be reloaded by the same
+	 * build on the same platform.
+	 */
+	struct snapshot_header {
+
+		static const std::uint32_t k_version = 1;
+
+		/**
+		 * Set when the counters section is present.
+		 */
+		static const std::uint32_t k_has_counts = 1;
+
+		/**
+		 * Set when elements are stored as raw bytes of element_size each.
+		 */
+		static const std::uint32_t k_raw_elements = 2;
+
+		char magic[8];
+
+		std::uint32_t version;
+
+		std::uint32_t flags;
+
+		std::uint64_t count;
+
+		std::uint64_t element_size;
+	};
+
+	/**
+	 * Appends the sections of a snapshot to a file.
+	 */
+	class snapshot_writer {
+	public:
+
+		/**
+		 * Creates or truncates the file at path.
+		 *
+		 * @param path the file to write.
+		 */
+		explicit snapshot_writer(const std::string& path) : out{ path, std::ios::binary | std::ios::trunc }
+		{
+			if (!this->out) {
+				throw std::runtime_error("Cannot open snapshot for writing: " + path);
+			} // else, the file is open, do_nothing();
+		}
+
+		/**
+		 * Writes size bytes starting at bytes.
+		 */
+		void write_bytes(const void* bytes, std::size_t size)
+		{
+			this->out.write(static_cast<const char*>(bytes), static_cast<std::streamsize>(size));
+			if (!this->out) {
+				throw std::runtime_error("Cannot write snapshot");
+			} // else, the bytes were written, do_nothing();
+		}
+
+		/**
+		 * Writes the raw bytes of a trivially copyable value.
+		 */
+		template <typename U>
+		void write(const U& value)
+		{
+			static_assert(std::is_trivially_copyable<U>::value, "only trivially copyable values can be written raw");
+			this->write_bytes(&value, sizeof(U));
+		}
+
+		/**
+		 * Flushes the file, reporting any error instead of losing it in the destructor.
+		 */
+		void finish()
+		{
+			this->out.flush();
+			if (!this->out) {
+				throw std::runtime_error("Cannot write snapshot");
+			} // else, everything reached the file, do_nothing();
+		}
+
+	private:
+		std::ofstream out;
+	};
+
+	/**
+	 * Reads the sections of a snapshot from memory, typically a mapped file.
+	 * Every read is bounds checked against the end of the snapshot.
+	 */
+	class snapshot_reader {
+	public:
+
+		snapshot_reader(const char* bytes, std::size_t size) : cursor{ bytes }, end{ bytes + size }
+		{ }
+
+		/**
+		 * Copies the next size bytes to destination.
+		 */
+		void read_bytes(void* destination, std::size_t size)
+		{
+			std::memcpy(destination, this->take(size), size);
+		}
+
+		/**
+		 * Reads a trivially copyable value from its raw bytes.
+		 */
+		template <typename U>
+		U read()
+		{
+			static_assert(std::is_trivially_copyable<U>::value, "only trivially copyable values can be read raw");
+			U value;
+			this->read_bytes(&value, sizeof(U));
+			return value;
+		}
+
+		/**
+		 * Throws unless at least size more bytes can be read.
+		 */
+		void expect(std::size_t size) const
+		{
+			if (static_cast<std::size_t>(this->end - this->cursor) < size) {
+				throw std::runtime_error("Snapshot is truncated");
+			} // else, the bytes are there, do_nothing();
+		}
+
+		/**
+		 * Returns the next size bytes in place and moves past them.
+		 */
+		const char* take(std::size_t size)
+		{
+			this->expect(size);
+			auto* start = this->cursor;
+			this->cursor += size;
+			return start;
+		}
+
+	private:
+		const char* cursor;
+
+		const char* end;
+	};
+
+	/**
+	 * How an element that is not trivially copyable is written to and read from a snapshot.
+	 * Specialize it for your own types with
+	 *
+	 *     static void save(snapshot_writer& out, const T& value);
+	 *     static T load(snapshot_reader& in);
+	 *
+	 * Trivially copyable types need no specialization; they are stored raw.
+	 */
+	template <typename T>
+	struct snapshot_traits;
+
+	/**
+	 * Strings are stored as their length followed by their characters.
+	 */
+	template <typename Char, typename CharTraits, typename Allocator>
+	struct snapshot_traits<std::basic_string<Char, CharTraits, Allocator>> {
+
+		typedef std::basic_string<Char, CharTraits, Allocator> string_type;
+
+		static void save(snapshot_writer& out, const string_type& value)
+		{
+			out.write(static_cast<std::uint64_t>(value.size()));
+			out.write_bytes(value.data(), value.size() * sizeof(Char));
+		}
+
+		static string_type load(snapshot_reader& in)
+		{
+			auto length = in.read<std::uint64_t>();
+			auto* characters = in.take(length * sizeof(Char));
+			string_type value(length, Char());
+			std::memcpy(&value[0], characters, length * sizeof(Char));
+			return value;
+		}
+	};
+
+namespace detail {
+
+	/**
+	 * Whether T is stored as raw bytes in a snapshot.
+	 */
+	template <typename T>
+	struct is_raw_snapshot_element : std::is_trivially_copyable<T> { };
+
+	/**
+	 * The 8 bytes every snapshot starts with.
+	 */
+	inline const char* snapshot_magic()
+	{
+		return "NWACCSO1";
+	}
+
+	/**
+	 * Writes the header of a snapshot of count elements of type T.
+	 */
+	template <typename T>
+	void write_snapshot_header(snapshot_writer& out, std::uint64_t count, bool has_counts)
+	{
+		snapshot_header header{ };
+		std::memcpy(header.magic, snapshot_magic(), sizeof(header.magic));
+		header.version = snapshot_header::k_version;
+		header.flags = has_counts ? snapshot_header::k_has_counts : 0;
+		if constexpr (is_raw_snapshot_element<T>::value) {
+			header.flags |= snapshot_header::k_raw_elements;
+			header.element_size = sizeof(T);
+		} // else, elements go through snapshot_traits, do_nothing();
+		header.count = count;
+		out.write(header);
+	}
+
+	/**
+	 * Reads and checks the header of a snapshot of elements of type T, and
+	 * checks that the rest of the file can hold its counters, counter_size
+	 * bytes each, and its elements if they are raw, so that a truncated or
+	 * corrupt file fails before the container makes room for them.
+	 *
+	 * @param in the snapshot, positioned at its start.
+	 * @param max_count the most elements the container can hold.
+	 * @param counter_size the size of one saved access counter.
+	 */
+	template <typename T>
+	snapshot_header read_snapshot_header(snapshot_reader& in, std::uint64_t max_count, std::size_t counter_size)
+	{
+		auto header = in.read<snapshot_header>();
+		if (std::memcmp(header.magic, snapshot_magic(), sizeof(header.magic)) != 0) {
+			throw std::runtime_error("Not a snapshot");
+		} // else, the magic matches, do_nothing();
+		if (header.version != snapshot_header::k_version) {
+			throw std::runtime_error("Unsupported snapshot version");
+		} // else, we know this layout, do_nothing();
+
+		auto raw = (header.flags & snapshot_header::k_raw_elements) != 0;
+		if (raw != is_raw_snapshot_element<T>::value || (raw && header.element_size != sizeof(T))) {
+			throw std::runtime_error("Snapshot was written for a different element type");
+		} // else, the elements can be decoded as T, do_nothing();
+		if (header.count > max_count) {
+			throw std::runtime_error("Snapshot holds too many elements");
+		} // else, the count fits a container size, do_nothing();
+
+		std::uint64_t element_size = (header.flags & snapshot_header::k_has_counts) != 0 ? counter_size : 0;
+		if (raw) {
+			element_size += sizeof(T);
+		} // else, the size of each element is only known once it is decoded, do_nothing();
+		in.expect(static_cast<std::size_t>(header.count * element_size));
+		return header;
+	}
+
+	/**
+	 * A whole file, read-only. On POSIX systems it is memory mapped, so
+	 * loading a snapshot (or replaying a trace) reads each page once, straight
+	 * from the page cache; elsewhere the file is read into a buffer.
+	 */
+	class mapped_file {
+	public:
+
+		explicit mapped_file(const std::string& path) : bytes{ nullptr }, my_size{ 0 }
+		{
+#if defined(NWACC_HAS_MMAP)
+			auto descriptor = ::open(path.c_str(), O_RDONLY);
+			if (descriptor < 0) {
+				throw std::runtime_error("Cannot open file: " + path);
+			} // else, the file is open, do_nothing();
+
+			struct stat status;
+			if (::fstat(descriptor, &status) != 0) {
+				::close(descriptor);
+				throw std::runtime_error("Cannot read file: " + path);
+			} // else, we know the size, do_nothing();
+
+			this->my_size = static_cast<std::size_t>(status.st_size);
+			if (this->my_size > 0) {
+				auto* mapped = ::mmap(nullptr, this->my_size, PROT_READ, MAP_PRIVATE, descriptor, 0);
+				if (mapped == MAP_FAILED) {
+					::close(descriptor);
+					throw std::runtime_error("Cannot map file: " + path);
+				} // else, the file is mapped, do_nothing();
+				::madvise(mapped, this->my_size, MADV_SEQUENTIAL);
+				this->bytes = static_cast<const char*>(mapped);
+			} // else, an empty file has nothing to map, do_nothing();
+			::close(descriptor);
+#else
+			std::ifstream in(path, std::ios::binary | std::ios::ate);
+			if (!in) {
+				throw std::runtime_error("Cannot open file: " + path);
+			} // else, the file is open, do_nothing();
+			this->buffer.resize(static_cast<std::size_t>(in.tellg()));
+			in.seekg(0);
+			in.read(this->buffer.data(), static_cast<std::streamsize>(this->buffer.size()));
+			this->bytes = this->buffer.data();
+			this->my_size = this->buffer.size();
+#endif
+		}
+
+		mapped_file(const mapped_file&) = delete;
+
+		mapped_file& operator=(const mapped_file&) = delete;
+
+		~mapped_file()
+		{
+#if defined(NWACC_HAS_MMAP)
+			if (this->bytes != nullptr) {
+				::munmap(const_cast<char*>(this->bytes), this->my_size);
+			} // else, nothing was mapped, do_nothing();
+#endif
+		}
+
+		const char* data() const
+		{
+			return this->bytes;
+		}
+
+		std::size_t size() const
+		{
+			return this->my_size;
+		}
+
+	private:
+		const char* bytes;
+
+		std::size_t my_size;
+
+#if !defined(NWACC_HAS_MMAP)
+		std::vector<char> buffer;
+#endif
+	};
+
+}
+
+}
+
+#endif
@@ -0,0 +1,392 @@
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <iomanip>
+#include <iostream>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+#include "access_stats.h"
+#include "adjustment_policy.h"
+#include "self_adjusting_array.h"
+#include "self_adjusting_list.h"
+#include "snapshot.h"
+
+namespace {
+
+	/**
+	 * A trace with every distinct key replaced by a dense id, 0 for the
+	 * first key to appear, 1 for the next new one, and so on.
+	 */
+	struct trace {
+
+		std::vector<int> accesses;
+
+		/**
+		 * The number of accesses to each id.
+		 */
+		std::vector<std::uint64_t> frequencies;
+
+		int distinct() const
+		{
+			return static_cast<int>(this->frequencies.size());
+		}
+	};
+
+	/**
+	 * Appends the id of key to the trace, giving key the next id if it is new.
+	 */
+	template <typename Key>
+	void record(trace& result, std::unordered_map<Key, int>& ids, const Key& key)
+	{
+		auto inserted = ids.emplace(key, result.distinct());
+		if (inserted.second) {
+			result.frequencies.push_back(0);
+		} // else, key was seen before, do_nothing();
+		result.accesses.push_back(inserted.first->second);
+		result.frequencies[inserted.first->second]++;
+	}
+
+	/**
+	 * Reads whitespace separated keys of any text, e.g. one per line.
+	 * The keys are viewed in place in the mapped file, never copied.
+	 */
+	trace read_text(const char* bytes, std::size_t size)
+	{
+		trace result;
+		std::unordered_map<std::string_view, int> ids;
+		auto is_space = [](char character) {
+			return character == ' ' || character == '\t' || character == '\n' || character == '\r';
+		};
+		std::size_t position = 0;
+		while (position < size) {
+			while (position < size && is_space(bytes[position])) {
+				position++;
+			}
+			auto start = position;
+			while (position < size && !is_space(bytes[position])) {
+				position++;
+			}
+			if (position > start) {
+				record(result, ids, std::string_view(bytes + start, position - start));
+			} // else, only whitespace was left, do_nothing();
+		}
+		return result;
+	}
+
+	/**
+	 * Reads a packed array of fixed width binary keys in the byte order of this machine.
+	 */
+	template <typename Key>
+	trace read_binary(const char* bytes, std::size_t size)
+	{
+		if (size % sizeof(Key) != 0) {
+			throw std::runtime_error("Binary trace size is not a multiple of the key width");
+		} // else, the file holds whole keys, do_nothing();
+
+		trace result;
+		std::unordered_map<Key, int> ids;
+		result.accesses.reserve(size / sizeof(Key));
+		for (std::size_t offset = 0; offset < size; offset += sizeof(Key)) {
+			Key key;
+			std::memcpy(&key, bytes + offset, sizeof(Key));
+			record(result, ids, key);
+		}
+		return result;
+	}
+
+	/**
+	 * What one replay cost.
+	 */
+	struct replay_result {
+
+		std::string container;
+
+		std::string policy;
+
+		/**
+		 * The sum over all accesses of the 1-based position the key was found at.
+		 */
+		std::uint64_t cost;
+
+		std::uint64_t elements_shifted;
+
+		double milliseconds;
+	};
+
+	/**
+	 * Loads every id into List in order of first appearance, then looks up each access in turn.
+	 */
+	template <typename List>
+	replay_result replay(const trace& keys, const std::string& container, const std::string& policy)
+	{
+		List list;
+		for (auto id = 0; id < keys.distinct(); id++) {
+			list.push_back(id);
+		}
+
+		auto start = std::chrono::steady_clock::now();
+		for (auto id : keys.accesses) {
+			list.find(id);
+		}
+		auto elapsed = std::chrono::steady_clock::now() - start;
+
+		auto counters = list.statistics().snapshot();
+		return replay_result{ container, policy, counters.total_hit_depth + counters.hits, counters.elements_shifted,
+			std::chrono::duration<double, std::milli>(elapsed).count() };
+	}
+
+	/**
+	 * Returns the cost of serving the trace from the best fixed order: most
+	 * frequently accessed key first, never reordered. It is chosen knowing the
+	 * whole trace and set up for free, so on short traces it can even beat the
+	 * optimum bound, which starts from the order of first appearance.
+	 */
+	std::uint64_t static_frequency_cost(const trace& keys)
+	{
+		auto frequencies = keys.frequencies;
+		std::sort(frequencies.begin(), frequencies.end(), std::greater<std::uint64_t>());
+		std::uint64_t cost = 0;
+		for (std::size_t rank = 0; rank < frequencies.size(); rank++) {
+			cost += frequencies[rank] * (rank + 1);
+		}
+		return cost;
+	}
+
+	/**
+	 * A lower bound on the cost of the offline optimum.
+	 */
+	struct optimum_bound {
+
+		std::uint64_t cost;
+
+		/**
+		 * The number of most frequent keys whose pairs were included.
+		 */
+		int keys;
+
+		/**
+		 * The share of accesses that went to those keys.
+		 */
+		double coverage;
+	};
+
+	/**
+	 * Returns the pairwise lower bound on the cost of an optimal offline
+	 * algorithm that starts from the same order and may reorder freely at a
+	 * price of 1 per swap of neighbours (moving the found key forward is free).
+	 *
+	 * Every access costs 1 plus the number of keys in front of the found key,
+	 * so any algorithm's cost is m plus, over every pair of keys, the number
+	 * of accesses to one of the two while the other was in front of it. For
+	 * one pair on its own, the cheapest way to serve the trace restricted to
+	 * those two keys is found exactly with two states (which key is in
+	 * front), and the optimum can do no better on any pair, so the sum of
+	 * these pair optima bounds it from below. (Computing the optimum itself is
+	 * NP-hard.)
+	 *
+	 * Every access to a key updates the pairs it forms with all other keys, so
+	 * only the most frequent keys are included, as many as fit work_budget
+	 * pair updates. Leaving pairs out only lowers the bound.
+	 */
+	optimum_bound pairwise_lower_bound(const trace& keys, double work_budget)
+	{
+		std::vector<int> by_frequency(keys.distinct());
+		for (auto id = 0; id < keys.distinct(); id++) {
+			by_frequency[id] = id;
+		}
+		std::stable_sort(by_frequency.begin(), by_frequency.end(), [&keys](int lhs, int rhs) {
+			return keys.frequencies[lhs] > keys.frequencies[rhs];
+		});
+
+		// Grow the key set while the pair updates still fit the budget.
+		const int k_max_keys = 2048;
+		auto included = 0;
+		std::uint64_t included_accesses = 0;
+		while (included < std::min(keys.distinct(), k_max_keys)) {
+			auto accesses = included_accesses + keys.frequencies[by_frequency[included]];
+			if (included > 0 && static_cast<double>(accesses) * included > work_budget) {
+				break;
+			} // else, one more key fits, do_nothing();
+			included_accesses = accesses;
+			included++;
+		}
+
+		std::vector<int> slot(keys.distinct(), -1);
+		for (auto rank = 0; rank < included; rank++) {
+			slot[by_frequency[rank]] = rank;
+		}
+
+		// For each pair (low, high) of slots, the cheapest cost so far with low
+		// in front and with high in front. Ids are in order of first appearance,
+		// which is also the starting order of the list.
+		auto pair_index = [included](int low, int high) {
+			return static_cast<std::size_t>(low) * (2 * included - low - 1) / 2 + (high - low - 1);
+		};
+		auto pairs = static_cast<std::size_t>(included) * std::max(0, included - 1) / 2;
+		std::vector<std::uint64_t> low_front(pairs);
+		std::vector<std::uint64_t> high_front(pairs);
+		for (auto low = 0; low < included; low++) {
+			for (auto high = low + 1; high < included; high++) {
+				auto low_starts_in_front = by_frequency[low] < by_frequency[high];
+				low_front[pair_index(low, high)] = low_starts_in_front ? 0 : 1;
+				high_front[pair_index(low, high)] = low_starts_in_front ? 1 : 0;
+			}
+		}
+
+		for (auto id : keys.accesses) {
+			auto accessed = slot[id];
+			if (accessed < 0) {
+				continue;
+			} // else, the key is in the bound, do_nothing();
+
+			// Found in front costs nothing; found behind costs 1 and may then move
+			// forward for free; any swap between accesses costs 1.
+			for (auto other = 0; other < accessed; other++) {
+				auto index = pair_index(other, accessed);
+				auto served_in_front = high_front[index];
+				auto served_behind = low_front[index] + 1;
+				high_front[index] = std::min(served_in_front, served_behind);
+				low_front[index] = std::min(served_behind, served_in_front + 1);
+			}
+			for (auto other = accessed + 1; other < included; other++) {
+				auto index = pair_index(accessed, other);
+				auto served_in_front = low_front[index];
+				auto served_behind = high_front[index] + 1;
+				low_front[index] = std::min(served_in_front, served_behind);
+				high_front[index] = std::min(served_behind, served_in_front + 1);
+			}
+		}
+
+		std::uint64_t cost = keys.accesses.size();
+		for (std::size_t index = 0; index < pairs; index++) {
+			cost += std::min(low_front[index], high_front[index]);
+		}
+		auto coverage = keys.accesses.empty() ? 0.0 : static_cast<double>(included_accesses) / keys.accesses.size();
+		return optimum_bound{ cost, included, coverage };
+	}
+
+	/**
+	 * Throws unless the replays agree with each other and with the bound:
+	 * both containers apply the same rule under one policy, so they must find
+	 * every key at the same depth and cost the same, and no policy can beat the
+	 * lower bound on the offline optimum.
+	 */
+	void check_consistent(const std::vector<replay_result>& results, const optimum_bound& bound)
+	{
+		for (const auto& result : results) {
+			if (result.cost < bound.cost) {
+				throw std::logic_error(result.container + " " + result.policy + " costs less than the optimum bound");
+			} // else, the bound holds, do_nothing();
+
+			for (const auto& other : results) {
+				if (other.policy == result.policy && other.cost != result.cost) {
+					throw std::logic_error(result.container + " and " + other.container + " disagree on the cost of " + result.policy);
+				} // else, the replays agree, do_nothing();
+			}
+		}
+	}
+
+}
+
+/**
+ * Usage: trace_replay trace [format=text] [bound_work=4e8]
+ *
+ * Replays a recorded key trace against array_list::find and linked_list::find
+ * under move_to_front, transpose and frequency_count, and reports for each the
+ * total access cost (sum of 1-based positions), elements shifted and wall time,
+ * next to the cost of the static most-frequent-first order and a lower bound on
+ * the offline optimum.
+ *
+ * format is text (keys of any characters separated by whitespace, e.g. one per
+ * line), u32 or u64 (packed binary keys in native byte order). The trace is
+ * memory mapped. Every distinct key is in the list from the start, in order of
+ * first appearance, so a replay costs O(accesses x distinct keys) in the worst case.
+ * bound_work caps the pair updates spent on the lower bound (see pairwise_lower_bound).
+ * Exits with 1 if the replays contradict each other or the bound (see check_consistent).
+ */
+int main(int argc, char* argv[])
+{
+	if (argc < 2) {
+		std::cerr << "usage: " << argv[0] << " trace [text|u32|u64] [bound_work]" << std::endl;
+		return 2;
+	} // else, there is a trace to replay, do_nothing();
+
+	std::string format = argc > 2 ? argv[2] : "text";
+	auto bound_work = argc > 3 ? std::atof(argv[3]) : 4e8;
+
+	try {
+		nwacc::detail::mapped_file file(argv[1]);
+		trace keys;
+		if (format == "text") {
+			keys = read_text(file.data(), file.size());
+		}
+		else if (format == "u32") {
+			keys = read_binary<std::uint32_t>(file.data(), file.size());
+		}
+		else if (format == "u64") {
+			keys = read_binary<std::uint64_t>(file.data(), file.size());
+		}
+		else {
+			throw std::runtime_error("Unknown trace format: " + format);
+		}
+
+		auto accesses = keys.accesses.size();
+		std::cout << accesses << " accesses to " << keys.distinct() << " distinct keys" << std::endl;
+		if (accesses == 0) {
+			return 0;
+		} // else, there is something to replay, do_nothing();
+
+		using nwacc::access_stats;
+		std::vector<replay_result> results;
+		results.push_back(replay<nwacc::array_list<int, nwacc::move_to_front, access_stats>>(keys, "array_list", "move_to_front"));
+		results.push_back(replay<nwacc::array_list<int, nwacc::transpose, access_stats>>(keys, "array_list", "transpose"));
+		results.push_back(replay<nwacc::array_list<int, nwacc::frequency_count, access_stats>>(keys, "array_list", "frequency_count"));
+		results.push_back(replay<nwacc::linked_list<int, nwacc::move_to_front, access_stats>>(keys, "linked_list", "move_to_front"));
+		results.push_back(replay<nwacc::linked_list<int, nwacc::transpose, access_stats>>(keys, "linked_list", "transpose"));
+		results.push_back(replay<nwacc::linked_list<int, nwacc::frequency_count, access_stats>>(keys, "linked_list", "frequency_count"));
+
+		auto static_cost = static_frequency_cost(keys);
+		auto bound = pairwise_lower_bound(keys, bound_work);
+		check_consistent(results, bound);
+
+		std::cout << std::left << std::setw(13) << "container" << std::setw(17) << "policy"
+			<< std::right << std::setw(16) << "cost" << std::setw(10) << "/access"
+			<< std::setw(10) << "/static" << std::setw(10) << "/bound"
+			<< std::setw(16) << "shifted" << std::setw(12) << "ms" << std::setw(12) << "ns/access" << std::endl;
+		for (const auto& result : results) {
+			std::cout << std::left << std::setw(13) << result.container << std::setw(17) << result.policy
+				<< std::right << std::fixed << std::setprecision(2)
+				<< std::setw(16) << result.cost
+				<< std::setw(10) << static_cast<double>(result.cost) / accesses
+				<< std::setw(10) << static_cast<double>(result.cost) / static_cost
+				<< std::setw(10) << static_cast<double>(result.cost) / bound.cost
+				<< std::setw(16) << result.elements_shifted
+				<< std::setw(12) << result.milliseconds
+				<< std::setw(12) << result.milliseconds * 1e6 / accesses << std::endl;
+		}
+		std::cout << std::left << std::setw(30) << "static frequency order"
+			<< std::right << std::setw(16) << static_cost
+			<< std::setw(10) << static_cast<double>(static_cost) / accesses
+			<< std::setw(10) << 1.0
+			<< std::setw(10) << static_cast<double>(static_cost) / bound.cost << std::endl;
+		std::cout << std::left << std::setw(30) << "offline optimum >="
+			<< std::right << std::setw(16) << bound.cost
+			<< std::setw(10) << static_cast<double>(bound.cost) / accesses
+			<< std::setw(10) << static_cast<double>(bound.cost) / static_cost
+			<< std::setw(10) << 1.0 << std::endl;
+		std::cout << "(pairwise bound over the " << bound.keys << " most frequent keys, "
+			<< std::setprecision(1) << bound.coverage * 100 << "% of accesses)" << std::endl;
+	}
+	catch (const std::exception& error) {
+		std::cerr << error.what() << std::endl;
+		return 1;
+	}
+
+	return 0;
+}